@@ -2,6 +2,159 @@
 set -euo pipefail  # Exit on error, undefined vars, and pipeline failures
 IFS=$'\n\t'       # Stricter word splitting
 
+# Usage:
+#   init-firewall.sh                     build the firewall from scratch
+#   init-firewall.sh --refresh           re-resolve the allowlist and swap the
+#                                        new set in place; iptables untouched
+#   init-firewall.sh --refresh-every N   build, then refresh every N seconds in
+#                                        the background (CDN IPs rotate)
+
+SET_NAME="allowed-domains"
+SET_STAGING="allowed-domains-new"
+REFRESH_PIDFILE="/run/init-firewall-refresh.pid"
+REFRESH_LOG="/var/log/init-firewall-refresh.log"
+
+ALLOWED_DOMAINS=(
+    "registry.npmjs.org"
+    "api.anthropic.com"
+    "sentry.io"
+    "statsig.anthropic.com"
+    "statsig.com"
+    "marketplace.visualstudio.com"
+    "vscode.blob.core.windows.net"
+    "update.code.visualstudio.com"
+)
+
+# Print the ipset restore payload for the allowlist, loaded into
+# $SET_STAGING: GitHub's published ranges plus the A records of every
+# allowed domain, all resolved concurrently. Returns non-zero, without
+# printing a partial payload, if any source fails or looks wrong.
+build_set_payload() {
+    local workdir
+    workdir=$(mktemp -d)
+    # shellcheck disable=SC2064
+    trap "rm -rf '$workdir'" RETURN
+
+    # Start the GitHub meta fetch and every DNS lookup at once
+    curl -s https://api.github.com/meta > "$workdir/github-meta" &
+    local meta_pid=$!
+    local pids=() domain
+    for domain in "${ALLOWED_DOMAINS[@]}"; do
+        dig +noall +answer +time=3 +tries=2 A "$domain" > "$workdir/dns-$domain" &
+        pids+=("$!")
+    done
+
+    echo "create $SET_STAGING hash:net -exist" > "$workdir/payload"
+    echo "flush $SET_STAGING" >> "$workdir/payload"
+
+    echo "Fetching GitHub IP ranges..." >&2
+    wait "$meta_pid" || true
+    local gh_ranges
+    gh_ranges=$(cat "$workdir/github-meta")
+    if [ -z "$gh_ranges" ]; then
+        echo "ERROR: Failed to fetch GitHub IP ranges" >&2
+        return 1
+    fi
+
+    if ! echo "$gh_ranges" | jq -e '.web and .api and .git' >/dev/null; then
+        echo "ERROR: GitHub API response missing required fields" >&2
+        return 1
+    fi
+
+    echo "Processing GitHub IPs..." >&2
+    local cidr
+    while read -r cidr; do
+        if [[ ! "$cidr" =~ ^[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}/[0-9]{1,2}$ ]]; then
+            echo "ERROR: Invalid CIDR range from GitHub meta: $cidr" >&2
+            return 1
+        fi
+        echo "Adding GitHub range $cidr" >&2
+        echo "add $SET_STAGING $cidr" >> "$workdir/payload"
+    done < <(echo "$gh_ranges" | jq -r '(.web + .api + .git)[]' | aggregate -q)
+
+    local i ips ip
+    for i in "${!ALLOWED_DOMAINS[@]}"; do
+        domain=${ALLOWED_DOMAINS[$i]}
+        echo "Resolving $domain..." >&2
+        wait "${pids[$i]}" || true
+        ips=$(awk '$4 == "A" {print $5}' "$workdir/dns-$domain")
+        if [ -z "$ips" ]; then
+            echo "ERROR: Failed to resolve $domain" >&2
+            return 1
+        fi
+
+        while read -r ip; do
+            if [[ ! "$ip" =~ ^[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}$ ]]; then
+                echo "ERROR: Invalid IP from DNS for $domain: $ip" >&2
+                return 1
+            fi
+            echo "Adding $ip for $domain" >&2
+            echo "add $SET_STAGING $ip" >> "$workdir/payload"
+        done < <(echo "$ips")
+    done
+
+    cat "$workdir/payload"
+}
+
+# Load a fresh allowlist into $SET_STAGING with one `ipset restore`, then
+# swap it with $SET_NAME atomically. The iptables rule matches the set by
+# name, so connections never see a half-built set. On failure the current
+# set stays as it was.
+load_allowed_set() {
+    local payload
+    if ! payload=$(build_set_payload); then
+        ipset destroy "$SET_STAGING" 2>/dev/null || true
+        return 1
+    fi
+    # -exist: one IP can be listed by several domains
+    ipset restore -exist <<< "$payload" || return 1
+    ipset create "$SET_NAME" hash:net -exist || return 1
+    ipset swap "$SET_STAGING" "$SET_NAME" || return 1
+    ipset destroy "$SET_STAGING"
+    echo "Loaded $(grep -c '^add ' <<< "$payload") entries into $SET_NAME"
+}
+
+refresh_loop() {
+    local interval=$1
+    while sleep "$interval"; do
+        echo "$(date -u +%Y-%m-%dT%H:%M:%SZ) refreshing $SET_NAME"
+        load_allowed_set || echo "Refresh failed; keeping the previous set"
+    done
+}
+
+REFRESH_EVERY=0
+case "${1:-}" in
+    --refresh)
+        load_allowed_set
+        exit 0
+        ;;
+    --refresh-every)
+        if [[ ! "${2:-}" =~ ^[0-9]+$ ]] || [ "$2" -lt 60 ]; then
+            echo "ERROR: --refresh-every needs an interval of at least 60 seconds"
+            exit 1
+        fi
+        REFRESH_EVERY=$2
+        ;;
+    "")
+        ;;
+    *)
+        echo "ERROR: Unknown argument: $1"
+        exit 1
+        ;;
+esac
+
+# Stop a refresh loop left over from a previous run before rebuilding
+# — but only if the pid still belongs to one: after a container restart the
+# pidfile can outlive the loop and name an unrelated process.
+if [ -f "$REFRESH_PIDFILE" ]; then
+    refresh_pid="$(cat "$REFRESH_PIDFILE")"
+    if [[ "$refresh_pid" =~ ^[0-9]+$ ]] && [ "$refresh_pid" != "$$" ] &&
+        tr '\0' ' ' 2>/dev/null < "/proc/$refresh_pid/cmdline" | grep -q "init-firewall"; then
+        kill "$refresh_pid" 2>/dev/null || true
+    fi
+    rm -f "$REFRESH_PIDFILE"
+fi
+
 # 1. Extract Docker DNS info BEFORE any flushing
 DOCKER_DNS_RULES=$(iptables-save -t nat | grep "127\.0\.0\.11" || true)
 
@@ -12,7 +165,8 @@ iptables -t nat -F
 iptables -t nat -X
 iptables -t mangle -F
 iptables -t mangle -X
-ipset destroy allowed-domains 2>/dev/null || true
+ipset destroy "$SET_NAME" 2>/dev/null || true
+ipset destroy "$SET_STAGING" 2>/dev/null || true
 
 # 2. Selectively restore ONLY internal Docker DNS resolution
 if [ -n "$DOCKER_DNS_RULES" ]; then
@@ -37,58 +191,8 @@ iptables -A INPUT -p tcp --sport 22 -m state --state ESTABLISHED -j ACCEPT
 iptables -A INPUT -i lo -j ACCEPT
 iptables -A OUTPUT -o lo -j ACCEPT
 
-# Create ipset with CIDR support
-ipset create allowed-domains hash:net
-
-# Fetch GitHub meta information and aggregate + add their IP ranges
-echo "Fetching GitHub IP ranges..."
-gh_ranges=$(curl -s https://api.github.com/meta)
-if [ -z "$gh_ranges" ]; then
-    echo "ERROR: Failed to fetch GitHub IP ranges"
-    exit 1
-fi
-
-if ! echo "$gh_ranges" | jq -e '.web and .api and .git' >/dev/null; then
-    echo "ERROR: GitHub API response missing required fields"
-    exit 1
-fi
-
-echo "Processing GitHub IPs..."
-while read -r cidr; do
-    if [[ ! "$cidr" =~ ^[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}/[0-9]{1,2}$ ]]; then
-        echo "ERROR: Invalid CIDR range from GitHub meta: $cidr"
-        exit 1
-    fi
-    echo "Adding GitHub range $cidr"
-    ipset add allowed-domains "$cidr"
-done < <(echo "$gh_ranges" | jq -r '(.web + .api + .git)[]' | aggregate -q)
-
-# Resolve and add other allowed domains
-for domain in \
-    "registry.npmjs.org" \
-    "api.anthropic.com" \
-    "sentry.io" \
-    "statsig.anthropic.com" \
-    "statsig.com" \
-    "marketplace.visualstudio.com" \
-    "vscode.blob.core.windows.net" \
-    "update.code.visualstudio.com"; do
-    echo "Resolving $domain..."
-    ips=$(dig +noall +answer A "$domain" | awk '$4 == "A" {print $5}')
-    if [ -z "$ips" ]; then
-        echo "ERROR: Failed to resolve $domain"
-        exit 1
-    fi
-    
-    while read -r ip; do
-        if [[ ! "$ip" =~ ^[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}$ ]]; then
-            echo "ERROR: Invalid IP from DNS for $domain: $ip"
-            exit 1
-        fi
-        echo "Adding $ip for $domain"
-        ipset add allowed-domains "$ip"
-    done < <(echo "$ips")
-done
+# Build the allowlist ipset (CIDR support) in one batch
+load_allowed_set
 
 # Get host IP from default route
 HOST_IP=$(ip route | grep default | cut -d" " -f3)
@@ -114,7 +218,7 @@ iptables -A INPUT -m state --state ESTABLISHED,RELATED -j ACCEPT
 iptables -A OUTPUT -m state --state ESTABLISHED,RELATED -j ACCEPT
 
 # Then allow only specific outbound traffic to allowed domains
-iptables -A OUTPUT -m set --match-set allowed-domains dst -j ACCEPT
+iptables -A OUTPUT -m set --match-set "$SET_NAME" dst -j ACCEPT
 
 # Explicitly REJECT all other outbound traffic for immediate feedback
 iptables -A OUTPUT -j REJECT --reject-with icmp-admin-prohibited
@@ -135,3 +239,10 @@ if ! curl --connect-timeout 5 https://api.github.com/zen >/dev/null 2>&1; then
 else
     echo "Firewall verification passed - able to reach https://api.github.com as expected"
 fi
+
+if [ "$REFRESH_EVERY" -gt 0 ]; then
+    refresh_loop "$REFRESH_EVERY" >> "$REFRESH_LOG" 2>&1 < /dev/null &
+    echo $! > "$REFRESH_PIDFILE"
+    disown
+    echo "Refreshing $SET_NAME every ${REFRESH_EVERY}s in the background (log: $REFRESH_LOG)"
+fi
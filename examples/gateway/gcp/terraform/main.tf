@@ -305,6 +305,8 @@ resource "google_cloud_run_v2_service" "gateway" {
     # /v1/messages responses mid-stream.
     timeout = "3600s"
 
+    max_instance_request_concurrency = var.max_instance_request_concurrency
+
     vpc_access {
       network_interfaces {
         network    = google_compute_network.vpc.id
@@ -317,6 +319,13 @@ resource "google_cloud_run_v2_service" "gateway" {
       image = local.image
       ports { container_port = 8080 }
 
+      resources {
+        limits = {
+          cpu    = var.cpu
+          memory = var.memory
+        }
+      }
+
       # gateway.yaml mounted as a file at /etc/claude/gateway.yaml (alone in its dir).
       volume_mounts {
         name       = "config"
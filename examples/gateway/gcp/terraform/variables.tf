@@ -155,6 +155,24 @@ variable "max_instances" {
   default     = 8
 }
 
+variable "cpu" {
+  description = "vCPU limit per Cloud Run instance (Cloud Run's default is 1000m). Size with ../../loadtest/sweep.sh."
+  type        = string
+  default     = "1000m"
+}
+
+variable "memory" {
+  description = "Memory limit per Cloud Run instance (Cloud Run's default is 512Mi)."
+  type        = string
+  default     = "512Mi"
+}
+
+variable "max_instance_request_concurrency" {
+  description = "Concurrent requests one instance serves before Cloud Run routes to (or starts) another (Cloud Run's default is 80). Long streaming /v1/messages calls hold a slot for their whole duration."
+  type        = number
+  default     = 80
+}
+
 variable "ingress" {
   description = "Cloud Run ingress — Claude Code's /login only accepts gateway hosts on private addresses, so public ingress cannot serve clients: INGRESS_TRAFFIC_INTERNAL_ONLY (default; no public URL — VPC-only; reaches corp on-prem only with the private-access prerequisites in the README; public_url stays the run.app URL, so no LB or custom cert needed) or INGRESS_TRAFFIC_INTERNAL_LOAD_BALANCER (front with your own internal ALB for a custom hostname/cert)."
   type        = string
@@ -0,0 +1,588 @@
+#!/usr/bin/env python3
+#
+# loadtest.py — replay concurrent developer traffic against a deployed Claude
+# Gateway and report throughput, tail latency and cold-start impact.
+#
+# Each virtual developer holds one keep-alive connection (as the CLI does) and
+# loops: build a Claude Code-shaped streaming /v1/messages request (a padded
+# system prompt standing in for the tool definitions + CLAUDE.md, and a
+# conversation that grows turn by turn), read the SSE stream to message_stop,
+# think, repeat. A fraction of the turns ask for long streamed answers, which
+# is what exercises the request-timeout / idle-timeout settings in the
+# Terraform. Each developer also refreshes its gateway token on a compressed
+# schedule through the token_endpoint advertised at
+# /.well-known/oauth-authorization-server.
+#
+# Stdlib only (python3 >= 3.8), so it runs from any VM inside the VPC — with
+# the default internal-only ingress the gateway isn't reachable from outside.
+#
+#   ./loadtest.py run --url https://gateway.internal.example.com \
+#       --tokens tokens.json --users 20 --duration 300 --label size=1cpu
+#   ./loadtest.py compare results/*.json
+#
+# Every request is a real model call billed to the upstream; use a small
+# --model and a short --duration until the numbers look sane. See README.md
+# for the token file format and how to read the report.
+
+import argparse
+import http.client
+import json
+import os
+import random
+import ssl
+import sys
+import threading
+import time
+import urllib.parse
+
+DEFAULT_MODEL = "claude-haiku-4-5"
+ANTHROPIC_VERSION = "2023-06-01"
+
+# Filler for the padded system prompt; the gateway forwards it verbatim, so
+# its content doesn't matter, only its size.
+_FILLER = (
+    "You are an interactive CLI tool that helps users with software "
+    "engineering tasks. Use the available tools to read and edit files. "
+)
+_SHORT_PROMPTS = [
+    "In one sentence, what does `git rebase --onto` do?",
+    "Name three causes of a flaky integration test. One line each.",
+    "Suggest a clear name for a function that retries an HTTP call.",
+    "What's the difference between a mutex and a semaphore? Be brief.",
+]
+_LONG_PROMPTS = [
+    "Write a detailed, well-commented Python module implementing an LRU "
+    "cache with TTL expiry, thread safety and unit tests.",
+    "Explain, step by step and with code examples, how to migrate a REST "
+    "service from callbacks to async/await, covering error handling, "
+    "cancellation and testing.",
+]
+
+
+def percentile(values, pct):
+    """Nearest-rank percentile."""
+    if not values:
+        return None
+    ordered = sorted(values)
+    rank = max(1, -(-len(ordered) * pct // 100))
+    return ordered[int(rank) - 1]
+
+
+def dist(values):
+    if not values:
+        return None
+    return {
+        "n": len(values),
+        "p50": round(percentile(values, 50), 1),
+        "p90": round(percentile(values, 90), 1),
+        "p95": round(percentile(values, 95), 1),
+        "p99": round(percentile(values, 99), 1),
+        "max": round(max(values), 1),
+    }
+
+
+# ---- credentials -------------------------------------------------------------
+
+def load_credentials(path):
+    """Token file: a JSON array, or JSON lines, of
+    {"access_token": ..., "refresh_token": ..., "client_id": ...}. Only
+    access_token is required. Without a file, GATEWAY_TOKEN is used for
+    every virtual developer and refresh is skipped."""
+    if not path:
+        token = os.environ.get("GATEWAY_TOKEN", "")
+        if not token:
+            sys.exit("loadtest: pass --tokens FILE or set GATEWAY_TOKEN")
+        return [{"access_token": token}]
+    with open(path) as f:
+        text = f.read()
+    try:
+        creds = json.loads(text)
+        if isinstance(creds, dict):
+            creds = [creds]
+    except ValueError:
+        creds = [json.loads(line) for line in text.splitlines() if line.strip()]
+    creds = [c for c in creds if isinstance(c, dict) and c.get("access_token")]
+    if not creds:
+        sys.exit(f"loadtest: no access_token entries in {path}")
+    return creds
+
+
+# ---- HTTP --------------------------------------------------------------------
+
+class Target:
+    def __init__(self, url, cacert, insecure, timeout):
+        parsed = urllib.parse.urlsplit(url.rstrip("/"))
+        if parsed.scheme not in ("http", "https"):
+            sys.exit(f"loadtest: --url must be http(s), got {url!r}")
+        self.url = url.rstrip("/")
+        self.scheme = parsed.scheme
+        self.host = parsed.hostname
+        self.port = parsed.port
+        self.base_path = parsed.path
+        self.timeout = timeout
+        self.cacert = cacert
+        self.insecure = insecure
+        self.context = self._tls_context() if self.scheme == "https" else None
+
+    def _tls_context(self):
+        context = ssl.create_default_context(cafile=self.cacert)
+        if self.insecure:
+            context.check_hostname = False
+            context.verify_mode = ssl.CERT_NONE
+        return context
+
+    def connect(self, host=None, port=None, scheme=None):
+        """Connect to the gateway, or to host:port over scheme (e.g. the
+        token endpoint, which may differ from the gateway's scheme)."""
+        scheme = scheme or self.scheme
+        if scheme == "https":
+            if self.context is None:
+                self.context = self._tls_context()
+            return http.client.HTTPSConnection(
+                host or self.host, port or self.port, timeout=self.timeout,
+                context=self.context)
+        return http.client.HTTPConnection(
+            host or self.host, port or self.port, timeout=self.timeout)
+
+    def get_json(self, path):
+        conn = self.connect()
+        try:
+            conn.request("GET", self.base_path + path)
+            resp = conn.getresponse()
+            body = resp.read()
+            return resp.status, (json.loads(body) if resp.status == 200 else None)
+        finally:
+            conn.close()
+
+
+def wait_ready(target, deadline_s):
+    """Poll /readyz until it answers 200. Returns (ms until ready, probes)."""
+    t0 = time.monotonic()
+    probes = 0
+    while True:
+        probes += 1
+        try:
+            conn = target.connect()
+            conn.request("GET", target.base_path + "/readyz")
+            resp = conn.getresponse()
+            resp.read()
+            conn.close()
+            if resp.status == 200:
+                return round((time.monotonic() - t0) * 1000), probes
+        except (OSError, http.client.HTTPException):
+            pass
+        if time.monotonic() - t0 > deadline_s:
+            return None, probes
+        time.sleep(1)
+
+
+# ---- virtual developer -------------------------------------------------------
+
+class Developer(threading.Thread):
+    def __init__(self, index, run, cred):
+        super().__init__(name=f"dev-{index}", daemon=True)
+        self.index = index
+        self.run_ = run
+        self.cred = dict(cred)
+        self.rng = random.Random(run.args.seed * 7919 + index)
+        self.conn = None
+        self.turns = []
+        self.first_request = True
+        refresh = run.args.refresh_every
+        self.next_refresh = time.monotonic() + self.rng.uniform(0.2, 1.0) * refresh if refresh else None
+
+    # One persistent connection per developer; reopened after errors.
+    def _conn(self):
+        if self.conn is None:
+            self.conn = self.run_.target.connect()
+        return self.conn
+
+    def _drop_conn(self):
+        if self.conn is not None:
+            try:
+                self.conn.close()
+            except Exception:
+                pass
+        self.conn = None
+
+    def run(self):
+        args = self.run_.args
+        time.sleep(self.index * args.ramp / max(1, args.users))
+        while not self.run_.stopping.is_set():
+            if self.next_refresh is not None and time.monotonic() >= self.next_refresh:
+                self.refresh()
+                self.next_refresh = time.monotonic() + args.refresh_every * self.rng.uniform(0.8, 1.2)
+            delay = self.turn()
+            think = self.rng.expovariate(1 / args.think) if args.think > 0 else 0
+            if self.run_.stopping.wait(max(delay, think)):
+                break
+        self._drop_conn()
+
+    def _body(self):
+        args = self.run_.args
+        long_turn = self.rng.random() < args.long_fraction
+        if len(self.turns) >= 2 * args.max_turns:
+            self.turns = []  # new session
+        prompt = self.rng.choice(_LONG_PROMPTS if long_turn else _SHORT_PROMPTS)
+        messages = self.turns + [{"role": "user", "content": prompt}]
+        body = {
+            "model": args.model,
+            "max_tokens": args.long_max_tokens if long_turn else args.short_max_tokens,
+            "stream": True,
+            "system": self.run_.system_prompt,
+            "messages": messages,
+        }
+        return ("long" if long_turn else "short"), prompt, json.dumps(body).encode()
+
+    def _headers(self, body):
+        headers = {
+            "Authorization": f"Bearer {self.cred['access_token']}",
+            "anthropic-version": ANTHROPIC_VERSION,
+            "content-type": "application/json",
+            "accept": "text/event-stream",
+            "content-length": str(len(body)),
+        }
+        if self.run_.args.spoof_xff:
+            # TEST-NET-3, one address per developer. See README: if spoofed
+            # addresses spread the per-IP rate limit, trusted_proxies is too broad.
+            headers["X-Forwarded-For"] = f"203.0.113.{self.index % 254 + 1}"
+        return headers
+
+    def turn(self):
+        """One /v1/messages call. Returns a minimum delay before the next."""
+        kind, prompt, body = self._body()
+        rec = {"kind": kind, "dev": self.index, "first": self.first_request,
+               "t": time.monotonic() - self.run_.t0, "req_bytes": len(body)}
+        self.first_request = False
+        t0 = time.monotonic()
+        delay = 0
+        try:
+            conn = self._conn()
+            conn.request("POST", self.run_.target.base_path + "/v1/messages", body, self._headers(body))
+            resp = conn.getresponse()
+            rec["status"] = resp.status
+            rec["ttfb_ms"] = (time.monotonic() - t0) * 1000
+            if resp.status == 200:
+                text = self._read_stream(resp, t0, rec)
+                if rec.get("complete"):
+                    self.turns += [{"role": "user", "content": prompt},
+                                   {"role": "assistant", "content": text or "ok"}]
+            else:
+                detail = resp.read()[:200].decode("utf-8", "replace")
+                rec["error"] = f"http_{resp.status}"
+                rec["detail"] = detail
+                if resp.status == 429:
+                    try:
+                        delay = float(resp.getheader("retry-after") or 1)
+                    except ValueError:
+                        delay = 1
+                elif resp.status == 401 and self.cred.get("refresh_token"):
+                    self.refresh()
+                if resp.will_close:
+                    self._drop_conn()
+        except (OSError, http.client.HTTPException) as exc:
+            rec["error"] = f"conn_{type(exc).__name__}"
+            self._drop_conn()
+        rec["total_ms"] = (time.monotonic() - t0) * 1000
+        self.run_.record(rec)
+        return delay
+
+    def _read_stream(self, resp, t0, rec):
+        event = ""
+        parts = []
+        stream_bytes = 0
+        while True:
+            line = resp.readline()
+            if not line:
+                break
+            stream_bytes += len(line)
+            line = line.strip()
+            if line.startswith(b"event:"):
+                event = line[6:].strip().decode()
+                continue
+            if not line.startswith(b"data:"):
+                continue
+            try:
+                data = json.loads(line[5:])
+            except ValueError:
+                continue
+            if event == "content_block_delta":
+                if "first_token_ms" not in rec:
+                    rec["first_token_ms"] = (time.monotonic() - t0) * 1000
+                parts.append(data.get("delta", {}).get("text", ""))
+            elif event == "message_delta":
+                rec["output_tokens"] = data.get("usage", {}).get("output_tokens", 0)
+            elif event == "message_stop":
+                rec["complete"] = True
+            elif event == "error":
+                rec["error"] = "stream_" + str(data.get("error", {}).get("type", "error"))
+        rec["stream_bytes"] = stream_bytes
+        if not rec.get("complete") and "error" not in rec:
+            # The stream ended without message_stop: something between the
+            # client and the upstream (request timeout, LB idle timeout,
+            # instance shutdown) cut it off.
+            rec["error"] = "truncated"
+            self._drop_conn()
+        return "".join(parts)
+
+    def refresh(self):
+        """refresh_token grant against the advertised token_endpoint."""
+        run = self.run_
+        if not run.token_endpoint or not self.cred.get("refresh_token"):
+            return
+        form = {"grant_type": "refresh_token", "refresh_token": self.cred["refresh_token"]}
+        if self.cred.get("client_id"):
+            form["client_id"] = self.cred["client_id"]
+        body = urllib.parse.urlencode(form).encode()
+        ep = urllib.parse.urlsplit(run.token_endpoint)
+        rec = {"kind": "refresh", "dev": self.index, "t": time.monotonic() - run.t0}
+        if ep.scheme not in ("http", "https"):
+            rec["error"] = "bad_token_endpoint"
+            run.record(rec)
+            return
+        path = (ep.path or "/") + (f"?{ep.query}" if ep.query else "")
+        t0 = time.monotonic()
+        conn = run.target.connect(ep.hostname, ep.port, ep.scheme)
+        try:
+            conn.request("POST", path, body, {
+                "content-type": "application/x-www-form-urlencoded",
+                "content-length": str(len(body)),
+            })
+            resp = conn.getresponse()
+            payload = resp.read()
+            rec["status"] = resp.status
+            if resp.status == 200:
+                tokens = json.loads(payload)
+                self.cred["access_token"] = tokens["access_token"]
+                # Refresh tokens may rotate; keep the newest one.
+                self.cred["refresh_token"] = tokens.get("refresh_token", self.cred["refresh_token"])
+            else:
+                rec["error"] = f"http_{resp.status}"
+        except (OSError, http.client.HTTPException, ValueError, KeyError) as exc:
+            rec["error"] = f"conn_{type(exc).__name__}"
+        finally:
+            conn.close()
+        rec["total_ms"] = (time.monotonic() - t0) * 1000
+        run.record(rec)
+
+
+# ---- run ---------------------------------------------------------------------
+
+class Run:
+    def __init__(self, args):
+        self.args = args
+        self.target = Target(args.url, args.cacert, args.insecure, args.read_timeout)
+        self.creds = load_credentials(args.tokens)
+        self.system_prompt = (_FILLER * (args.context_kb * 1024 // len(_FILLER) + 1))[: args.context_kb * 1024]
+        self.records = []
+        self.lock = threading.Lock()
+        self.stopping = threading.Event()
+        self.token_endpoint = None
+        self.t0 = time.monotonic()
+
+    def record(self, rec):
+        with self.lock:
+            self.records.append(rec)
+
+    def execute(self):
+        args = self.args
+        ready_ms, probes = wait_ready(self.target, args.ready_timeout)
+        if ready_ms is None:
+            sys.exit(f"loadtest: {args.url}/readyz not ready after {args.ready_timeout}s")
+        if args.refresh_every and any(c.get("refresh_token") for c in self.creds):
+            status, meta = self.target.get_json("/.well-known/oauth-authorization-server")
+            self.token_endpoint = (meta or {}).get("token_endpoint")
+            if not self.token_endpoint:
+                print(f"loadtest: no token_endpoint in OAuth metadata (HTTP {status}); refresh disabled",
+                      file=sys.stderr)
+        self.t0 = time.monotonic()
+        devs = [Developer(i, self, self.creds[i % len(self.creds)]) for i in range(args.users)]
+        for d in devs:
+            d.start()
+        self.stopping.wait(args.duration)
+        wall = time.monotonic() - self.t0
+        self.stopping.set()
+        # Let in-flight long streams finish so they count; stragglers past the
+        # drain window are left out of the report.
+        drain_until = time.monotonic() + args.drain
+        for d in devs:
+            d.join(max(0, drain_until - time.monotonic()))
+        with self.lock:
+            records = list(self.records)
+        return build_report(args, records, wall, ready_ms, probes, self.token_endpoint)
+
+
+def build_report(args, records, wall, ready_ms, probes, token_endpoint):
+    calls = [r for r in records if r["kind"] != "refresh"]
+    refreshes = [r for r in records if r["kind"] == "refresh"]
+    ok = [r for r in calls if "error" not in r]
+    by_status = {}
+    errors = {}
+    for r in calls:
+        by_status[str(r.get("status", "none"))] = by_status.get(str(r.get("status", "none")), 0) + 1
+        if "error" in r:
+            errors[r["error"]] = errors.get(r["error"], 0) + 1
+    tokens = sum(r.get("output_tokens", 0) for r in ok)
+    rate_limited = sum(1 for r in calls if r.get("status") == 429)
+
+    window = args.cold_window
+    cold = [r for r in ok if r["t"] < window]
+    warm = [r for r in ok if r["t"] >= window]
+    cold_p95 = percentile([r["ttfb_ms"] for r in cold], 95)
+    warm_p95 = percentile([r["ttfb_ms"] for r in warm], 95)
+
+    buckets = {}
+    for r in calls:
+        b = buckets.setdefault(int(r["t"] // args.bucket), {"started": 0, "ok": 0, "rate_limited": 0, "errors": 0, "ttfb": []})
+        b["started"] += 1
+        if "error" in r:
+            b["errors"] += 1
+            b["rate_limited"] += r.get("status") == 429
+        else:
+            b["ok"] += 1
+            b["ttfb"].append(r["ttfb_ms"])
+
+    return {
+        "label": dict(kv.split("=", 1) for kv in args.label),
+        "target": args.url,
+        "config": {
+            "users": args.users, "duration_s": args.duration, "ramp_s": args.ramp,
+            "think_s": args.think, "long_fraction": args.long_fraction,
+            "context_kb": args.context_kb, "model": args.model,
+            "refresh_every_s": args.refresh_every, "spoof_xff": args.spoof_xff,
+        },
+        "wall_s": round(wall, 1),
+        "requests": {
+            "total": len(calls),
+            "ok": len(ok),
+            "error_rate": round(1 - len(ok) / len(calls), 4) if calls else None,
+            "rate_limited": rate_limited,
+            "by_status": dict(sorted(by_status.items())),
+            "errors": dict(sorted(errors.items(), key=lambda kv: -kv[1])),
+        },
+        "throughput": {
+            "rps": round(len(ok) / wall, 3) if wall else None,
+            "output_tokens_per_s": round(tokens / wall, 1) if wall else None,
+            "stream_mb": round(sum(r.get("stream_bytes", 0) for r in ok) / 1e6, 2),
+        },
+        "latency_ms": {
+            "ttfb": dist([r["ttfb_ms"] for r in ok]),
+            "first_token": dist([r["first_token_ms"] for r in ok if "first_token_ms" in r]),
+            "total_short": dist([r["total_ms"] for r in ok if r["kind"] == "short"]),
+            "total_long": dist([r["total_ms"] for r in ok if r["kind"] == "long"]),
+        },
+        "refresh": {
+            "token_endpoint": token_endpoint,
+            "total": len(refreshes),
+            "errors": sum(1 for r in refreshes if "error" in r),
+            "latency_ms": dist([r["total_ms"] for r in refreshes if "error" not in r]),
+        },
+        "cold_start": {
+            "ready_ms": ready_ms,
+            "ready_probes": probes,
+            "first_request_ttfb_ms": dist([r["ttfb_ms"] for r in ok if r.get("first")]),
+            "window_s": window,
+            "window_ttfb_p95_ms": round(cold_p95, 1) if cold_p95 is not None else None,
+            "steady_ttfb_p95_ms": round(warm_p95, 1) if warm_p95 is not None else None,
+            "penalty_ms": round(cold_p95 - warm_p95, 1) if cold_p95 is not None and warm_p95 is not None else None,
+        },
+        "timeline": [
+            {"t": k * args.bucket, "started": b["started"], "ok": b["ok"],
+             "rate_limited": b["rate_limited"], "errors": b["errors"],
+             "ttfb_p95_ms": round(percentile(b["ttfb"], 95), 1) if b["ttfb"] else None}
+            for k, b in sorted(buckets.items())
+        ],
+    }
+
+
+def cmd_run(args):
+    for kv in args.label:
+        if "=" not in kv:
+            sys.exit(f"loadtest: --label takes key=value, got {kv!r}")
+    report = Run(args).execute()
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    lat = report["latency_ms"]["ttfb"] or {}
+    print(f"loadtest: {report['requests']['ok']}/{report['requests']['total']} ok, "
+          f"{report['throughput']['rps']} req/s, ttfb p95 {lat.get('p95')} ms, "
+          f"p99 {lat.get('p99')} ms, cold-start penalty {report['cold_start']['penalty_ms']} ms",
+          file=sys.stderr)
+    return 1 if report["requests"]["ok"] == 0 else 0
+
+
+def cmd_compare(args):
+    """One row per report, for picking Terraform variables side by side."""
+    rows = []
+    for path in args.reports:
+        with open(path) as f:
+            r = json.load(f)
+        ttfb = r["latency_ms"]["ttfb"] or {}
+        first = r["latency_ms"]["first_token"] or {}
+        rows.append([
+            ",".join(f"{k}={v}" for k, v in r["label"].items()) or os.path.basename(path),
+            str(r["config"]["users"]),
+            str(r["throughput"]["rps"]),
+            str(ttfb.get("p50")), str(ttfb.get("p95")), str(ttfb.get("p99")),
+            str(first.get("p95")),
+            f"{r['requests']['error_rate']:.2%}" if r["requests"]["error_rate"] is not None else "-",
+            str(r["requests"]["rate_limited"]),
+            str(r["cold_start"]["ready_ms"]),
+            str(r["cold_start"]["penalty_ms"]),
+        ])
+    header = ["label", "users", "req/s", "ttfb p50", "p95", "p99", "1st tok p95",
+              "errors", "429s", "ready ms", "cold +p95"]
+    widths = [max(len(row[i]) for row in rows + [header]) for i in range(len(header))]
+    for row in [header] + rows:
+        print("  ".join(cell.ljust(w) for cell, w in zip(row, widths)).rstrip())
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Load test a deployed Claude Gateway.")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    run = sub.add_parser("run", help="replay developer traffic and write a JSON report")
+    run.add_argument("--url", required=True, help="gateway base URL (public_url in gateway.yaml)")
+    run.add_argument("--tokens", help="JSON/JSONL credentials file (default: $GATEWAY_TOKEN)")
+    run.add_argument("--users", type=int, default=10, help="concurrent virtual developers")
+    run.add_argument("--duration", type=float, default=300, help="seconds of traffic")
+    run.add_argument("--ramp", type=float, default=30, help="seconds to start all developers")
+    run.add_argument("--think", type=float, default=5, help="mean think time between turns (s)")
+    run.add_argument("--long-fraction", type=float, default=0.2, help="share of turns asking for a long stream")
+    run.add_argument("--short-max-tokens", type=int, default=300)
+    run.add_argument("--long-max-tokens", type=int, default=8000)
+    run.add_argument("--max-turns", type=int, default=8, help="turns before a developer starts a new session")
+    run.add_argument("--context-kb", type=int, default=24, help="system prompt size per request (KiB)")
+    run.add_argument("--model", default=DEFAULT_MODEL)
+    run.add_argument("--refresh-every", type=float, default=120,
+                     help="seconds between token refreshes per developer (0 = never)")
+    run.add_argument("--spoof-xff", action="store_true",
+                     help="send a distinct X-Forwarded-For per developer (trusted_proxies check)")
+    run.add_argument("--cold-window", type=float, default=60,
+                     help="seconds after start counted as the cold-start window")
+    run.add_argument("--bucket", type=float, default=10, help="timeline bucket size (s)")
+    run.add_argument("--drain", type=float, default=120, help="seconds to let in-flight streams finish")
+    run.add_argument("--ready-timeout", type=float, default=600, help="seconds to wait for /readyz")
+    run.add_argument("--read-timeout", type=float, default=300, help="socket read timeout (s)")
+    run.add_argument("--cacert", help="CA bundle for a gateway behind a private CA")
+    run.add_argument("--insecure", action="store_true", help="skip TLS verification")
+    run.add_argument("--seed", type=int, default=1)
+    run.add_argument("--label", action="append", default=[], metavar="KEY=VALUE",
+                     help="tag the report (repeatable), e.g. cpu=2 concurrency=40")
+    run.add_argument("--output", help="write the JSON report here instead of stdout")
+    run.set_defaults(func=cmd_run)
+
+    compare = sub.add_parser("compare", help="tabulate several reports")
+    compare.add_argument("reports", nargs="+")
+    compare.set_defaults(func=cmd_compare)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# mock_gateway.py — a local stand-in for `claude gateway`, for trying
+# loadtest.py (and the box you run it from) without spending model tokens.
+#
+# Serves /readyz, /.well-known/oauth-authorization-server, a refresh_token
+# grant at /oauth/token, and a streaming /v1/messages that emits one
+# content_block_delta per `--token-ms` up to max_tokens. The numbers it
+# produces measure the harness, not a gateway.
+#
+#   ./mock_gateway.py --port 8080 &
+#   GATEWAY_TOKEN=test ./loadtest.py run --url http://127.0.0.1:8080 --duration 30
+
+import argparse
+import json
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    token_ms = 5.0
+    max_stream_tokens = 400
+
+    def log_message(self, fmt, *args):
+        pass
+
+    def _json(self, status, payload):
+        body = json.dumps(payload).encode()
+        self.send_response(status)
+        self.send_header("content-type", "application/json")
+        self.send_header("content-length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_GET(self):
+        if self.path in ("/readyz", "/healthz"):
+            self._json(200, {"ok": True})
+        elif self.path == "/.well-known/oauth-authorization-server":
+            host = self.headers.get("host", "127.0.0.1")
+            self._json(200, {"issuer": f"http://{host}", "token_endpoint": f"http://{host}/oauth/token"})
+        else:
+            self._json(404, {"error": "not_found"})
+
+    def _body(self):
+        return self.rfile.read(int(self.headers.get("content-length") or 0))
+
+    def do_POST(self):
+        body = self._body()
+        if self.path == "/oauth/token":
+            self._json(200, {"access_token": f"mock-{time.time_ns()}", "refresh_token": f"mock-r-{time.time_ns()}",
+                             "token_type": "Bearer", "expires_in": 3600})
+            return
+        if self.path != "/v1/messages":
+            self._json(404, {"error": "not_found"})
+            return
+        if not self.headers.get("authorization", "").startswith("Bearer "):
+            self._json(401, {"type": "error", "error": {"type": "authentication_error"}})
+            return
+        try:
+            max_tokens = int(json.loads(body).get("max_tokens", 100))
+        except ValueError:
+            self._json(400, {"type": "error", "error": {"type": "invalid_request_error"}})
+            return
+        n = min(max_tokens, self.max_stream_tokens)
+        self.send_response(200)
+        self.send_header("content-type", "text/event-stream")
+        self.send_header("transfer-encoding", "chunked")
+        self.end_headers()
+
+        def event(name, data):
+            chunk = f"event: {name}\ndata: {json.dumps(data)}\n\n".encode()
+            self.wfile.write(b"%x\r\n%s\r\n" % (len(chunk), chunk))
+            self.wfile.flush()
+
+        event("message_start", {"type": "message_start", "message": {"usage": {"input_tokens": len(body) // 4}}})
+        for _ in range(n):
+            time.sleep(self.token_ms / 1000)
+            event("content_block_delta", {"type": "content_block_delta", "delta": {"type": "text_delta", "text": "x "}})
+        event("message_delta", {"type": "message_delta", "usage": {"output_tokens": n}})
+        event("message_stop", {"type": "message_stop"})
+        self.wfile.write(b"0\r\n\r\n")
+        self.wfile.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local stand-in for claude gateway.")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--token-ms", type=float, default=5.0, help="delay between streamed tokens")
+    parser.add_argument("--max-stream-tokens", type=int, default=400, help="cap on tokens per stream")
+    args = parser.parse_args()
+    Handler.token_ms = args.token_ms
+    Handler.max_stream_tokens = args.max_stream_tokens
+    ThreadingHTTPServer((args.host, args.port), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+#
+# sweep.sh — size the gateway from numbers: apply each instance size ×
+# concurrency combination with Terraform, run loadtest.py against it at each
+# user count, then tabulate every report with `loadtest.py compare`.
+#
+# Usage (from a host that can reach the gateway — with internal-only ingress
+# that means inside the VPC or over the private-access path):
+#
+#   PLATFORM=gcp ./sweep.sh --tokens tokens.json --duration 300
+#   PLATFORM=aws GATEWAY_URL=https://gateway.internal.example.com ./sweep.sh --tokens tokens.json
+#
+# Everything after the script name is passed to `loadtest.py run`.
+#
+#   gcp  SIZES="cpu:memory ..."     -> -var cpu=... -var memory=...
+#        SCALE="concurrency ..."    -> -var max_instance_request_concurrency=...
+#   aws  SIZES="cpu:memory ..."     -> -var task_cpu=... -var task_memory=...  (Fargate units / MiB)
+#        SCALE="desired_count ..."  -> -var desired_count=...
+#
+# Each apply rolls out a fresh revision / task set, so the start of every run
+# is a cold start; the reports' cold_start section measures that. The last
+# combination stays applied — re-apply your chosen values when done.
+#
+# Every run makes real model calls; SIZES × SCALE × USERS runs of --duration
+# each add up. DRY_RUN=1 prints the plan without applying or calling anything.
+
+set -euo pipefail
+
+HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+
+# ---- configuration (env-overridable) ----------------------------------------
+PLATFORM="${PLATFORM:-gcp}"                                # gcp (Cloud Run) | aws (ECS on Fargate)
+TF_DIR="${TF_DIR:-${HERE}/../${PLATFORM}/terraform}"
+RESULTS="${RESULTS:-${HERE}/results/$(date +%Y%m%d-%H%M%S)}"
+USERS="${USERS:-10 40}"                                    # concurrent virtual developers per run
+DRY_RUN="${DRY_RUN:-0}"
+GATEWAY_URL="${GATEWAY_URL:-}"                             # gcp: defaults to the service_url output; aws: REQUIRED (your public_url)
+
+case "${PLATFORM}" in
+  gcp)
+    SIZES="${SIZES:-1000m:512Mi 2000m:1Gi}"
+    SCALE="${SCALE:-20 80}"
+    size_vars()  { printf -- '-var=cpu=%s -var=memory=%s' "${1%%:*}" "${1#*:}"; }
+    scale_vars() { printf -- '-var=max_instance_request_concurrency=%s' "$1"; }
+    SCALE_KEY=concurrency
+    ;;
+  aws)
+    SIZES="${SIZES:-1024:2048 2048:4096}"
+    SCALE="${SCALE:-1 2}"
+    size_vars()  { printf -- '-var=task_cpu=%s -var=task_memory=%s' "${1%%:*}" "${1#*:}"; }
+    scale_vars() { printf -- '-var=desired_count=%s' "$1"; }
+    SCALE_KEY=tasks
+    AWS_REGION="${AWS_REGION:-us-east-1}"
+    CLUSTER="${CLUSTER:-claude-gateway}"                   # cluster_name in terraform.tfvars
+    SERVICE="${SERVICE:-claude-gateway}"                   # service_name in terraform.tfvars
+    ;;
+  *)
+    echo "ERROR: PLATFORM must be gcp or aws (got '${PLATFORM}')." >&2
+    exit 1
+    ;;
+esac
+
+# ---- helpers ----------------------------------------------------------------
+log() { printf '\n==> %s\n' "$*"; }
+run() { if [[ "${DRY_RUN}" == "1" ]]; then printf '    (dry run) %s\n' "$*"; else "$@"; fi; }
+
+apply() {
+  # shellcheck disable=SC2046 # the *_vars helpers emit separate -var words
+  run terraform -chdir="${TF_DIR}" apply -auto-approve -input=false $(size_vars "$1") $(scale_vars "$2")
+  if [[ "${PLATFORM}" == "aws" ]]; then
+    # The ALB keeps routing to old tasks until the rolling deploy finishes.
+    run aws ecs wait services-stable --region "${AWS_REGION}" --cluster "${CLUSTER}" --services "${SERVICE}"
+  fi
+}
+
+# ---- preflight --------------------------------------------------------------
+[[ -d "${TF_DIR}" ]] || { echo "ERROR: no Terraform module at ${TF_DIR}." >&2; exit 1; }
+if [[ "${DRY_RUN}" != "1" ]]; then
+  command -v terraform >/dev/null || { echo "ERROR: terraform not on PATH." >&2; exit 1; }
+fi
+if [[ -z "${GATEWAY_URL}" ]]; then
+  if [[ "${DRY_RUN}" == "1" ]]; then
+    GATEWAY_URL="<gateway-url>"
+  elif [[ "${PLATFORM}" == "gcp" ]]; then
+    GATEWAY_URL="$(terraform -chdir="${TF_DIR}" output -raw service_url)"
+  else
+    echo "ERROR: set GATEWAY_URL to the gateway's public_url (the ALB alias, not the *.elb name)." >&2
+    exit 1
+  fi
+fi
+run mkdir -p "${RESULTS}"
+
+# ---- sweep ------------------------------------------------------------------
+for size in ${SIZES}; do
+  for scale in ${SCALE}; do
+    log "Applying size=${size} ${SCALE_KEY}=${scale}"
+    apply "${size}" "${scale}"
+    for users in ${USERS}; do
+      label="size=${size} ${SCALE_KEY}=${scale} users=${users}"
+      out="${RESULTS}/${PLATFORM}-${size//[:\/]/_}-${SCALE_KEY}${scale}-u${users}.json"
+      log "Load test ${label}"
+      run "${HERE}/loadtest.py" run --url "${GATEWAY_URL}" --users "${users}" \
+        --label "platform=${PLATFORM}" --label "size=${size}" \
+        --label "${SCALE_KEY}=${scale}" --label "users=${users}" \
+        --output "${out}" "$@"
+    done
+  done
+done
+
+if [[ "${DRY_RUN}" != "1" ]]; then
+  log "Results in ${RESULTS}"
+  "${HERE}/loadtest.py" compare "${RESULTS}"/*.json
+fi
@@ -3,13 +3,58 @@
 # Output the explanatory mode instructions as additionalContext
 # This mimics the deprecated Explanatory output style
 
-cat << 'EOF'
-{
-  "hookSpecificOutput": {
-    "hookEventName": "SessionStart",
-    "additionalContext": "You are in 'explanatory' output style mode, where you should provide educational insights about the codebase as you help with the user's task.\n\nYou should be clear and educational, providing helpful explanations while remaining focused on the task. Balance educational content with task completion. When providing insights, you may exceed typical length constraints, but remain focused and relevant.\n\n## Insights\nIn order to encourage learning, before and after writing code, always provide brief educational explanations about implementation choices using (with backticks):\n\"`★ Insight ─────────────────────────────────────`\n[2-3 key educational points]\n`─────────────────────────────────────────────────`\"\n\nThese insights should be included in the conversation, not in the codebase. You should generally focus on interesting insights that are specific to the codebase or the code you just wrote, rather than general programming concepts. Do not wait until the end to provide insights. Provide them as you write code."
+# Hook timing row for the log every bundled plugin shares
+# (CLAUDE_HOOK_TIMINGS=1, schema in plugins/README.md). EPOCHREALTIME needs
+# bash 5; older shells skip the row.
+if [[ "${CLAUDE_HOOK_TIMINGS:-0}" == "1" && -n "${EPOCHREALTIME:-}" ]]; then
+  TIMING_T0=${EPOCHREALTIME//,/.}
+  emit_timing() {
+    local log=${CLAUDE_HOOK_TIMINGS_LOG:-$HOME/.claude/hook-timings.jsonl}
+    local now=${EPOCHREALTIME//,/.} us
+    us=$(( ${now/./} - ${TIMING_T0/./} ))
+    printf '{"ts":%s,"pid":%d,"plugin":"%s","hook":"session-start","event":"SessionStart","tool":"","eval_ms":%d.%02d,"wall_ms":%d.%02d}\n' \
+      "${now%???}" "$$" "explanatory-output-style" $((us / 1000)) $((us % 1000 / 10)) $((us / 1000)) $((us % 1000 / 10)) \
+      >> "$log" 2>/dev/null || true
   }
+  trap emit_timing EXIT
+fi
+
+# The instructions live in output-styles/explanatory.md, which Claude Code also
+# offers as a native output style. When that style (or the built-in one of
+# the same name) is already selected, the instructions are in the system
+# prompt and this hook stays silent rather than inject them twice. Builtins
+# only, so the hook costs one bash process and no forks.
+STYLE_FILE="${CLAUDE_PLUGIN_ROOT:-${BASH_SOURCE[0]%/*}/..}/output-styles/explanatory.md"
+
+# outputStyle from the highest-precedence settings file that sets it
+selected_style() {
+  local project=${CLAUDE_PROJECT_DIR:-$PWD} file text
+  for file in "$project/.claude/settings.local.json" "$project/.claude/settings.json" "$HOME/.claude/settings.json"; do
+    [[ -r "$file" ]] || continue
+    IFS= read -r -d '' text < "$file" || true
+    if [[ $text =~ \"outputStyle\"[[:space:]]*:[[:space:]]*\"([^\"]*)\" ]]; then
+      SELECTED_STYLE=${BASH_REMATCH[1]}
+      return 0
+    fi
+  done
+  return 1
 }
-EOF
+
+# nocasematch rather than ${x,,}: macOS still ships bash 3.2
+shopt -s nocasematch
+if selected_style && [[ $SELECTED_STYLE == *explanatory* ]]; then
+  exit 0
+fi
+shopt -u nocasematch
+
+IFS= read -r -d '' context < "$STYLE_FILE" || true
+# Drop the frontmatter and the blank line after it, and the trailing newline
+context=${context#---$'\n'*$'\n'---$'\n'$'\n'}
+context=${context%$'\n'}
+context=${context//\\/\\\\}
+context=${context//\"/\\\"}
+context=${context//$'\n'/\\n}
+
+printf '{\n  "hookSpecificOutput": {\n    "hookEventName": "SessionStart",\n    "additionalContext": "%s"\n  }\n}\n' "$context"
 
 exit 0
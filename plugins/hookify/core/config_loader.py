@@ -7,9 +7,21 @@ Loads and parses .claude/hookify.*.local.md files.
 import os
 import sys
 import glob
+import json
 import re
-from typing import List, Optional, Dict, Any
-from dataclasses import dataclass, field
+import tempfile
+from typing import List, Optional, Dict, Any, Tuple
+from dataclasses import asdict, dataclass, field
+
+from hookify.utils import telemetry
+
+# Serialized rules + manifest of the rule files they were parsed from.
+# load_rules() returns straight from here while the manifest still matches.
+RULE_CACHE_PATH = os.path.join('.claude', '.hookify-cache')
+RULE_CACHE_VERSION = 2
+
+# Set HOOKIFY_RULE_CACHE=0 to always re-parse rule files
+RULE_CACHE_ENABLED = os.environ.get('HOOKIFY_RULE_CACHE', '1') != '0'
 
 
 @dataclass
@@ -18,6 +30,7 @@ class Condition:
     field: str  # "command", "new_text", "old_text", "file_path", etc.
     operator: str  # "regex_match", "contains", "equals", etc.
     pattern: str  # Pattern to match
+    scope: Optional[str] = None  # Transcript scope: "all", "last_assistant:N", "since_last_stop"
 
     @classmethod
     def from_dict(cls, data: Dict[str, Any]) -> 'Condition':
@@ -25,7 +38,8 @@ class Condition:
         return cls(
             field=data.get('field', ''),
             operator=data.get('operator', 'regex_match'),
-            pattern=data.get('pattern', '')
+            pattern=data.get('pattern', ''),
+            scope=data.get('scope')
         )
 
 
@@ -195,20 +209,56 @@ def extract_frontmatter(content: str) -> tuple[Dict[str, Any], str]:
     return frontmatter, message
 
 
+def rule_applies(rule: Rule, event: Optional[str] = None) -> bool:
+    """Check if a loaded rule is enabled and applies to the event.
+
+    Args:
+        rule: Rule to check
+        event: Optional event filter ("bash", "file", "stop", etc.)
+
+    Returns:
+        True if the rule should be evaluated for this event
+    """
+    # Filter by event if specified
+    if event and rule.event != 'all' and rule.event != event:
+        return False
+
+    # Only include enabled rules
+    return bool(rule.enabled)
+
+
+def rule_file_paths() -> List[str]:
+    """Return the paths of all hookify.*.local.md files in .claude/."""
+    pattern = os.path.join('.claude', 'hookify.*.local.md')
+    return glob.glob(pattern)
+
+
 def load_rules(event: Optional[str] = None) -> List[Rule]:
     """Load all hookify rules from .claude directory.
 
+    Served from the on-disk rule cache when no rule file has changed since
+    it was written; otherwise every file is re-parsed and the cache rebuilt.
+
     Args:
         event: Optional event filter ("bash", "file", "stop", etc.)
 
     Returns:
         List of enabled Rule objects matching the event.
     """
-    rules = []
-
     # Find all hookify.*.local.md files
-    pattern = os.path.join('.claude', 'hookify.*.local.md')
-    files = glob.glob(pattern)
+    files = rule_file_paths()
+
+    # No rule files (the common case outside hookify projects) - nothing
+    # worth caching, and .claude/ may not even exist
+    manifest = _build_manifest(files) if RULE_CACHE_ENABLED and files else None
+    if manifest is not None:
+        cached = _read_rule_cache(manifest, event)
+        if cached is not None:
+            telemetry.count('cache_hits')
+            return cached
+        telemetry.count('cache_misses')
+
+    all_rules = []
 
     for file_path in files:
         try:
@@ -216,14 +266,7 @@ def load_rules(event: Optional[str] = None) -> List[Rule]:
             if not rule:
                 continue
 
-            # Filter by event if specified
-            if event:
-                if rule.event != 'all' and rule.event != event:
-                    continue
-
-            # Only include enabled rules
-            if rule.enabled:
-                rules.append(rule)
+            all_rules.append(rule)
 
         except (IOError, OSError, PermissionError) as e:
             # File I/O errors - log and continue
@@ -238,7 +281,94 @@ def load_rules(event: Optional[str] = None) -> List[Rule]:
             print(f"Warning: Unexpected error loading {file_path} ({type(e).__name__}): {e}", file=sys.stderr)
             continue
 
-    return rules
+    if manifest is not None:
+        _write_rule_cache(manifest, all_rules)
+
+    return [rule for rule in all_rules if rule_applies(rule, event)]
+
+
+def _build_manifest(files: List[str]) -> Optional[List[Tuple[str, int, int]]]:
+    """Stat each rule file into (path, mtime_ns, size) entries.
+
+    Returns None if any file can't be stat'ed (the cache is bypassed and
+    the normal load path reports the error).
+    """
+    manifest = []
+    for file_path in files:
+        try:
+            st = os.stat(file_path)
+        except OSError:
+            return None
+        manifest.append((file_path, st.st_mtime_ns, st.st_size))
+    return manifest
+
+
+def _read_rule_cache(manifest: List[Tuple[str, int, int]],
+                     event: Optional[str]) -> Optional[List[Rule]]:
+    """Return cached rules for the event, or None if the cache is stale.
+
+    Only the rules listed in the event's index are deserialized, so a bash
+    hook never constructs the file/stop rules.
+    """
+    try:
+        with open(RULE_CACHE_PATH, 'r') as f:
+            cache = json.load(f)
+
+        if cache.get('version') != RULE_CACHE_VERSION:
+            return None
+        if [tuple(entry) for entry in cache.get('manifest', [])] != manifest:
+            return None
+
+        rules = cache['rules']
+        by_event = cache['by_event']
+        if event:
+            indices = sorted(set(by_event.get(event, []) + by_event.get('all', [])))
+        else:
+            indices = sorted(set(i for group in by_event.values() for i in group))
+
+        return [_rule_from_cache(rules[i]) for i in indices]
+
+    except (IOError, OSError, ValueError, KeyError, IndexError, TypeError):
+        # Missing, corrupt or foreign cache - fall back to re-parsing
+        return None
+
+
+def _write_rule_cache(manifest: List[Tuple[str, int, int]], rules: List[Rule]) -> None:
+    """Atomically replace the rule cache (best-effort)."""
+    # Per-event index of enabled rules; 'all' rules apply to every event
+    by_event: Dict[str, List[int]] = {}
+    for i, rule in enumerate(rules):
+        if rule.enabled:
+            by_event.setdefault(rule.event, []).append(i)
+
+    cache = {
+        'version': RULE_CACHE_VERSION,
+        'manifest': manifest,
+        'rules': [asdict(rule) for rule in rules],
+        'by_event': by_event,
+    }
+
+    tmp_path = None
+    try:
+        fd, tmp_path = tempfile.mkstemp(prefix='.hookify-cache.', dir=os.path.dirname(RULE_CACHE_PATH))
+        with os.fdopen(fd, 'w') as f:
+            json.dump(cache, f)
+        os.replace(tmp_path, RULE_CACHE_PATH)
+        tmp_path = None
+    except (IOError, OSError, TypeError, ValueError) as e:
+        print(f"Warning: Failed to write rule cache {RULE_CACHE_PATH}: {e}", file=sys.stderr)
+    finally:
+        if tmp_path:
+            try:
+                os.unlink(tmp_path)
+            except OSError:
+                pass
+
+
+def _rule_from_cache(data: Dict[str, Any]) -> Rule:
+    """Rebuild a Rule from its cached asdict() form."""
+    conditions = [Condition(**c) for c in data.get('conditions', [])]
+    return Rule(**{**data, 'conditions': conditions})
 
 
 def load_rule_file(file_path: str) -> Optional[Rule]:
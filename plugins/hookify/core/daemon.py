@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""Resident rule server for hookify plugin.
+
+Every hook invocation normally boots a fresh interpreter, globs
+.claude/hookify.*.local.md, re-parses each file and recompiles every regex.
+With HOOKIFY_DAEMON=1 the hook entry points become thin clients: they send
+the hook input to a per-project server over a unix socket, and the server
+keeps parsed rules and compiled regexes warm between calls. Rule files are
+only re-parsed when their mtime or size changes.
+
+If the server isn't running (first call, crashed, idle-exited) the client
+starts one in the background and evaluates in-process for that call, so the
+daemon is never required for correctness.
+"""
+
+import hashlib
+import json
+import os
+import socket
+import subprocess
+import sys
+import time
+
+# When run as a script (the spawned server), make the "hookify" package
+# importable the same way the hook entry points do.
+_PLUGIN_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+if __name__ == '__main__':
+    _parent_dir = os.path.dirname(_PLUGIN_ROOT)
+    if _parent_dir not in sys.path:
+        sys.path.insert(0, _parent_dir)
+
+# Opt-in: resident mode is off unless HOOKIFY_DAEMON=1
+DAEMON_ENABLED = os.environ.get('HOOKIFY_DAEMON', '0') == '1'
+
+# Server exits after this many seconds without a request
+IDLE_TIMEOUT_SECS = int(os.environ.get('HOOKIFY_DAEMON_IDLE_SECS', '1800'))
+
+# Client-side socket timeout. Well under the 10s hook timeout so a wedged
+# server still leaves time for the in-process fallback.
+CLIENT_TIMEOUT_SECS = 3.0
+
+# Minimum gap between spawn attempts, so a burst of hooks racing a cold
+# start doesn't launch one server each.
+SPAWN_THROTTLE_SECS = 5.0
+
+MAX_REQUEST_BYTES = 64 * 1024 * 1024
+
+
+def _state_dir() -> str:
+    """Directory holding daemon sockets (created 0700 on demand)."""
+    return os.environ.get('HOOKIFY_STATE_DIR') or os.path.expanduser('~/.claude/hookify')
+
+
+def socket_path(project_dir: str = None) -> str:
+    """Get the per-project socket path.
+
+    Keyed on the plugin root as well as the project so a plugin upgrade
+    (new versioned install dir) never talks to a server running old code.
+    """
+    project_dir = os.path.realpath(project_dir or os.getcwd())
+    key = hashlib.sha1(f"{_PLUGIN_ROOT}\0{project_dir}".encode('utf-8')).hexdigest()[:16]
+    return os.path.join(_state_dir(), f"{key}.sock")
+
+
+# ---------------------------------------------------------------------------
+# Client
+# ---------------------------------------------------------------------------
+
+def evaluate(event, input_data, fields=None):
+    """Evaluate rules for a hook event, via the daemon when enabled.
+
+    Args:
+        event: Event filter passed to load_rules ("bash", "file", "stop", ...)
+        input_data: Parsed hook input JSON
+        fields: Pre-extracted field values for RuleEngine.evaluate_rules
+            (in-process only; the daemon extracts its own)
+
+    Returns:
+        Hook response dict (same shape as RuleEngine.evaluate_rules)
+    """
+    if DAEMON_ENABLED:
+        result = _evaluate_remote(event, input_data)
+        if result is not None:
+            return result
+    return evaluate_local(event, input_data, fields)
+
+
+def evaluate_local(event, input_data, fields=None):
+    """Evaluate rules in-process (the non-daemon path)."""
+    from hookify.core.config_loader import load_rules
+    from hookify.core.rule_engine import RuleEngine
+
+    rules = load_rules(event=event)
+    engine = RuleEngine()
+    return engine.evaluate_rules(rules, input_data, fields)
+
+
+def _evaluate_remote(event, input_data):
+    """Send the request to the daemon. Returns None on any failure."""
+    path = socket_path()
+    request = json.dumps({
+        "cwd": os.path.realpath(os.getcwd()),
+        "event": event,
+        "input": input_data,
+    }).encode('utf-8') + b"\n"
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        sock.settimeout(CLIENT_TIMEOUT_SECS)
+        try:
+            sock.connect(path)
+        except (FileNotFoundError, ConnectionRefusedError):
+            # No server (or a stale socket from a dead one) - start one
+            # for next time and evaluate in-process now.
+            _spawn_daemon(path)
+            return None
+
+        sock.sendall(request)
+        sock.shutdown(socket.SHUT_WR)
+        chunks = []
+        while True:
+            chunk = sock.recv(65536)
+            if not chunk:
+                break
+            chunks.append(chunk)
+
+        response = json.loads(b"".join(chunks).decode('utf-8'))
+        if response.get('ok'):
+            from hookify.utils import telemetry
+            telemetry.count('daemon')
+            telemetry.merge_counts(response.get('stats'))
+            return response.get('result', {})
+        print(f"Warning: hookify daemon error: {response.get('error')}", file=sys.stderr)
+        return None
+
+    except (OSError, ValueError) as e:
+        print(f"Warning: hookify daemon unavailable: {e}", file=sys.stderr)
+        return None
+    finally:
+        sock.close()
+
+
+def _spawn_daemon(path: str) -> None:
+    """Start a detached server for the current project (best-effort)."""
+    try:
+        os.makedirs(os.path.dirname(path), mode=0o700, exist_ok=True)
+        throttle = path + '.spawn'
+        try:
+            if time.time() - os.path.getmtime(throttle) < SPAWN_THROTTLE_SECS:
+                return
+        except OSError:
+            pass
+        # Touch the throttle BEFORE spawning so concurrent hooks back off.
+        open(throttle, 'w').close()
+
+        subprocess.Popen(
+            [sys.executable, os.path.abspath(__file__)],
+            cwd=os.getcwd(),
+            stdin=subprocess.DEVNULL,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+            start_new_session=True,
+        )
+    except Exception as e:
+        print(f"Warning: could not start hookify daemon: {e}", file=sys.stderr)
+
+
+# ---------------------------------------------------------------------------
+# Server
+# ---------------------------------------------------------------------------
+
+class RuleCache:
+    """Parsed rules kept warm across requests.
+
+    Each rule file is cached with the (mtime_ns, size) it was parsed at and
+    is only re-parsed when either changes. Added/removed files are picked up
+    by the per-request glob.
+    """
+
+    def __init__(self):
+        self._files = {}  # path -> (mtime_ns, size, Rule or None)
+
+    def rules(self, event=None):
+        """Return enabled rules for the event, in load_rules() order."""
+        from hookify.core.config_loader import load_rule_file, rule_applies, rule_file_paths
+        from hookify.utils import telemetry
+
+        paths = rule_file_paths()
+        fresh = {}
+        for path in paths:
+            try:
+                st = os.stat(path)
+            except OSError:
+                continue
+            cached = self._files.get(path)
+            if cached and cached[0] == st.st_mtime_ns and cached[1] == st.st_size:
+                fresh[path] = cached
+                telemetry.count('cache_hits')
+            else:
+                telemetry.count('cache_misses')
+                fresh[path] = (st.st_mtime_ns, st.st_size, load_rule_file(path))
+        self._files = fresh
+
+        return [
+            entry[2] for entry in (fresh.get(p) for p in paths)
+            if entry and entry[2] and rule_applies(entry[2], event)
+        ]
+
+
+def _handle_connection(conn, cache, engine, project_dir) -> None:
+    """Serve a single request/response exchange."""
+    from hookify.utils import telemetry
+
+    conn.settimeout(CLIENT_TIMEOUT_SECS)
+    try:
+        chunks = []
+        size = 0
+        while True:
+            chunk = conn.recv(65536)
+            if not chunk:
+                break
+            size += len(chunk)
+            if size > MAX_REQUEST_BYTES:
+                raise ValueError("request too large")
+            chunks.append(chunk)
+
+        request = json.loads(b"".join(chunks).decode('utf-8'))
+        if request.get('cwd') != project_dir:
+            # Socket key collision or a moved project - let the client
+            # fall back rather than evaluate another project's rules.
+            response = {"ok": False, "error": "project mismatch"}
+        else:
+            telemetry.take_counts()
+            rules = cache.rules(event=request.get('event'))
+            result = engine.evaluate_rules(rules, request.get('input') or {})
+            # The client folds these into its hook timing row
+            response = {"ok": True, "result": result, "stats": telemetry.take_counts()}
+    except Exception as e:
+        response = {"ok": False, "error": f"{type(e).__name__}: {e}"}
+
+    try:
+        conn.sendall(json.dumps(response).encode('utf-8'))
+    except OSError:
+        pass
+
+
+def _bind(path: str):
+    """Bind the listening socket, or return None if a live server owns it."""
+    os.makedirs(os.path.dirname(path), mode=0o700, exist_ok=True)
+
+    if os.path.exists(path):
+        probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            probe.settimeout(1.0)
+            probe.connect(path)
+            return None  # Another server is alive
+        except OSError:
+            # Stale socket left by a dead server
+            try:
+                os.unlink(path)
+            except FileNotFoundError:
+                pass
+        finally:
+            probe.close()
+
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        server.bind(path)
+    except OSError:
+        # Lost the bind race to a concurrently spawned server
+        server.close()
+        return None
+    os.chmod(path, 0o600)
+    server.listen(16)
+    return server
+
+
+def serve() -> None:
+    """Run the server for the current working directory until idle."""
+    from hookify.core.rule_engine import RuleEngine
+
+    project_dir = os.path.realpath(os.getcwd())
+    path = socket_path(project_dir)
+    server = _bind(path)
+    if server is None:
+        return
+
+    cache = RuleCache()
+    engine = RuleEngine()
+    server.settimeout(IDLE_TIMEOUT_SECS)
+    try:
+        while True:
+            try:
+                conn, _ = server.accept()
+            except socket.timeout:
+                break  # Idle - exit and let the next hook respawn us
+            with conn:
+                _handle_connection(conn, cache, engine, project_dir)
+    finally:
+        server.close()
+        try:
+            os.unlink(path)
+        except OSError:
+            pass
+
+
+if __name__ == '__main__':
+    serve()
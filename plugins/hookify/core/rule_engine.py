@@ -8,6 +8,13 @@ from typing import List, Dict, Any, Optional
 
 # Import from local module
 from hookify.core.config_loader import Rule, Condition
+from hookify.matchers.multi_pattern import CompiledRuleSet
+from hookify.utils import telemetry
+from hookify.utils.transcript import TranscriptCache
+
+# Compiled rule sets kept per engine. A resident daemon evaluates a handful
+# of distinct rule lists (one per event), so this stays tiny.
+MAX_COMPILED_SETS = 8
 
 
 # Cache compiled regexes (max 128 patterns)
@@ -29,10 +36,13 @@ class RuleEngine:
 
     def __init__(self):
         """Initialize rule engine."""
-        # No need for instance cache anymore - using global lru_cache
-        pass
+        # Rule-list signature -> CompiledRuleSet
+        self._compiled_sets: Dict[tuple, CompiledRuleSet] = {}
+        # Transcript read once and shared by every transcript condition
+        self._transcripts = TranscriptCache()
 
-    def evaluate_rules(self, rules: List[Rule], input_data: Dict[str, Any]) -> Dict[str, Any]:
+    def evaluate_rules(self, rules: List[Rule], input_data: Dict[str, Any],
+                       fields: Optional[Dict[tuple, Optional[str]]] = None) -> Dict[str, Any]:
         """Evaluate all rules and return combined results.
 
         Checks all rules and accumulates matches. Blocking rules take priority
@@ -41,6 +51,8 @@ class RuleEngine:
         Args:
             rules: List of Rule objects to evaluate
             input_data: Hook input JSON (tool_name, tool_input, etc.)
+            fields: Field values another caller already extracted, keyed by
+                (field, scope) (merged hook dispatch shares them)
 
         Returns:
             Response dict with systemMessage, hookSpecificOutput, etc.
@@ -50,12 +62,15 @@ class RuleEngine:
         blocking_rules = []
         warning_rules = []
 
-        for rule in rules:
-            if self._rule_matches(rule, input_data):
-                if rule.action == 'block':
-                    blocking_rules.append(rule)
-                else:
-                    warning_rules.append(rule)
+        compiled = self._compile(rules)
+        telemetry.count('rules', len(rules))
+        telemetry.count('patterns', sum(len(r.conditions) for r in rules))
+        for index in compiled.matching_indices(input_data, self._extract_field, self._matches_tool, fields):
+            rule = rules[index]
+            if rule.action == 'block':
+                blocking_rules.append(rule)
+            else:
+                warning_rules.append(rule)
 
         # If any blocking rules matched, block the operation
         if blocking_rules:
@@ -93,6 +108,26 @@ class RuleEngine:
         # No matches - allow operation
         return {}
 
+    def _compile(self, rules: List[Rule]) -> CompiledRuleSet:
+        """Get the compiled matcher for a rule list, building it on first use.
+
+        Keyed on the matching-relevant rule content rather than identity, so
+        a reloaded rule file whose conditions didn't change (e.g. only the
+        message was edited) reuses the existing automata.
+        """
+        key = tuple(
+            (r.tool_matcher, tuple((c.field, c.operator, c.pattern, c.scope) for c in r.conditions))
+            for r in rules
+        )
+        compiled = self._compiled_sets.get(key)
+        telemetry.count('cache_hits' if compiled is not None else 'cache_misses')
+        if compiled is None:
+            if len(self._compiled_sets) >= MAX_COMPILED_SETS:
+                self._compiled_sets.clear()
+            compiled = CompiledRuleSet(rules)
+            self._compiled_sets[key] = compiled
+        return compiled
+
     def _rule_matches(self, rule: Rule, input_data: Dict[str, Any]) -> bool:
         """Check if rule matches input data.
 
@@ -155,7 +190,8 @@ class RuleEngine:
             True if condition matches
         """
         # Extract the field value to check
-        field_value = self._extract_field(condition.field, tool_name, tool_input, input_data)
+        field_value = self._extract_field(condition.field, tool_name, tool_input, input_data,
+                                          scope=condition.scope)
         if field_value is None:
             return False
 
@@ -180,7 +216,8 @@ class RuleEngine:
             return False
 
     def _extract_field(self, field: str, tool_name: str,
-                      tool_input: Dict[str, Any], input_data: Dict[str, Any] = None) -> Optional[str]:
+                      tool_input: Dict[str, Any], input_data: Dict[str, Any] = None,
+                      scope: Optional[str] = None) -> Optional[str]:
         """Extract field value from tool input or hook input data.
 
         Args:
@@ -188,6 +225,7 @@ class RuleEngine:
             tool_name: Tool being used (may be empty for Stop events)
             tool_input: Tool input dict
             input_data: Full hook input (for accessing transcript_path, reason, etc.)
+            scope: Transcript scope (see hookify.utils.transcript); transcript only
 
         Returns:
             Field value as string, or None if not found
@@ -205,24 +243,15 @@ class RuleEngine:
             if field == 'reason':
                 return input_data.get('reason', '')
             elif field == 'transcript':
-                # Read transcript file if path provided
+                # Read transcript file if path provided. The reader is
+                # shared, so each scope is read at most once per transcript.
                 transcript_path = input_data.get('transcript_path')
                 if transcript_path:
                     try:
-                        with open(transcript_path, 'r') as f:
-                            return f.read()
-                    except FileNotFoundError:
-                        print(f"Warning: Transcript file not found: {transcript_path}", file=sys.stderr)
-                        return ''
-                    except PermissionError:
-                        print(f"Warning: Permission denied reading transcript: {transcript_path}", file=sys.stderr)
-                        return ''
-                    except (IOError, OSError) as e:
-                        print(f"Warning: Error reading transcript {transcript_path}: {e}", file=sys.stderr)
-                        return ''
-                    except UnicodeDecodeError as e:
-                        print(f"Warning: Encoding error in transcript {transcript_path}: {e}", file=sys.stderr)
-                        return ''
+                        return self._transcripts.reader(transcript_path).read(scope)
+                    except ValueError as e:
+                        print(f"Warning: {e}", file=sys.stderr)
+                        return None
             elif field == 'user_prompt':
                 # For UserPromptSubmit events
                 return input_data.get('user_prompt', '')
@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+#
+# dispatch-follower.sh — merged hook dispatch, follower side (protocol 2).
+#
+# The protocol is documented in plugins/README.md under "Merged Hook
+# Dispatch". The dispatcher itself (dispatch.sh and hook_dispatch.py) lives
+# in security-guidance, which always leads; this shim only registers hookify
+# so a running leader can evaluate it in its interpreter.
+#
+# Usage (as a hooks.json command):
+#   bash ${CLAUDE_PLUGIN_ROOT}/hooks/dispatch-follower.sh <plugin> <entry.py> <runner...>
+#
+# "<runner...> hooks/<entry.py>" is the plugin's standalone hook. After
+# registering, the shim exits without output if a leader for this call is
+# still scanning, since that leader claims and runs it. Otherwise (no
+# leader yet, or past its last scan) it claims itself and runs directly; the
+# claim keeps a leader that starts just after from running it twice. The
+# only fork in the common path is the cat that reads the hook input.
+#
+# CLAUDE_HOOK_DISPATCH=0 runs the entry directly, as before.
+#
+# No set -e: a failed mkdir or create below means "run this plugin
+# directly", never "drop its hook".
+
+# Hook timings' startup_ms runs from here (EPOCHREALTIME needs bash 5).
+if [[ "${CLAUDE_HOOK_TIMINGS:-0}" == "1" && -z "${CLAUDE_HOOK_TIMING_T0:-}" && -n "${EPOCHREALTIME:-}" ]]; then
+  export CLAUDE_HOOK_TIMING_T0=$EPOCHREALTIME
+fi
+
+PLUGIN=$1
+ENTRY=$2
+shift 2
+HOOKS_DIR=${BASH_SOURCE[0]%/*}
+ROOT=${HOOKS_DIR%/*}
+
+INPUT=$(cat)
+
+run_direct() {
+  CLAUDE_PLUGIN_ROOT=$ROOT exec "$@" "$HOOKS_DIR/$ENTRY" <<< "$INPUT"
+}
+
+# No tool_use_id means nothing to rendezvous on.
+if [[ "${CLAUDE_HOOK_DISPATCH:-1}" == "0" \
+      || ! $INPUT =~ \"tool_use_id\"[[:space:]]*:[[:space:]]*\"([A-Za-z0-9_-]+)\" ]]; then
+  run_direct "$@"
+fi
+CALL=${BASH_REMATCH[1]}
+
+DIR=${TMPDIR:-/tmp}
+DIR=${DIR%/}/claude-hook-dispatch-$UID
+[[ -d "$DIR" ]] || mkdir -m 700 "$DIR" 2>/dev/null
+# Only a private directory we own; anything else and plugins run separately.
+if [[ -L "$DIR" || ! -d "$DIR" || ! -O "$DIR" ]]; then
+  run_direct "$@"
+fi
+
+# noclobber makes each redirect below an O_EXCL create.
+set -C
+printf -v LINE '%s\t' 2 "$ROOT" "$ENTRY" "$@"
+# The same plugin hooked twice on one call: keep them independent.
+{ printf '%s\n' "${LINE%$'\t'}" > "$DIR/$CALL.$PLUGIN"; } 2>/dev/null || run_direct "$@"
+
+# Registered before this check, so a leader that hasn't published its done
+# file yet sees us in its last scan.
+if [[ -e "$DIR/$CALL.leader" && ! -e "$DIR/$CALL.done" ]]; then
+  exit 0
+fi
+if { : > "$DIR/$CALL.$PLUGIN.claim"; } 2>/dev/null; then
+  run_direct "$@"
+fi
+exit 0
@@ -19,34 +19,59 @@ if PLUGIN_ROOT:
         sys.path.insert(0, PLUGIN_ROOT)
 
 try:
-    from hookify.core.config_loader import load_rules
-    from hookify.core.rule_engine import RuleEngine
+    from hookify.core.daemon import evaluate
+    from hookify.utils import telemetry
 except ImportError as e:
     error_msg = {"systemMessage": f"Hookify import error: {e}"}
     print(json.dumps(error_msg), file=sys.stdout)
     sys.exit(0)
 
 
+# Merged hook dispatch (security-guidance's hook_dispatch.py, joined through
+# hooks/dispatch-follower.sh): no matcher, like the hooks.json entry, so
+# every tool's rules are evaluated.
+DISPATCH_MATCHER = None
+
+
+def _event_for(tool_name):
+    if tool_name == 'Bash':
+        return 'bash'
+    if tool_name in ['Edit', 'Write', 'MultiEdit']:
+        return 'file'
+    return None
+
+
+def dispatch(ctx):
+    """Entry point for merged hook dispatch.
+
+    ctx is the dispatcher's HookContext: the input is already parsed, and
+    the edit's new content is extracted once for every plugin. It seeds
+    the rule engine's 'content' field, which has the same definition.
+    """
+    timer = telemetry.start('posttooluse', ctx.input, ctx.raw)
+    try:
+        fields = None
+        if ctx.tool_name in ['Write', 'Edit', 'MultiEdit']:
+            fields = {('content', None): ctx.new_content}
+        return evaluate(_event_for(ctx.tool_name), ctx.input, fields)
+    finally:
+        telemetry.finish(timer)
+
+
 def main():
     """Main entry point for PostToolUse hook."""
+    timer = None
     try:
         # Read input from stdin
-        input_data = json.load(sys.stdin)
+        raw_input = sys.stdin.read()
+        input_data = json.loads(raw_input)
+        timer = telemetry.start('posttooluse', input_data, raw_input)
 
         # Determine event type based on tool
-        tool_name = input_data.get('tool_name', '')
-        event = None
-        if tool_name == 'Bash':
-            event = 'bash'
-        elif tool_name in ['Edit', 'Write', 'MultiEdit']:
-            event = 'file'
-
-        # Load rules
-        rules = load_rules(event=event)
+        event = _event_for(input_data.get('tool_name', ''))
 
-        # Evaluate rules
-        engine = RuleEngine()
-        result = engine.evaluate_rules(rules, input_data)
+        # Evaluate rules (via the resident daemon when enabled)
+        result = evaluate(event, input_data)
 
         # Always output JSON (even if empty)
         print(json.dumps(result), file=sys.stdout)
@@ -58,6 +83,7 @@ def main():
         print(json.dumps(error_output), file=sys.stdout)
 
     finally:
+        telemetry.finish(timer)
         # ALWAYS exit 0
         sys.exit(0)
 
@@ -23,8 +23,8 @@ if PLUGIN_ROOT:
         sys.path.insert(0, PLUGIN_ROOT)
 
 try:
-    from hookify.core.config_loader import load_rules
-    from hookify.core.rule_engine import RuleEngine
+    from hookify.core.daemon import evaluate
+    from hookify.utils import telemetry
 except ImportError as e:
     # If imports fail, allow operation and log error
     error_msg = {"systemMessage": f"Hookify import error: {e}"}
@@ -34,9 +34,12 @@ except ImportError as e:
 
 def main():
     """Main entry point for PreToolUse hook."""
+    timer = None
     try:
         # Read input from stdin
-        input_data = json.load(sys.stdin)
+        raw_input = sys.stdin.read()
+        input_data = json.loads(raw_input)
+        timer = telemetry.start('pretooluse', input_data, raw_input)
 
         # Determine event type for filtering
         # For PreToolUse, we use tool_name to determine "bash" vs "file" event
@@ -48,12 +51,8 @@ def main():
         elif tool_name in ['Edit', 'Write', 'MultiEdit']:
             event = 'file'
 
-        # Load rules
-        rules = load_rules(event=event)
-
-        # Evaluate rules
-        engine = RuleEngine()
-        result = engine.evaluate_rules(rules, input_data)
+        # Evaluate rules (via the resident daemon when enabled)
+        result = evaluate(event, input_data)
 
         # Always output JSON (even if empty)
         print(json.dumps(result), file=sys.stdout)
@@ -66,6 +65,7 @@ def main():
         print(json.dumps(error_output), file=sys.stdout)
 
     finally:
+        telemetry.finish(timer)
         # ALWAYS exit 0 - never block operations due to hook errors
         sys.exit(0)
 
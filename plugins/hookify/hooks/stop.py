@@ -19,8 +19,8 @@ if PLUGIN_ROOT:
         sys.path.insert(0, PLUGIN_ROOT)
 
 try:
-    from hookify.core.config_loader import load_rules
-    from hookify.core.rule_engine import RuleEngine
+    from hookify.core.daemon import evaluate
+    from hookify.utils import telemetry
 except ImportError as e:
     error_msg = {"systemMessage": f"Hookify import error: {e}"}
     print(json.dumps(error_msg), file=sys.stdout)
@@ -29,16 +29,15 @@ except ImportError as e:
 
 def main():
     """Main entry point for Stop hook."""
+    timer = None
     try:
         # Read input from stdin
-        input_data = json.load(sys.stdin)
+        raw_input = sys.stdin.read()
+        input_data = json.loads(raw_input)
+        timer = telemetry.start('stop', input_data, raw_input)
 
-        # Load stop rules
-        rules = load_rules(event='stop')
-
-        # Evaluate rules
-        engine = RuleEngine()
-        result = engine.evaluate_rules(rules, input_data)
+        # Evaluate stop rules (via the resident daemon when enabled)
+        result = evaluate('stop', input_data)
 
         # Always output JSON (even if empty)
         print(json.dumps(result), file=sys.stdout)
@@ -51,6 +50,7 @@ def main():
         print(json.dumps(error_output), file=sys.stdout)
 
     finally:
+        telemetry.finish(timer)
         # ALWAYS exit 0
         sys.exit(0)
 
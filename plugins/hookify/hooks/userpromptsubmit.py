@@ -19,8 +19,8 @@ if PLUGIN_ROOT:
         sys.path.insert(0, PLUGIN_ROOT)
 
 try:
-    from hookify.core.config_loader import load_rules
-    from hookify.core.rule_engine import RuleEngine
+    from hookify.core.daemon import evaluate
+    from hookify.utils import telemetry
 except ImportError as e:
     error_msg = {"systemMessage": f"Hookify import error: {e}"}
     print(json.dumps(error_msg), file=sys.stdout)
@@ -29,16 +29,15 @@ except ImportError as e:
 
 def main():
     """Main entry point for UserPromptSubmit hook."""
+    timer = None
     try:
         # Read input from stdin
-        input_data = json.load(sys.stdin)
+        raw_input = sys.stdin.read()
+        input_data = json.loads(raw_input)
+        timer = telemetry.start('userpromptsubmit', input_data, raw_input)
 
-        # Load user prompt rules
-        rules = load_rules(event='prompt')
-
-        # Evaluate rules
-        engine = RuleEngine()
-        result = engine.evaluate_rules(rules, input_data)
+        # Evaluate user prompt rules (via the resident daemon when enabled)
+        result = evaluate('prompt', input_data)
 
         # Always output JSON (even if empty)
         print(json.dumps(result), file=sys.stdout)
@@ -50,6 +49,7 @@ def main():
         print(json.dumps(error_output), file=sys.stdout)
 
     finally:
+        telemetry.finish(timer)
         # ALWAYS exit 0
         sys.exit(0)
 
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Compiled multi-pattern matching for hookify rules.
+
+RuleEngine used to scan each field value once per condition. CompiledRuleSet
+groups conditions by (field, scope, operator kind) and builds one combined
+alternation per group, so a field value is scanned once and every rule that
+can only fail is rejected without touching its own pattern:
+
+- regex_match conditions on a field share one IGNORECASE alternation
+- contains / not_contains conditions on a field share one literal alternation
+
+A combined scan that finds nothing proves no pattern in the group matches
+(the common case). Alternatives it does report are definite matches; any
+other pattern that is still needed is then checked individually, because
+finditer only reports non-overlapping leftmost matches. Results are
+identical to evaluating each condition on its own.
+"""
+
+import re
+import sys
+import warnings
+from typing import Any, Callable, Dict, List, Optional, Set
+
+from hookify.core.config_loader import Rule, Condition
+
+# Operators served by a combined scan, and the group kind they share
+_GROUPED_OPERATORS = {
+    'regex_match': 'regex',
+    'contains': 'literal',
+    'not_contains': 'literal',
+}
+
+# Constructs whose meaning depends on the pattern's own group numbering or
+# names, or that change flags for the whole expression (an inline global
+# flag such as (?m) or (?x); before Python 3.11 it compiles mid-pattern with
+# only a DeprecationWarning and then applies to every alternative). Such
+# patterns are kept out of the combined alternation and are always checked
+# individually. Scoped flags, (?m:...), are fine.
+_UNCOMBINABLE = re.compile(r'\\(?:[1-9]|g<)|\(\?P[<=]|\(\?\(|\(\?[aiLmsux]+\)')
+
+
+class PatternGroup:
+    """All patterns for one (field, kind), compiled into a single scan."""
+
+    def __init__(self, kind: str, patterns: List[str]):
+        self.kind = kind
+        self._individual: Dict[str, Optional[re.Pattern]] = {}
+        self._combined: Optional[re.Pattern] = None
+        self._group_names: Dict[str, str] = {}
+        # Patterns a combined-scan miss is conclusive for
+        self._combined_patterns: Set[str] = set()
+
+        alternatives = []
+        for pattern in dict.fromkeys(patterns):
+            if kind == 'literal':
+                source = re.escape(pattern)
+            else:
+                try:
+                    self._individual[pattern] = re.compile(pattern, re.IGNORECASE)
+                except re.error as e:
+                    print(f"Invalid regex pattern '{pattern}': {e}", file=sys.stderr)
+                    self._individual[pattern] = None
+                    continue
+                source = pattern
+                if _UNCOMBINABLE.search(pattern) or not self._wraps(pattern):
+                    continue
+
+            name = f"p{len(alternatives)}"
+            self._group_names[name] = pattern
+            alternatives.append(f"(?P<{name}>{source})")
+
+        if alternatives:
+            flags = re.IGNORECASE if kind == 'regex' else 0
+            try:
+                self._combined = re.compile('|'.join(alternatives), flags)
+            except (re.error, RecursionError, OverflowError):
+                # Fall back to individual checks for the whole group
+                self._combined = None
+                self._group_names = {}
+        self._combined_patterns = set(self._group_names.values())
+
+    @staticmethod
+    def _wraps(pattern: str) -> bool:
+        """A pattern can join the alternation if it compiles inside a group
+        without warnings (rejects e.g. global inline flags, which must lead
+        the pattern; Python < 3.11 only warns about them)."""
+        try:
+            with warnings.catch_warnings():
+                warnings.simplefilter('error')
+                re.compile(f"(?:{pattern})", re.IGNORECASE)
+            return True
+        except (re.error, Warning):
+            return False
+
+    def scan(self, text: str) -> 'GroupScan':
+        """Run the combined scan over one field value."""
+        hits: Set[str] = set()
+        if self._combined is not None:
+            for m in self._combined.finditer(text):
+                hits.add(self._group_names[m.lastgroup])
+        # No combined hit means no combined pattern can match anywhere
+        return GroupScan(self, text, hits, exhaustive=not hits)
+
+    def match_one(self, pattern: str, text: str) -> bool:
+        """Check a single pattern of this group directly."""
+        if self.kind == 'literal':
+            return pattern in text
+        regex = self._individual.get(pattern)
+        return bool(regex and regex.search(text))
+
+    def decided_by_scan(self, pattern: str) -> bool:
+        """True if a miss in the combined scan proves this pattern misses."""
+        return pattern in self._combined_patterns
+
+
+class GroupScan:
+    """Result of scanning one field value, with lazy per-pattern fallback."""
+
+    def __init__(self, group: PatternGroup, text: str, hits: Set[str], exhaustive: bool):
+        self._group = group
+        self._text = text
+        self._hits = hits
+        self._exhaustive = exhaustive
+        self._memo: Dict[str, bool] = {}
+
+    def matches(self, pattern: str) -> bool:
+        if pattern in self._hits:
+            return True
+        if pattern in self._memo:
+            return self._memo[pattern]
+        if self._exhaustive and self._group.decided_by_scan(pattern):
+            result = False
+        else:
+            result = self._group.match_one(pattern, self._text)
+        self._memo[pattern] = result
+        return result
+
+
+class CompiledRuleSet:
+    """A list of rules compiled for single-pass evaluation."""
+
+    def __init__(self, rules: List[Rule]):
+        self.rules = list(rules)
+        grouped: Dict[tuple, List[str]] = {}
+        for rule in self.rules:
+            for condition in rule.conditions:
+                kind = _GROUPED_OPERATORS.get(condition.operator)
+                if kind:
+                    key = (condition.field, condition.scope, kind)
+                    grouped.setdefault(key, []).append(condition.pattern)
+        self._groups = {key: PatternGroup(key[2], patterns) for key, patterns in grouped.items()}
+
+    def matching_indices(self, input_data: Dict[str, Any],
+                         extract_field: Callable[..., Optional[str]],
+                         matches_tool: Callable[[str, str], bool],
+                         fields: Optional[Dict[tuple, Optional[str]]] = None) -> List[int]:
+        """Return the index of every rule whose conditions all match, in order.
+
+        Args:
+            input_data: Hook input data
+            extract_field: RuleEngine._extract_field-compatible callable
+            matches_tool: RuleEngine._matches_tool-compatible callable
+            fields: Field values already extracted by the caller, keyed by
+                (field, scope); extract_field fills in the rest
+        """
+        tool_name = input_data.get('tool_name', '')
+        tool_input = input_data.get('tool_input', {})
+
+        values: Dict[tuple, Optional[str]] = dict(fields or {})
+        scans: Dict[tuple, Optional[GroupScan]] = {}
+
+        def field_value(field: str, scope: Optional[str]) -> Optional[str]:
+            if (field, scope) not in values:
+                values[(field, scope)] = extract_field(
+                    field, tool_name, tool_input, input_data, scope=scope)
+            return values[(field, scope)]
+
+        def check(condition: Condition) -> bool:
+            value = field_value(condition.field, condition.scope)
+            if value is None:
+                return False
+
+            kind = _GROUPED_OPERATORS.get(condition.operator)
+            if kind:
+                key = (condition.field, condition.scope, kind)
+                if key not in scans:
+                    scans[key] = self._groups[key].scan(value)
+                found = scans[key].matches(condition.pattern)
+                return not found if condition.operator == 'not_contains' else found
+
+            operator = condition.operator
+            pattern = condition.pattern
+            if operator == 'equals':
+                return pattern == value
+            elif operator == 'starts_with':
+                return value.startswith(pattern)
+            elif operator == 'ends_with':
+                return value.endswith(pattern)
+            # Unknown operator
+            return False
+
+        matched = []
+        for index, rule in enumerate(self.rules):
+            if rule.tool_matcher and not matches_tool(rule.tool_matcher, tool_name):
+                continue
+            # Rules must have at least one condition to be valid
+            if rule.conditions and all(check(c) for c in rule.conditions):
+                matched.append(index)
+        return matched
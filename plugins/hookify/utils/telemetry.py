@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Hook timing rows for hookify.
+
+With CLAUDE_HOOK_TIMINGS=1 each hook invocation appends one JSON line to
+CLAUDE_HOOK_TIMINGS_LOG (default ~/.claude/hook-timings.jsonl), the log every
+bundled plugin writes to, so per-tool-call overhead can be attributed to each
+plugin. The row schema is documented in plugins/README.md.
+
+Counters (rules evaluated, cache hits, transcript bytes read) are bumped from
+wherever the work happens. They are plain dict increments and always on, so
+a daemon spawned without the variable still reports stats to its clients.
+"""
+
+import json
+import os
+import time
+from typing import Any, Dict, Optional
+
+ENABLED = os.environ.get('CLAUDE_HOOK_TIMINGS', '0') == '1'
+LOG_PATH = os.environ.get('CLAUDE_HOOK_TIMINGS_LOG') or os.path.expanduser('~/.claude/hook-timings.jsonl')
+
+# Rotated to <log>.1 past this size, so the log stays bounded
+LOG_MAX_BYTES = 4 * 1024 * 1024
+
+_counts: Dict[str, int] = {}
+
+
+def count(key: str, n: int = 1) -> None:
+    """Add n to a per-invocation counter."""
+    if n:
+        _counts[key] = _counts.get(key, 0) + n
+
+
+def take_counts() -> Dict[str, int]:
+    """Return and clear the counters (the daemon does this per request)."""
+    counts = dict(_counts)
+    _counts.clear()
+    return counts
+
+
+def merge_counts(counts: Optional[Dict[str, Any]]) -> None:
+    """Fold counters reported by the daemon into this process's."""
+    for key, value in (counts or {}).items():
+        if isinstance(value, int):
+            count(key, value)
+
+
+def take_startup_ms() -> Optional[float]:
+    """Wall ms since the launcher shim exported CLAUDE_HOOK_TIMING_T0 (its
+    EPOCHREALTIME), or None without one (bash < 5, or started by python3
+    directly). Consumed, so only the first row of a process claims it: under
+    merged dispatch one interpreter serves several plugins."""
+    t0 = os.environ.pop('CLAUDE_HOOK_TIMING_T0', '')
+    try:
+        return max(0.0, time.time() * 1000 - float(t0.replace(',', '.')) * 1000)
+    except ValueError:
+        return None
+
+
+class HookTimer:
+    """Timing row for one hook invocation.
+
+    startup_ms is take_startup_ms() (omitted when unknown), eval_ms the wall
+    time from the timer's start to finish().
+    """
+
+    def __init__(self, hook: str, input_data: Dict[str, Any], raw_input: str):
+        self._startup_ms = take_startup_ms()
+        self._t0 = time.perf_counter()
+        self.row = {
+            'plugin': 'hookify',
+            'hook': hook,
+            'event': input_data.get('hook_event_name', ''),
+            'tool': input_data.get('tool_name', ''),
+            'session': input_data.get('session_id', ''),
+            'tool_use_id': input_data.get('tool_use_id', ''),
+            'stdin_bytes': len(raw_input.encode('utf-8', 'replace')),
+        }
+
+    def finish(self) -> None:
+        eval_ms = (time.perf_counter() - self._t0) * 1000
+        if self._startup_ms is not None:
+            self.row['startup_ms'] = round(self._startup_ms, 2)
+        self.row.update(
+            eval_ms=round(eval_ms, 2),
+            wall_ms=round((self._startup_ms or 0) + eval_ms, 2),
+        )
+        self.row.update(take_counts())
+        write_row(self.row)
+
+
+def start(hook: str, input_data: Dict[str, Any], raw_input: str) -> Optional[HookTimer]:
+    """A HookTimer when timings are enabled, else None."""
+    return HookTimer(hook, input_data, raw_input) if ENABLED else None
+
+
+def finish(timer: Optional[HookTimer]) -> None:
+    if timer is not None:
+        timer.finish()
+
+
+def write_row(row: Dict[str, Any]) -> None:
+    """Append one row to the shared log (best-effort)."""
+    try:
+        try:
+            if os.path.getsize(LOG_PATH) > LOG_MAX_BYTES:
+                os.replace(LOG_PATH, LOG_PATH + '.1')
+        except OSError:
+            pass
+        line = json.dumps({'ts': round(time.time(), 3), 'pid': os.getpid(), **row})
+        fd = os.open(LOG_PATH, os.O_WRONLY | os.O_CREAT | os.O_APPEND, 0o600)
+        with os.fdopen(fd, 'a') as f:
+            f.write(line + '\n')
+    except Exception:
+        pass
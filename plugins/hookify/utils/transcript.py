@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Bounded transcript access for hookify Stop rules.
+
+A session transcript is JSONL and can reach tens of MB. Conditions on the
+`transcript` field may narrow what they look at with a `scope`:
+
+- `all` (default): the whole transcript, read once per invocation
+- `last_assistant` / `last_assistant:N`: the last N assistant records
+- `since_last_stop`: records after the last user turn (the prompt or Stop
+  hook feedback that started the current stretch of work)
+
+Scoped reads seek backwards from EOF and stop as soon as the scope is
+satisfied, so their cost tracks the recent conversation rather than the
+whole session. Scoped text keeps the raw JSONL form (one record per line),
+so a pattern written for the full transcript behaves the same on a scope.
+"""
+
+import json
+import os
+import sys
+from typing import Dict, Iterator, List, Optional, Tuple
+
+from hookify.utils import telemetry
+
+BLOCK_SIZE = 64 * 1024
+
+DEFAULT_SCOPE = 'all'
+
+
+def parse_scope(scope: Optional[str]) -> Tuple[str, int]:
+    """Split a scope string into (kind, count).
+
+    Raises ValueError for an unknown scope.
+    """
+    if not scope or scope == DEFAULT_SCOPE:
+        return DEFAULT_SCOPE, 0
+    kind, _, count = scope.partition(':')
+    kind = kind.strip()
+    if kind == 'last_assistant':
+        n = int(count) if count.strip() else 1
+        if n < 1:
+            raise ValueError(f"scope count must be >= 1: {scope}")
+        return kind, n
+    if kind == 'since_last_stop' and not count:
+        return kind, 0
+    raise ValueError(f"unknown transcript scope: {scope}")
+
+
+def _reverse_lines(f, size: int) -> Iterator[bytes]:
+    """Yield the lines of a binary file from last to first."""
+    pos = size
+    pending = b''
+    while pos > 0:
+        step = min(BLOCK_SIZE, pos)
+        pos -= step
+        f.seek(pos)
+        chunk = f.read(step) + pending
+        telemetry.count('transcript_bytes', step)
+        lines = chunk.split(b'\n')
+        # The first piece may be the tail of a line that starts earlier
+        pending = lines.pop(0)
+        for line in reversed(lines):
+            if line.strip():
+                yield line
+    if pending.strip():
+        yield pending
+
+
+def _record(line: bytes) -> Optional[dict]:
+    try:
+        record = json.loads(line)
+    except (ValueError, UnicodeDecodeError):
+        return None
+    return record if isinstance(record, dict) else None
+
+
+def _is_assistant(record: dict) -> bool:
+    if record.get('type') == 'assistant':
+        return True
+    message = record.get('message')
+    return isinstance(message, dict) and message.get('role') == 'assistant'
+
+
+def _is_user_turn(record: dict) -> bool:
+    """A user record carrying text, as opposed to tool results."""
+    if record.get('type') != 'user':
+        return False
+    message = record.get('message')
+    content = message.get('content') if isinstance(message, dict) else None
+    if isinstance(content, str):
+        return True
+    if isinstance(content, list):
+        return any(
+            not (isinstance(part, dict) and part.get('type') == 'tool_result')
+            for part in content
+        )
+    return False
+
+
+class TranscriptReader:
+    """Reads one transcript file, memoizing each scope it is asked for."""
+
+    def __init__(self, path: str):
+        self.path = path
+        self._views: Dict[Tuple[str, int], str] = {}
+
+    def read(self, scope: Optional[str] = None) -> str:
+        """Return the transcript text for a scope ('' if unreadable)."""
+        kind, count = parse_scope(scope)
+        key = (kind, count)
+        if key not in self._views:
+            self._views[key] = self._load(kind, count)
+        return self._views[key]
+
+    def _load(self, kind: str, count: int) -> str:
+        try:
+            if kind == DEFAULT_SCOPE:
+                with open(self.path, 'r') as f:
+                    text = f.read()
+                telemetry.count('transcript_bytes', len(text))
+                return text
+            with open(self.path, 'rb') as f:
+                size = os.fstat(f.fileno()).st_size
+                return self._tail(f, size, kind, count)
+        except FileNotFoundError:
+            print(f"Warning: Transcript file not found: {self.path}", file=sys.stderr)
+        except PermissionError:
+            print(f"Warning: Permission denied reading transcript: {self.path}", file=sys.stderr)
+        except UnicodeDecodeError as e:
+            print(f"Warning: Encoding error in transcript {self.path}: {e}", file=sys.stderr)
+        except (IOError, OSError) as e:
+            print(f"Warning: Error reading transcript {self.path}: {e}", file=sys.stderr)
+        return ''
+
+    @staticmethod
+    def _tail(f, size: int, kind: str, count: int) -> str:
+        """Collect raw lines backwards from EOF until the scope is covered."""
+        lines: List[bytes] = []
+        found = 0
+        for line in _reverse_lines(f, size):
+            record = _record(line)
+            if kind == 'since_last_stop':
+                if record is not None and _is_user_turn(record):
+                    break
+                lines.append(line)
+            elif record is not None and _is_assistant(record):
+                lines.append(line)
+                found += 1
+                if found >= count:
+                    break
+        lines.reverse()
+        return b'\n'.join(lines).decode('utf-8', errors='replace')
+
+
+class TranscriptCache:
+    """Shares TranscriptReaders across rules (and, in the daemon, calls).
+
+    Keyed on (path, size, mtime) so an appended transcript is never served
+    stale. Holds one transcript at a time - a session only has one.
+    """
+
+    def __init__(self):
+        self._key = None
+        self._reader: Optional[TranscriptReader] = None
+
+    def reader(self, path: str) -> TranscriptReader:
+        try:
+            st = os.stat(path)
+            key = (path, st.st_size, st.st_mtime_ns)
+        except OSError:
+            # Let the reader report the error
+            return TranscriptReader(path)
+        if key != self._key:
+            self._key = key
+            self._reader = TranscriptReader(path)
+        return self._reader
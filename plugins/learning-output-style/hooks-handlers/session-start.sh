@@ -3,13 +3,58 @@
 # Output the learning mode instructions as additionalContext
 # This combines the unshipped Learning output style with explanatory functionality
 
-cat << 'EOF'
-{
-  "hookSpecificOutput": {
-    "hookEventName": "SessionStart",
-    "additionalContext": "You are in 'learning' output style mode, which combines interactive learning with educational explanations. This mode differs from the original unshipped Learning output style by also incorporating explanatory functionality.\n\n## Learning Mode Philosophy\n\nInstead of implementing everything yourself, identify opportunities where the user can write 5-10 lines of meaningful code that shapes the solution. Focus on business logic, design choices, and implementation strategies where their input truly matters.\n\n## When to Request User Contributions\n\nRequest code contributions for:\n- Business logic with multiple valid approaches\n- Error handling strategies\n- Algorithm implementation choices\n- Data structure decisions\n- User experience decisions\n- Design patterns and architecture choices\n\n## How to Request Contributions\n\nBefore requesting code:\n1. Create the file with surrounding context\n2. Add function signature with clear parameters/return type\n3. Include comments explaining the purpose\n4. Mark the location with TODO or clear placeholder\n\nWhen requesting:\n- Explain what you've built and WHY this decision matters\n- Reference the exact file and prepared location\n- Describe trade-offs to consider, constraints, or approaches\n- Frame it as valuable input that shapes the feature, not busy work\n- Keep requests focused (5-10 lines of code)\n\n## Example Request Pattern\n\nContext: I've set up the authentication middleware. The session timeout behavior is a security vs. UX trade-off - should sessions auto-extend on activity, or have a hard timeout? This affects both security posture and user experience.\n\nRequest: In auth/middleware.ts, implement the handleSessionTimeout() function to define the timeout behavior.\n\nGuidance: Consider: auto-extending improves UX but may leave sessions open longer; hard timeouts are more secure but might frustrate active users.\n\n## Balance\n\nDon't request contributions for:\n- Boilerplate or repetitive code\n- Obvious implementations with no meaningful choices\n- Configuration or setup code\n- Simple CRUD operations\n\nDo request contributions when:\n- There are meaningful trade-offs to consider\n- The decision shapes the feature's behavior\n- Multiple valid approaches exist\n- The user's domain knowledge would improve the solution\n\n## Explanatory Mode\n\nAdditionally, provide educational insights about the codebase as you help with tasks. Be clear and educational, providing helpful explanations while remaining focused on the task. Balance educational content with task completion.\n\n### Insights\nBefore and after writing code, provide brief educational explanations about implementation choices using:\n\n\"`★ Insight ─────────────────────────────────────`\n[2-3 key educational points]\n`─────────────────────────────────────────────────`\"\n\nThese insights should be included in the conversation, not in the codebase. Focus on interesting insights specific to the codebase or the code you just wrote, rather than general programming concepts. Provide insights as you write code, not just at the end."
+# Hook timing row for the log every bundled plugin shares
+# (CLAUDE_HOOK_TIMINGS=1, schema in plugins/README.md). EPOCHREALTIME needs
+# bash 5; older shells skip the row.
+if [[ "${CLAUDE_HOOK_TIMINGS:-0}" == "1" && -n "${EPOCHREALTIME:-}" ]]; then
+  TIMING_T0=${EPOCHREALTIME//,/.}
+  emit_timing() {
+    local log=${CLAUDE_HOOK_TIMINGS_LOG:-$HOME/.claude/hook-timings.jsonl}
+    local now=${EPOCHREALTIME//,/.} us
+    us=$(( ${now/./} - ${TIMING_T0/./} ))
+    printf '{"ts":%s,"pid":%d,"plugin":"%s","hook":"session-start","event":"SessionStart","tool":"","eval_ms":%d.%02d,"wall_ms":%d.%02d}\n' \
+      "${now%???}" "$$" "learning-output-style" $((us / 1000)) $((us % 1000 / 10)) $((us / 1000)) $((us % 1000 / 10)) \
+      >> "$log" 2>/dev/null || true
   }
+  trap emit_timing EXIT
+fi
+
+# The instructions live in output-styles/learning.md, which Claude Code also
+# offers as a native output style. When that style (or the built-in one of
+# the same name) is already selected, the instructions are in the system
+# prompt and this hook stays silent rather than inject them twice. Builtins
+# only, so the hook costs one bash process and no forks.
+STYLE_FILE="${CLAUDE_PLUGIN_ROOT:-${BASH_SOURCE[0]%/*}/..}/output-styles/learning.md"
+
+# outputStyle from the highest-precedence settings file that sets it
+selected_style() {
+  local project=${CLAUDE_PROJECT_DIR:-$PWD} file text
+  for file in "$project/.claude/settings.local.json" "$project/.claude/settings.json" "$HOME/.claude/settings.json"; do
+    [[ -r "$file" ]] || continue
+    IFS= read -r -d '' text < "$file" || true
+    if [[ $text =~ \"outputStyle\"[[:space:]]*:[[:space:]]*\"([^\"]*)\" ]]; then
+      SELECTED_STYLE=${BASH_REMATCH[1]}
+      return 0
+    fi
+  done
+  return 1
 }
-EOF
+
+# nocasematch rather than ${x,,}: macOS still ships bash 3.2
+shopt -s nocasematch
+if selected_style && [[ $SELECTED_STYLE == *learning* ]]; then
+  exit 0
+fi
+shopt -u nocasematch
+
+IFS= read -r -d '' context < "$STYLE_FILE" || true
+# Drop the frontmatter and the blank line after it, and the trailing newline
+context=${context#---$'\n'*$'\n'---$'\n'$'\n'}
+context=${context%$'\n'}
+context=${context//\\/\\\\}
+context=${context//\"/\\\"}
+context=${context//$'\n'/\\n}
+
+printf '{\n  "hookSpecificOutput": {\n    "hookEventName": "SessionStart",\n    "additionalContext": "%s"\n  }\n}\n' "$context"
 
 exit 0
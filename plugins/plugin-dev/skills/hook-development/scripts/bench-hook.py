@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""Hook benchmark runner behind `test-hook.sh --bench`.
+
+Replays a corpus of hook inputs against a hook command, runs each input N
+times, and reports wall-time percentiles, peak RSS, and how much of the time
+is interpreter startup (the same interpreter running an empty program) versus
+hook logic. Output is a JSON report with stable key order, so reports can be
+diffed or compared in CI.
+
+Subcommands:
+  run      benchmark a hook command against a corpus
+  extract  build a corpus of PreToolUse/PostToolUse inputs from a transcript
+
+Bash can't read per-process rusage portably, so this part is Python; the
+argument parsing and help live in test-hook.sh.
+"""
+import argparse
+import json
+import os
+import shlex
+import signal
+import subprocess
+import sys
+import time
+
+# ru_maxrss is kilobytes on Linux and bytes on macOS.
+_RSS_DIVISOR = 1024 if sys.platform == "darwin" else 1
+
+
+def load_corpus(path):
+    """Return [(name, input_bytes)] from a .json file, a .jsonl file, or a
+    directory of either."""
+    if os.path.isdir(path):
+        entries = []
+        for name in sorted(os.listdir(path)):
+            if name.endswith((".json", ".jsonl")):
+                entries.extend(load_corpus(os.path.join(path, name)))
+        return entries
+    base = os.path.basename(path)
+    with open(path, "rb") as f:
+        data = f.read()
+    if not path.endswith(".jsonl"):
+        json.loads(data)
+        return [(base, data)]
+    entries = []
+    for lineno, line in enumerate(data.splitlines(), 1):
+        if line.strip():
+            json.loads(line)
+            entries.append((f"{base}:{lineno}", line + b"\n"))
+    return entries
+
+
+def default_baseline(command):
+    """Command that starts the hook's interpreter and exits immediately.
+
+    `python3 hook.py` -> `python3 -c pass`; `bash sg-python.sh hook.py` ->
+    `bash sg-python.sh -c pass` (the shim's probing is startup cost too);
+    `hook.sh` -> `bash -c :`. None when the interpreter can't be guessed.
+    """
+    for i, arg in enumerate(command):
+        if arg.endswith(".py"):
+            prefix = command[:i]
+            if not prefix:
+                prefix = ["python3"]
+            return prefix + ["-c", "pass"]
+    first = os.path.basename(command[0])
+    if first in ("bash", "sh") or command[0].endswith(".sh"):
+        return [first if first in ("bash", "sh") else "bash", "-c", ":"]
+    if first.startswith("node"):
+        return [command[0], "-e", ""]
+    return None
+
+
+def run_once(command, stdin_bytes, timeout, env):
+    """(wall_ms, peak_rss_kb, exit_code) for one hook invocation."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(
+        command, stdin=subprocess.PIPE, stdout=subprocess.DEVNULL,
+        stderr=subprocess.DEVNULL, env=env, start_new_session=True,
+    )
+    try:
+        proc.stdin.write(stdin_bytes)
+        proc.stdin.close()
+    except BrokenPipeError:
+        pass
+    deadline = start + timeout
+    while True:
+        pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+        if pid:
+            break
+        if time.perf_counter() > deadline:
+            os.killpg(proc.pid, signal.SIGKILL)
+            pid, status, usage = os.wait4(proc.pid, 0)
+            proc.returncode = 124
+            return (time.perf_counter() - start) * 1000, usage.ru_maxrss // _RSS_DIVISOR, 124
+        time.sleep(0.0005)
+    wall_ms = (time.perf_counter() - start) * 1000
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    return wall_ms, usage.ru_maxrss // _RSS_DIVISOR, proc.returncode
+
+
+def percentile(values, pct):
+    """Nearest-rank percentile."""
+    if not values:
+        return None
+    ordered = sorted(values)
+    rank = max(1, -(-len(ordered) * pct // 100))
+    return ordered[int(rank) - 1]
+
+
+def summarize(wall, rss):
+    return {
+        "wall_ms": {
+            "p50": round(percentile(wall, 50), 2),
+            "p95": round(percentile(wall, 95), 2),
+            "p99": round(percentile(wall, 99), 2),
+            "mean": round(sum(wall) / len(wall), 2),
+            "max": round(max(wall), 2),
+        },
+        "peak_rss_kb": max(rss),
+    }
+
+
+def cmd_run(args):
+    command = shlex.split(args.command)
+    corpus = load_corpus(args.corpus)
+    if not corpus:
+        sys.exit(f"bench: no inputs in {args.corpus}")
+    env = dict(os.environ)
+
+    baseline = shlex.split(args.baseline) if args.baseline else default_baseline(command)
+    startup = None
+    if baseline and args.baseline != "none":
+        for _ in range(args.warmup):
+            run_once(baseline, b"", args.timeout, env)
+        samples = [run_once(baseline, b"", args.timeout, env) for _ in range(args.iterations)]
+        startup = summarize([s[0] for s in samples], [s[1] for s in samples])
+        startup["command"] = baseline
+
+    all_wall, all_rss, exit_codes, per_input = [], [], {}, []
+    for name, data in corpus:
+        for _ in range(args.warmup):
+            run_once(command, data, args.timeout, env)
+        wall, rss = [], []
+        for _ in range(args.iterations):
+            ms, kb, code = run_once(command, data, args.timeout, env)
+            wall.append(ms)
+            rss.append(kb)
+            exit_codes[str(code)] = exit_codes.get(str(code), 0) + 1
+        all_wall.extend(wall)
+        all_rss.extend(rss)
+        per_input.append({"input": name, **summarize(wall, rss)})
+        if args.progress:
+            print(f"  {name}: p50 {percentile(wall, 50):.1f} ms", file=sys.stderr)
+
+    report = {
+        "command": command,
+        "iterations": args.iterations,
+        "inputs": len(corpus),
+        "runs": len(all_wall),
+        **summarize(all_wall, all_rss),
+        "exit_codes": dict(sorted(exit_codes.items())),
+        "startup": startup,
+        "per_input": per_input,
+    }
+    if startup:
+        # p50-to-p50 split: what's left after the empty-interpreter run is
+        # the hook's own imports and logic.
+        p50 = report["wall_ms"]["p50"]
+        report["startup_ms_p50"] = startup["wall_ms"]["p50"]
+        report["logic_ms_p50"] = round(max(0.0, p50 - startup["wall_ms"]["p50"]), 2)
+        report["startup_share"] = round(min(1.0, startup["wall_ms"]["p50"] / p50), 3) if p50 else None
+
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+    if args.compare:
+        return compare(report, args.compare, args.threshold)
+    return 0
+
+
+def compare(report, old_path, threshold):
+    """Print p50/p95/p99 deltas vs an earlier report; 1 if p95 regressed by
+    more than threshold percent."""
+    with open(old_path) as f:
+        old = json.load(f)
+    regressed = False
+    for key in ("p50", "p95", "p99"):
+        before, after = old["wall_ms"][key], report["wall_ms"][key]
+        delta = (after - before) / before * 100 if before else 0.0
+        print(f"  {key}: {before:.1f} -> {after:.1f} ms ({delta:+.1f}%)", file=sys.stderr)
+        if key == "p95" and delta > threshold:
+            regressed = True
+    if regressed:
+        print(f"bench: p95 regressed by more than {threshold:g}%", file=sys.stderr)
+        return 1
+    return 0
+
+
+def cmd_extract(args):
+    """Turn a transcript's tool_use/tool_result pairs into hook inputs."""
+    results = {}
+    uses = []
+    with open(args.transcript) as f:
+        for line in f:
+            try:
+                entry = json.loads(line)
+            except ValueError:
+                continue
+            content = (entry.get("message") or {}).get("content")
+            if not isinstance(content, list):
+                continue
+            for block in content:
+                if not isinstance(block, dict):
+                    continue
+                if block.get("type") == "tool_use":
+                    uses.append((entry, block))
+                elif block.get("type") == "tool_result":
+                    results[block.get("tool_use_id")] = block.get("content")
+
+    events = args.events.split(",")
+    count = 0
+    with open(args.output, "w") as out:
+        for entry, block in uses:
+            if args.tool and block.get("name") not in args.tool.split(","):
+                continue
+            common = {
+                "session_id": entry.get("sessionId", "bench-session"),
+                "transcript_path": os.path.abspath(args.transcript),
+                "cwd": entry.get("cwd", os.getcwd()),
+                "permission_mode": "default",
+                "tool_name": block.get("name"),
+                "tool_input": block.get("input") or {},
+            }
+            if "PreToolUse" in events:
+                out.write(json.dumps({**common, "hook_event_name": "PreToolUse"}) + "\n")
+                count += 1
+            if "PostToolUse" in events and block.get("id") in results:
+                out.write(json.dumps({**common, "hook_event_name": "PostToolUse",
+                                      "tool_response": results[block["id"]]}) + "\n")
+                count += 1
+            if args.limit and count >= args.limit:
+                break
+    print(f"Wrote {count} hook inputs to {args.output}", file=sys.stderr)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    run = sub.add_parser("run")
+    run.add_argument("--command", required=True, help="hook command line")
+    run.add_argument("--corpus", required=True, help=".json, .jsonl, or a directory of them")
+    run.add_argument("--iterations", type=int, default=20)
+    run.add_argument("--warmup", type=int, default=1)
+    run.add_argument("--timeout", type=float, default=60)
+    run.add_argument("--baseline", help="startup baseline command, or 'none'")
+    run.add_argument("--output", help="write the JSON report here instead of stdout")
+    run.add_argument("--compare", help="earlier JSON report to compare against")
+    run.add_argument("--threshold", type=float, default=20.0, help="allowed p95 regression, percent")
+    run.add_argument("--progress", action="store_true")
+
+    ext = sub.add_parser("extract")
+    ext.add_argument("transcript")
+    ext.add_argument("output", help="corpus .jsonl to write")
+    ext.add_argument("--events", default="PreToolUse,PostToolUse")
+    ext.add_argument("--tool", help="comma-separated tool names to keep")
+    ext.add_argument("--limit", type=int, default=0)
+
+    args = parser.parse_args()
+    sys.exit(cmd_run(args) if args.cmd == "run" else cmd_extract(args))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Summarize the shared hook timing log.
+
+With CLAUDE_HOOK_TIMINGS=1 every bundled plugin appends one row per hook
+invocation to ~/.claude/hook-timings.jsonl (or CLAUDE_HOOK_TIMINGS_LOG); the
+row schema is in plugins/README.md. This groups the rows by plugin, hook and
+event. For each group it reports wall-time percentiles, how much of the time
+is interpreter startup, bytes read, rules and patterns evaluated, and cache
+hit rate. Rows carrying a tool_use_id are also summed per tool call, which
+attributes each call's total hook overhead to the plugins that added it.
+Output is JSON with stable key order, like bench-hook.py.
+"""
+import argparse
+import json
+import os
+import sys
+import time
+
+
+def percentile(values, pct):
+    """Nearest-rank percentile."""
+    if not values:
+        return None
+    ordered = sorted(values)
+    rank = max(1, -(-len(ordered) * pct // 100))
+    return ordered[int(rank) - 1]
+
+
+def load_rows(paths, since, session):
+    rows = []
+    for path in paths:
+        try:
+            f = open(path)
+        except OSError:
+            continue
+        with f:
+            for line in f:
+                try:
+                    row = json.loads(line)
+                except ValueError:
+                    continue
+                if not isinstance(row, dict) or not isinstance(row.get("wall_ms"), (int, float)):
+                    continue
+                if since and row.get("ts", 0) < since:
+                    continue
+                if session and row.get("session") != session:
+                    continue
+                rows.append(row)
+    rows.sort(key=lambda r: r.get("ts", 0))
+    return rows
+
+
+def _ms(values):
+    return round(values, 2) if values is not None else None
+
+
+def summarize_group(rows):
+    wall = [r["wall_ms"] for r in rows]
+    startup = [r["startup_ms"] for r in rows if isinstance(r.get("startup_ms"), (int, float))]
+    evaluate = [r["eval_ms"] for r in rows if isinstance(r.get("eval_ms"), (int, float))]
+    hits = sum(r.get("cache_hits", 0) for r in rows)
+    misses = sum(r.get("cache_misses", 0) for r in rows)
+    out = {
+        "runs": len(rows),
+        "wall_ms": {
+            "p50": _ms(percentile(wall, 50)),
+            "p95": _ms(percentile(wall, 95)),
+            "max": _ms(max(wall)),
+            "total": _ms(sum(wall)),
+        },
+        "startup_ms_p50": _ms(percentile(startup, 50)),
+        "eval_ms_p50": _ms(percentile(evaluate, 50)),
+        "startup_share": round(sum(startup) / sum(wall), 3) if startup and sum(wall) else None,
+        "stdin_bytes": sum(r.get("stdin_bytes", 0) for r in rows),
+        "transcript_bytes": sum(r.get("transcript_bytes", 0) for r in rows),
+        "rules_mean": round(sum(r.get("rules", 0) for r in rows) / len(rows), 2),
+        "patterns_mean": round(sum(r.get("patterns", 0) for r in rows) / len(rows), 2),
+        "cache_hit_rate": round(hits / (hits + misses), 3) if hits + misses else None,
+    }
+    outcomes = {}
+    for r in rows:
+        if "outcome" in r:
+            outcomes[r["outcome"]] = outcomes.get(r["outcome"], 0) + 1
+    if outcomes:
+        out["outcomes"] = dict(sorted(outcomes.items()))
+    return out
+
+
+def per_tool_call(rows, top):
+    """Sum rows sharing a tool_use_id; each plugin's share of the total."""
+    calls = {}
+    for r in rows:
+        if r.get("tool_use_id"):
+            calls.setdefault(r["tool_use_id"], []).append(r)
+    if not calls:
+        return None
+    by_plugin = {}
+    totals = []
+    for tool_use_id, call_rows in calls.items():
+        total = sum(r["wall_ms"] for r in call_rows)
+        plugins = {}
+        for r in call_rows:
+            plugins[r.get("plugin", "?")] = plugins.get(r.get("plugin", "?"), 0) + r["wall_ms"]
+        for plugin, ms in plugins.items():
+            by_plugin[plugin] = by_plugin.get(plugin, 0) + ms
+        totals.append((total, tool_use_id, call_rows[0].get("tool", ""), plugins))
+    grand = sum(t[0] for t in totals)
+    totals.sort(key=lambda t: -t[0])
+    return {
+        "calls": len(totals),
+        "overhead_ms": {
+            "p50": _ms(percentile([t[0] for t in totals], 50)),
+            "p95": _ms(percentile([t[0] for t in totals], 95)),
+            "total": _ms(grand),
+        },
+        "plugin_share": {
+            plugin: round(ms / grand, 3) if grand else None
+            for plugin, ms in sorted(by_plugin.items(), key=lambda kv: -kv[1])
+        },
+        "slowest": [
+            {"tool_use_id": tool_use_id, "tool": tool, "total_ms": _ms(total),
+             "plugins": {p: _ms(ms) for p, ms in sorted(plugins.items(), key=lambda kv: -kv[1])}}
+            for total, tool_use_id, tool, plugins in totals[:top]
+        ],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("log", nargs="?",
+                        default=os.environ.get("CLAUDE_HOOK_TIMINGS_LOG")
+                        or os.path.expanduser("~/.claude/hook-timings.jsonl"))
+    parser.add_argument("--hours", type=float, help="only rows from the last N hours")
+    parser.add_argument("--session", help="only rows from this session id")
+    parser.add_argument("--top", type=int, default=10, help="slowest tool calls to list")
+    parser.add_argument("--no-rotated", action="store_true", help="skip the rotated <log>.1")
+    parser.add_argument("--output", help="write the JSON report here instead of stdout")
+    args = parser.parse_args()
+
+    paths = [args.log] if args.no_rotated else [args.log + ".1", args.log]
+    since = time.time() - args.hours * 3600 if args.hours else None
+    rows = load_rows(paths, since, args.session)
+    if not rows:
+        sys.exit(f"hook-timings: no timing rows in {args.log} (set CLAUDE_HOOK_TIMINGS=1 to record)")
+
+    groups = {}
+    for r in rows:
+        key = (r.get("plugin", "?"), r.get("hook", "?"), r.get("event", ""))
+        groups.setdefault(key, []).append(r)
+    report = {
+        "log": args.log,
+        "rows": len(rows),
+        "from_ts": rows[0].get("ts"),
+        "to_ts": rows[-1].get("ts"),
+        "hooks": [
+            {"plugin": plugin, "hook": hook, "event": event, **summarize_group(group)}
+            for (plugin, hook, event), group in sorted(
+                groups.items(), key=lambda kv: -sum(r["wall_ms"] for r in kv[1]))
+        ],
+        "per_tool_call": per_tool_call(rows, args.top),
+    }
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -19,9 +19,29 @@ show_usage() {
   echo ""
   echo "Creates sample test input with:"
   echo "  $0 --create-sample <event-type>"
+  echo ""
+  echo "Benchmark mode (replays a corpus N times per input, JSON report):"
+  echo "  $0 --bench N [bench options] <corpus> <hook-command> [args...]"
+  echo ""
+  echo "  <corpus> is a .json input, a .jsonl file (one input per line), or a"
+  echo "  directory of either. Bench options:"
+  echo "  --warmup N        Untimed runs per input first (default: 1)"
+  echo "  --baseline CMD    Startup baseline command (default: guessed from the"
+  echo "                    hook command, e.g. 'python3 -c pass'); 'none' to skip"
+  echo "  -o, --output FILE Write the JSON report to FILE instead of stdout"
+  echo "  --compare FILE    Compare with an earlier report; exit 1 if p95 regressed"
+  echo "  --threshold PCT   Allowed p95 regression for --compare (default: 20)"
+  echo ""
+  echo "  $0 --bench 20 corpus.jsonl python3 hooks/pretooluse.py"
+  echo "  $0 --bench 20 corpus/ bash hooks/sg-python.sh hooks/security_reminder_hook.py"
+  echo ""
+  echo "Builds a corpus from a session transcript with:"
+  echo "  $0 --extract-corpus <transcript.jsonl> <corpus.jsonl> [--tool Edit,Write]"
   exit 0
 }
 
+BENCH_RUNNER="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)/bench-hook.py"
+
 # Create sample input
 create_sample() {
   event_type="$1"
@@ -102,6 +122,8 @@ EOF
 # Parse arguments
 VERBOSE=false
 TIMEOUT=60
+BENCH=""
+BENCH_ARGS=()
 
 while [ $# -gt 0 ]; do
   case "$1" in
@@ -120,12 +142,61 @@ while [ $# -gt 0 ]; do
       create_sample "$2"
       exit 0
       ;;
+    --extract-corpus)
+      shift
+      exec python3 "$BENCH_RUNNER" extract "$@"
+      ;;
+    -b|--bench)
+      BENCH="$2"
+      shift 2
+      ;;
+    --warmup|--baseline|--compare|--threshold)
+      BENCH_ARGS+=("$1" "$2")
+      shift 2
+      ;;
+    -o|--output)
+      BENCH_ARGS+=(--output "$2")
+      shift 2
+      ;;
     *)
       break
       ;;
   esac
 done
 
+# Benchmark mode: the hook is a full command line (so interpreter-launched
+# hooks like `python3 pretooluse.py` work), timed by bench-hook.py.
+if [ -n "$BENCH" ]; then
+  if [ $# -lt 2 ]; then
+    echo "Error: --bench needs <corpus> <hook-command> [args...]"
+    echo ""
+    show_usage
+  fi
+  CORPUS="$1"
+  shift
+  if [ ! -e "$CORPUS" ]; then
+    echo "❌ Error: Corpus not found: $CORPUS"
+    exit 1
+  fi
+  if [ $# -eq 1 ] && [ -f "$1" ] && [ ! -x "$1" ]; then
+    set -- bash "$1"
+  fi
+
+  export CLAUDE_PROJECT_DIR="${CLAUDE_PROJECT_DIR:-/tmp/test-project}"
+  export CLAUDE_PLUGIN_ROOT="${CLAUDE_PLUGIN_ROOT:-$(pwd)}"
+  export CLAUDE_ENV_FILE="${CLAUDE_ENV_FILE:-/tmp/test-env-$$}"
+
+  echo "⏱️  Benchmarking: $* ($BENCH runs per input)" >&2
+  set +e
+  python3 "$BENCH_RUNNER" run --command "$(printf '%q ' "$@")" --corpus "$CORPUS" \
+    --iterations "$BENCH" --timeout "$TIMEOUT" ${BENCH_ARGS[@]+"${BENCH_ARGS[@]}"} \
+    $([ "$VERBOSE" = true ] && echo --progress)
+  bench_exit=$?
+  set -e
+  rm -f "$CLAUDE_ENV_FILE"
+  exit $bench_exit
+fi
+
 if [ $# -ne 2 ]; then
   echo "Error: Missing required arguments"
   echo ""
@@ -0,0 +1,553 @@
+#!/usr/bin/env python3
+"""Batch validator for whole marketplaces of plugins.
+
+The per-file validators (validate-hook-schema.sh, hook-linter.sh,
+validate-agent.sh, validate-settings.sh) run a chain of jq/grep/sed
+processes per field, which is fine for one plugin and slow for a
+marketplace. This runs the same checks in one process: each plugin.json,
+hooks.json, hook script and agent file is read and parsed once, plugins are
+validated in parallel across cores, and the result is one JSON report with
+stable key order.
+
+  validate-plugins.py                              # ./.claude-plugin/marketplace.json
+  validate-plugins.py --marketplace path/to/marketplace.json
+  validate-plugins.py --plugin plugins/my-plugin --settings .claude/my-plugin.local.md
+
+Exits 1 if any error was found (or any warning, with --strict). Tips the
+shell scripts print (the 💡 lines) are left out of the report.
+"""
+import argparse
+import json
+import os
+import re
+import sys
+import time
+from concurrent.futures import ProcessPoolExecutor
+
+VALID_EVENTS = ("PreToolUse", "PostToolUse", "UserPromptSubmit", "Stop", "SubagentStop",
+                "SessionStart", "SessionEnd", "PreCompact", "Notification")
+PROMPT_HOOK_EVENTS = ("Stop", "SubagentStop", "UserPromptSubmit", "PreToolUse")
+AGENT_MODELS = ("inherit", "sonnet", "opus", "haiku")
+AGENT_COLORS = ("blue", "cyan", "green", "yellow", "magenta", "red")
+AGENT_FIELDS = ("name", "description", "model", "color", "tools")
+
+PLUGIN_NAME_RE = re.compile(r"^[a-z][a-z0-9]*(-[a-z0-9]+)*$")
+SEMVER_RE = re.compile(r"^\d+\.\d+\.\d+(-[0-9A-Za-z.-]+)?(\+[0-9A-Za-z.-]+)?$")
+AGENT_NAME_RE = re.compile(r"^[a-zA-Z0-9][a-zA-Z0-9-]*[a-zA-Z0-9]$")
+FIELD_RE = re.compile(r"^([A-Za-z_][A-Za-z0-9_-]*):\s*(.*)$")
+PLUGIN_ROOT_PATH_RE = re.compile(r"\$\{?CLAUDE_PLUGIN_ROOT\}?(/[^\s\"'`;|&)]+)")
+
+
+class Report:
+    """Errors and warnings for one plugin (or marketplace, or settings file)."""
+
+    def __init__(self, root):
+        self.root = root
+        self.errors = []
+        self.warnings = []
+        self.files = 0
+
+    def _issue(self, path, where, message):
+        issue = {"file": os.path.relpath(path, self.root) if self.root else path, "message": message}
+        if where:
+            issue["where"] = where
+        return issue
+
+    def error(self, path, message, where=None):
+        self.errors.append(self._issue(path, where, message))
+
+    def warn(self, path, message, where=None):
+        self.warnings.append(self._issue(path, where, message))
+
+
+def read_text(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        return f.read()
+
+
+def load_json(report, path):
+    """Parsed JSON, or None (with an error recorded) if unreadable."""
+    report.files += 1
+    try:
+        with open(path, encoding="utf-8") as f:
+            return json.load(f)
+    except (OSError, ValueError) as e:
+        report.error(path, f"Invalid JSON: {e}")
+        return None
+
+
+def split_frontmatter(text):
+    """(frontmatter lines, body) for a '---'-delimited file.
+
+    frontmatter is None when the file doesn't start with '---'; body is None
+    when the frontmatter is never closed.
+    """
+    lines = text.split("\n")
+    if not lines or lines[0].rstrip("\r") != "---":
+        return None, None
+    for i in range(1, len(lines)):
+        if lines[i].rstrip("\r") == "---":
+            return lines[1:i], "\n".join(lines[i + 1:])
+    return lines[1:], None
+
+
+def frontmatter_fields(lines, keys=None):
+    """Top-level `key: value` pairs. Lines that don't start a known key are
+    continuations of the previous value, so unindented multi-line agent
+    descriptions (with their <example> blocks) stay in one field."""
+    fields = {}
+    current = None
+    for line in lines:
+        line = line.rstrip("\r")
+        m = FIELD_RE.match(line)
+        if m and (keys is None or m.group(1) in keys):
+            current = m.group(1)
+            value = m.group(2).strip()
+            fields[current] = "" if value in ("|", ">", "|-", ">-") else value
+        elif current is not None:
+            fields[current] += "\n" + line.strip()
+    for key, value in fields.items():
+        value = value.strip()
+        if len(value) >= 2 and value[0] == value[-1] and value[0] in "\"'" and "\n" not in value:
+            value = value[1:-1]
+        fields[key] = value
+    return fields
+
+
+# --- manifest ---------------------------------------------------------------
+
+def check_component_path(report, path, plugin_dir, field, value):
+    values = value if isinstance(value, list) else [value]
+    for item in values:
+        if not isinstance(item, str):
+            report.error(path, f"'{field}' entries must be strings")
+            continue
+        if item.startswith("/") or "\\" in item:
+            report.error(path, f"'{field}' path must be relative with forward slashes: {item}")
+            continue
+        if ".." in item.split("/"):
+            report.error(path, f"'{field}' path must not use '..': {item}")
+            continue
+        if not item.startswith("./"):
+            report.warn(path, f"'{field}' path should start with './': {item}")
+        if not os.path.exists(os.path.join(plugin_dir, item)):
+            report.error(path, f"'{field}' path does not exist: {item}")
+
+
+def check_manifest(report, plugin_dir, entry):
+    """Validate .claude-plugin/plugin.json. Returns the manifest dict ({} if
+    missing) so later checks can follow its component paths."""
+    path = os.path.join(plugin_dir, ".claude-plugin", "plugin.json")
+    if not os.path.isfile(path):
+        if entry is None:
+            report.error(path, "Missing manifest")
+        else:
+            report.warn(path, "No manifest; relying on the marketplace entry for metadata")
+        return {}
+    manifest = load_json(report, path)
+    if manifest is None:
+        return {}
+    if not isinstance(manifest, dict):
+        report.error(path, "Manifest must be a JSON object")
+        return {}
+
+    name = manifest.get("name")
+    if not name:
+        report.error(path, "Missing required field: name")
+    elif not isinstance(name, str) or not PLUGIN_NAME_RE.match(name):
+        report.error(path, f"name must be kebab-case (lowercase letters, numbers, hyphens): {name}")
+    elif entry is not None and entry.get("name") and entry["name"] != name:
+        report.error(path, f"name '{name}' does not match marketplace entry '{entry['name']}'")
+
+    version = manifest.get("version")
+    if version is not None and not (isinstance(version, str) and SEMVER_RE.match(version)):
+        report.error(path, f"version must be semantic (MAJOR.MINOR.PATCH): {version}")
+    if not manifest.get("description"):
+        report.warn(path, "Missing description")
+
+    for field in ("commands", "agents"):
+        if field in manifest:
+            check_component_path(report, path, plugin_dir, field, manifest[field])
+    for field in ("hooks", "mcpServers"):
+        if isinstance(manifest.get(field), str):
+            check_component_path(report, path, plugin_dir, field, manifest[field])
+        elif field in manifest and not isinstance(manifest[field], dict):
+            report.error(path, f"'{field}' must be a path or an inline object")
+    return manifest
+
+
+# --- hooks ------------------------------------------------------------------
+
+def check_hooks(report, plugin_dir, path, config, scripts):
+    """validate-hook-schema.sh checks on one hooks config. Accepts the plugin
+    format ({"hooks": {...}}) and the bare settings format. Script paths under
+    ${CLAUDE_PLUGIN_ROOT} are collected into `scripts` (path -> run directly)
+    for linting."""
+    if not isinstance(config, dict):
+        report.error(path, "Hooks config must be a JSON object")
+        return
+    events = config["hooks"] if isinstance(config.get("hooks"), dict) else config
+    for event, matchers in events.items():
+        if event == "description":
+            continue
+        if event not in VALID_EVENTS:
+            report.warn(path, f"Unknown event type: {event}")
+        if not isinstance(matchers, list):
+            report.error(path, "Event must map to an array of matchers", event)
+            continue
+        for i, group in enumerate(matchers):
+            where = f"{event}[{i}]"
+            if not isinstance(group, dict):
+                report.error(path, "Matcher entry must be an object", where)
+                continue
+            # A matcher is optional in plugin hooks (omitted = match all), so
+            # unlike validate-hook-schema.sh a missing one isn't an error.
+            hooks = group.get("hooks")
+            if not isinstance(hooks, list) or not hooks:
+                report.error(path, "Missing 'hooks' array", where)
+                continue
+            for j, hook in enumerate(hooks):
+                check_hook(report, plugin_dir, path, event, f"{where}.hooks[{j}]", hook, scripts)
+
+
+def check_hook(report, plugin_dir, path, event, where, hook, scripts):
+    if not isinstance(hook, dict):
+        report.error(path, "Hook must be an object", where)
+        return
+    hook_type = hook.get("type")
+    if not hook_type:
+        report.error(path, "Missing 'type' field", where)
+        return
+    if hook_type not in ("command", "prompt"):
+        report.error(path, f"Invalid type '{hook_type}' (must be 'command' or 'prompt')", where)
+        return
+    if hook_type == "command":
+        command = hook.get("command")
+        if not command or not isinstance(command, str):
+            report.error(path, "Command hooks must have 'command' field", where)
+        else:
+            if command.startswith("/") and "${CLAUDE_PLUGIN_ROOT}" not in command:
+                report.warn(path, "Hardcoded absolute path detected. Consider using ${CLAUDE_PLUGIN_ROOT}", where)
+            for rel in PLUGIN_ROOT_PATH_RE.findall(command):
+                target = os.path.join(plugin_dir, rel.lstrip("/"))
+                if not os.path.exists(target):
+                    report.error(path, f"Referenced file does not exist: ${{CLAUDE_PLUGIN_ROOT}}{rel}", where)
+                elif target.endswith(".sh"):
+                    target = os.path.normpath(target)
+                    direct = command.lstrip("\"'").startswith(("${CLAUDE_PLUGIN_ROOT}" + rel, "$CLAUDE_PLUGIN_ROOT" + rel))
+                    scripts[target] = scripts.get(target, False) or direct
+    else:
+        if not hook.get("prompt"):
+            report.error(path, "Prompt hooks must have 'prompt' field", where)
+        if event not in PROMPT_HOOK_EVENTS:
+            report.warn(path, f"Prompt hooks may not be fully supported on {event} "
+                              "(best on Stop, SubagentStop, UserPromptSubmit, PreToolUse)", where)
+    if "timeout" in hook and hook["timeout"] is not None:
+        timeout = hook["timeout"]
+        if isinstance(timeout, bool) or not isinstance(timeout, int) or timeout < 0:
+            report.error(path, "Timeout must be a number", where)
+        elif timeout > 600:
+            report.warn(path, f"Timeout {timeout} seconds is very high (max 600s)", where)
+        elif timeout < 5:
+            report.warn(path, f"Timeout {timeout} seconds is very low", where)
+
+
+def lint_script(report, path, direct):
+    """hook-linter.sh checks on one hook script. `direct` means a command runs
+    it without naming an interpreter, so it has to be executable.
+
+    The linter's unquoted-variable check matches nearly every script (its
+    regex backtracks into any variable name), so it isn't carried over.
+    """
+    report.files += 1
+    try:
+        text = read_text(path)
+    except OSError as e:
+        report.error(path, f"Unreadable: {e}")
+        return
+    if direct and not os.access(path, os.X_OK):
+        report.warn(path, f"Not executable (chmod +x {os.path.basename(path)})")
+    if not text.startswith("#!/"):
+        report.error(path, "Missing shebang (#!/bin/bash)")
+    if "set -euo pipefail" not in text:
+        report.warn(path, "Missing 'set -euo pipefail' (recommended for safety)")
+    if "cat" not in text and "read" not in text:
+        report.warn(path, "Doesn't appear to read input from stdin")
+    if re.search(r"tool_input|tool_name", text) and "jq" not in text:
+        report.warn(path, "Parses hook input but doesn't use jq")
+    if re.search(r"^[^#\n]*(/home/|/usr/|/opt/)", text, re.M):
+        report.warn(path, "Hardcoded absolute paths detected; use $CLAUDE_PROJECT_DIR or $CLAUDE_PLUGIN_ROOT")
+    if "exit 0" not in text and "exit 2" not in text:
+        report.warn(path, "No explicit exit codes (should exit 0 or 2)")
+    if any("#" not in line for line in re.findall(r"^.*(?:sleep [0-9]{3,}|while true).*$", text, re.M)):
+        report.warn(path, "Potentially long-running code detected; hooks should complete quickly (< 60s)")
+    if re.search(r'echo.*".*error|Error|denied|Denied', text) and ">&2" not in text:
+        report.warn(path, "Error messages should be written to stderr (>&2)")
+
+
+# --- agents -----------------------------------------------------------------
+
+def check_agent(report, path):
+    """validate-agent.sh checks on one agent file."""
+    report.files += 1
+    try:
+        text = read_text(path)
+    except OSError as e:
+        report.error(path, f"Unreadable: {e}")
+        return
+    lines, body = split_frontmatter(text)
+    if lines is None:
+        report.error(path, "File must start with YAML frontmatter (---)")
+        return
+    if body is None:
+        report.error(path, "Frontmatter not closed (missing second ---)")
+        return
+    fields = frontmatter_fields(lines, AGENT_FIELDS)
+
+    name = fields.get("name")
+    if not name:
+        report.error(path, "Missing required field: name")
+    else:
+        if not AGENT_NAME_RE.match(name):
+            report.error(path, "name must start/end with alphanumeric and contain only letters, numbers, hyphens")
+        if len(name) < 3:
+            report.error(path, "name too short (minimum 3 characters)")
+        elif len(name) > 50:
+            report.error(path, "name too long (maximum 50 characters)")
+        if name in ("helper", "assistant", "agent", "tool"):
+            report.warn(path, f"name is too generic: {name}")
+
+    description = fields.get("description")
+    if not description:
+        report.error(path, "Missing required field: description")
+    else:
+        if len(description) < 10:
+            report.warn(path, "description too short (minimum 10 characters recommended)")
+        elif len(description) > 5000:
+            report.warn(path, "description very long (over 5000 characters)")
+        if "<example>" not in description:
+            report.warn(path, "description should include <example> blocks for triggering")
+        if "use this agent when" not in description.lower():
+            report.warn(path, "description should start with 'Use this agent when...'")
+
+    model = fields.get("model")
+    if not model:
+        report.error(path, "Missing required field: model")
+    elif model not in AGENT_MODELS:
+        report.warn(path, f"Unknown model: {model} (valid: {', '.join(AGENT_MODELS)})")
+
+    color = fields.get("color")
+    if not color:
+        report.error(path, "Missing required field: color")
+    elif color not in AGENT_COLORS:
+        report.warn(path, f"Unknown color: {color} (valid: {', '.join(AGENT_COLORS)})")
+
+    prompt = body.strip("\n")
+    if not prompt.strip():
+        report.error(path, "System prompt is empty")
+        return
+    if len(prompt) < 20:
+        report.error(path, "System prompt too short (minimum 20 characters)")
+    elif len(prompt) > 10000:
+        report.warn(path, "System prompt very long (over 10,000 characters)")
+    if not re.search(r"You are|You will|Your", prompt):
+        report.warn(path, "System prompt should use second person (You are..., You will...)")
+
+
+def agent_files(plugin_dir, manifest):
+    """agents/*.md plus any extra agent paths from the manifest, deduplicated."""
+    roots = [os.path.join(plugin_dir, "agents")]
+    extra = manifest.get("agents", [])
+    for item in extra if isinstance(extra, list) else [extra]:
+        if isinstance(item, str):
+            roots.append(os.path.join(plugin_dir, item))
+    files = set()
+    for root in roots:
+        if os.path.isfile(root) and root.endswith(".md"):
+            files.add(os.path.normpath(root))
+        elif os.path.isdir(root):
+            for name in os.listdir(root):
+                if name.endswith(".md"):
+                    files.add(os.path.normpath(os.path.join(root, name)))
+    return sorted(files)
+
+
+# --- settings ---------------------------------------------------------------
+
+def check_settings(path):
+    """validate-settings.sh checks on one .claude/<plugin>.local.md file."""
+    report = Report(None)
+    report.files += 1
+    try:
+        text = read_text(path)
+    except OSError as e:
+        report.error(path, f"Unreadable: {e}")
+        return path, report
+    lines, body = split_frontmatter(text)
+    if lines is None or body is None:
+        report.error(path, "Invalid frontmatter: need opening and closing '---' markers")
+        return path, report
+    if not "".join(lines).strip():
+        report.error(path, "Empty frontmatter (nothing between --- markers)")
+        return path, report
+    if not any(":" in line for line in lines):
+        report.warn(path, "Frontmatter has no key:value pairs")
+    fields = frontmatter_fields(lines)
+    for field in ("enabled", "strict_mode"):
+        if field in fields and fields[field] not in ("true", "false"):
+            report.warn(path, f"Field '{field}' should be boolean (true/false), got: {fields[field]}")
+    if not body.strip():
+        report.warn(path, "No markdown body (frontmatter only)")
+    return path, report
+
+
+# --- drivers ----------------------------------------------------------------
+
+def validate_plugin(task):
+    """Run every check for one plugin. Top-level so it pickles for the pool."""
+    plugin_dir, entry = task
+    report = Report(plugin_dir)
+    manifest = check_manifest(report, plugin_dir, entry)
+
+    scripts = {}
+    hook_sources = []
+    default_hooks = os.path.join(plugin_dir, "hooks", "hooks.json")
+    if os.path.isfile(default_hooks):
+        hook_sources.append((default_hooks, None))
+    if isinstance(manifest.get("hooks"), str):
+        custom = os.path.normpath(os.path.join(plugin_dir, manifest["hooks"]))
+        if os.path.isfile(custom) and custom != os.path.normpath(default_hooks):
+            hook_sources.append((custom, None))
+    elif isinstance(manifest.get("hooks"), dict):
+        hook_sources.append((os.path.join(plugin_dir, ".claude-plugin", "plugin.json"), manifest["hooks"]))
+    for path, inline in hook_sources:
+        config = inline if inline is not None else load_json(report, path)
+        if config is not None:
+            check_hooks(report, plugin_dir, path, config, scripts)
+    for script in sorted(scripts):
+        lint_script(report, script, scripts[script])
+
+    for path in agent_files(plugin_dir, manifest):
+        check_agent(report, path)
+
+    name = manifest.get("name") or (entry or {}).get("name") or os.path.basename(plugin_dir)
+    return {
+        "name": name,
+        "path": os.path.relpath(plugin_dir),
+        "files": report.files,
+        "errors": report.errors,
+        "warnings": report.warnings,
+    }
+
+
+def marketplace_tasks(path):
+    """(report entry, [(plugin_dir, marketplace entry)]) for one marketplace.json."""
+    report = Report(None)
+    data = load_json(report, path)
+    tasks = []
+    plugins = data.get("plugins") if isinstance(data, dict) else None
+    if data is not None and not isinstance(plugins, list):
+        report.error(path, "Marketplace must have a 'plugins' array")
+        plugins = []
+    # Sources are relative to the directory that holds .claude-plugin/.
+    base = os.path.dirname(os.path.abspath(path))
+    if os.path.basename(base) == ".claude-plugin":
+        base = os.path.dirname(base)
+    seen = set()
+    skipped = 0
+    for i, entry in enumerate(plugins or []):
+        where = f"plugins[{i}]"
+        if not isinstance(entry, dict) or not entry.get("name"):
+            report.error(path, "Plugin entry must be an object with a 'name'", where)
+            continue
+        if entry["name"] in seen:
+            report.error(path, f"Duplicate plugin name: {entry['name']}", where)
+        seen.add(entry["name"])
+        source = entry.get("source")
+        if not isinstance(source, str):
+            skipped += 1  # remote (github/url) source; nothing on disk to check
+            continue
+        plugin_dir = os.path.normpath(os.path.join(base, source))
+        if not os.path.isdir(plugin_dir):
+            report.error(path, f"Plugin source does not exist: {source}", where)
+            continue
+        tasks.append((plugin_dir, entry))
+    result = {"path": path, "plugins": len(tasks), "remote_skipped": skipped,
+              "errors": report.errors, "warnings": report.warnings}
+    return result, tasks
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--marketplace", action="append", default=[],
+                        help="marketplace.json to validate with all its local plugins (repeatable)")
+    parser.add_argument("--plugin", action="append", default=[], help="plugin directory (repeatable)")
+    parser.add_argument("--settings", action="append", default=[],
+                        help=".claude/<plugin>.local.md settings file (repeatable)")
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count() or 1,
+                        help="worker processes (default: one per core)")
+    parser.add_argument("--output", "-o", help="write the JSON report here instead of stdout")
+    parser.add_argument("--strict", action="store_true", help="fail on warnings too")
+    args = parser.parse_args()
+
+    if not (args.marketplace or args.plugin or args.settings):
+        default = os.path.join(".claude-plugin", "marketplace.json")
+        if not os.path.isfile(default):
+            parser.error("nothing to validate (no ./.claude-plugin/marketplace.json)")
+        args.marketplace = [default]
+
+    start = time.perf_counter()
+    marketplaces, tasks, seen_dirs = [], [], set()
+    for path in args.marketplace:
+        result, found = marketplace_tasks(path)
+        marketplaces.append(result)
+        for plugin_dir, entry in found:
+            if plugin_dir not in seen_dirs:
+                seen_dirs.add(plugin_dir)
+                tasks.append((plugin_dir, entry))
+    for plugin_dir in args.plugin:
+        plugin_dir = os.path.normpath(plugin_dir)
+        if plugin_dir not in seen_dirs:
+            seen_dirs.add(plugin_dir)
+            tasks.append((plugin_dir, None))
+
+    # Worker startup costs a few ms each, so tiny batches stay in-process.
+    if args.jobs > 1 and len(tasks) > 1:
+        with ProcessPoolExecutor(max_workers=min(args.jobs, len(tasks))) as pool:
+            plugins = list(pool.map(validate_plugin, tasks, chunksize=max(1, len(tasks) // (args.jobs * 4))))
+    else:
+        plugins = [validate_plugin(task) for task in tasks]
+    settings = []
+    for path in args.settings:
+        path, report = check_settings(path)
+        settings.append({"path": path, "errors": report.errors, "warnings": report.warnings})
+
+    sections = marketplaces + plugins + settings
+    errors = sum(len(s["errors"]) for s in sections)
+    warnings = sum(len(s["warnings"]) for s in sections)
+    report = {
+        "summary": {
+            "plugins": len(plugins),
+            "files": sum(p["files"] for p in plugins) + len(marketplaces) + len(settings),
+            "errors": errors,
+            "warnings": warnings,
+            "plugins_with_errors": sum(1 for p in plugins if p["errors"]),
+            "elapsed_ms": round((time.perf_counter() - start) * 1000, 1),
+        },
+        "marketplaces": marketplaces,
+        "plugins": sorted(plugins, key=lambda p: p["name"]),
+        "settings": settings,
+    }
+    text = json.dumps(report, indent=2, ensure_ascii=False) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    print(f"validate-plugins: {len(plugins)} plugin(s), {errors} error(s), {warnings} warning(s)",
+          file=sys.stderr)
+    return 1 if errors or (args.strict and warnings) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
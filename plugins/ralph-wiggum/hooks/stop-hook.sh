@@ -9,6 +9,30 @@ set -euo pipefail
 # Read hook input from stdin (advanced stop hook API)
 HOOK_INPUT=$(cat)
 
+# Hook timing row for the log every bundled plugin shares (CLAUDE_HOOK_TIMINGS=1,
+# schema in plugins/README.md). Written from an EXIT trap so every exit path
+# reports. Bash startup happens before EPOCHREALTIME is first read, so only
+# eval time is measured; EPOCHREALTIME needs bash 5, older shells skip the row.
+TIMING_T0=${EPOCHREALTIME:-}
+TRANSCRIPT_BYTES=0
+OUTCOME=idle
+emit_timing() {
+  [[ "${CLAUDE_HOOK_TIMINGS:-0}" == "1" && -n "$TIMING_T0" ]] || return 0
+  local log=${CLAUDE_HOOK_TIMINGS_LOG:-$HOME/.claude/hook-timings.jsonl}
+  local now=${EPOCHREALTIME//,/.} t0=${TIMING_T0//,/.} us session stdin_bytes
+  us=$(( ${now/./} - ${t0/./} ))
+  session=$(jq -c '.session_id // ""' <<< "$HOOK_INPUT" 2>/dev/null) || session='""'
+  stdin_bytes=$(LC_ALL=C; printf '%s' "${#HOOK_INPUT}")
+  if [[ -f "$log" ]] && [[ $(wc -c < "$log") -gt 4194304 ]]; then
+    mv -f "$log" "$log.1" 2>/dev/null || true
+  fi
+  printf '{"ts":%s,"pid":%d,"plugin":"ralph-wiggum","hook":"stop-hook","event":"Stop","tool":"","session":%s,"stdin_bytes":%d,"transcript_bytes":%d,"eval_ms":%d.%02d,"wall_ms":%d.%02d,"outcome":"%s"}\n' \
+    "${now%???}" "$$" "${session:-\"\"}" "$stdin_bytes" "$TRANSCRIPT_BYTES" \
+    $((us / 1000)) $((us % 1000 / 10)) $((us / 1000)) $((us % 1000 / 10)) "$OUTCOME" \
+    >> "$log" 2>/dev/null || true
+}
+trap emit_timing EXIT
+
 # Check if ralph-loop is active
 RALPH_STATE_FILE=".claude/ralph-loop.local.md"
 
@@ -16,13 +40,45 @@ if [[ ! -f "$RALPH_STATE_FILE" ]]; then
   # No active loop - allow exit
   exit 0
 fi
+OUTCOME=stopped
 
-# Parse markdown frontmatter (YAML between ---) and extract values
-FRONTMATTER=$(sed -n '/^---$/,/^---$/{ /^---$/d; p; }' "$RALPH_STATE_FILE")
-ITERATION=$(echo "$FRONTMATTER" | grep '^iteration:' | sed 's/iteration: *//')
-MAX_ITERATIONS=$(echo "$FRONTMATTER" | grep '^max_iterations:' | sed 's/max_iterations: *//')
-# Extract completion_promise and strip surrounding quotes if present
-COMPLETION_PROMISE=$(echo "$FRONTMATTER" | grep '^completion_promise:' | sed 's/completion_promise: *//' | sed 's/^"\(.*\)"$/\1/')
+# Parse the state file with bash builtins only: this runs on every Stop of
+# a loop that can go for hundreds of iterations, so no sed/grep chain.
+# STATE_LINES keeps the file so the iteration update below can rewrite it.
+# A read loop rather than mapfile, which needs bash 4 (macOS ships 3.2).
+STATE_LINES=()
+while IFS= read -r line || [[ -n "$line" ]]; do
+  STATE_LINES+=("$line")
+done < "$RALPH_STATE_FILE"
+ITERATION=""
+MAX_ITERATIONS=""
+COMPLETION_PROMISE=""
+PROMPT_START=${#STATE_LINES[@]}
+FENCES=0
+for i in "${!STATE_LINES[@]}"; do
+  line=${STATE_LINES[$i]}
+  if [[ "$line" == "---" ]]; then
+    FENCES=$((FENCES + 1))
+    if [[ $FENCES -eq 2 ]]; then
+      PROMPT_START=$((i + 1))
+      break
+    fi
+    continue
+  fi
+  [[ $FENCES -eq 1 ]] || continue
+  case "$line" in
+    iteration:*) ITERATION=${line#iteration:}; ITERATION=${ITERATION// /} ;;
+    max_iterations:*) MAX_ITERATIONS=${line#max_iterations:}; MAX_ITERATIONS=${MAX_ITERATIONS// /} ;;
+    completion_promise:*)
+      COMPLETION_PROMISE=${line#completion_promise:}
+      COMPLETION_PROMISE=${COMPLETION_PROMISE#"${COMPLETION_PROMISE%%[! ]*}"}
+      # Strip surrounding quotes if present
+      if [[ "$COMPLETION_PROMISE" =~ ^\"(.*)\"$ ]]; then
+        COMPLETION_PROMISE=${BASH_REMATCH[1]}
+      fi
+      ;;
+  esac
+done
 
 # Validate numeric fields before arithmetic operations
 if [[ ! "$ITERATION" =~ ^[0-9]+$ ]]; then
@@ -50,6 +106,7 @@ fi
 # Check if max iterations reached
 if [[ $MAX_ITERATIONS -gt 0 ]] && [[ $ITERATION -ge $MAX_ITERATIONS ]]; then
   echo "🛑 Ralph loop: Max iterations ($MAX_ITERATIONS) reached."
+  OUTCOME=max_iterations
   rm "$RALPH_STATE_FILE"
   exit 0
 fi
@@ -66,9 +123,32 @@ if [[ ! -f "$TRANSCRIPT_PATH" ]]; then
   exit 0
 fi
 
+# Set LAST_LINE to the last assistant record of a JSONL transcript (and
+# TRANSCRIPT_BYTES to how much of it was read).
+# Transcripts of long loops grow to tens of MB, so rather than grepping the
+# whole file every iteration, look at a window at the end and widen it
+# (x4) only when no assistant record is in it. `tail -c` seeks on regular
+# files, so the usual cost is one 64 KB read however long the loop has run.
+# The window's first line may be cut mid-record, so it is dropped.
+last_assistant_line() {
+  local path=$1 size window=65536
+  size=$(wc -c < "$path")
+  while [[ $window -lt $size ]]; do
+    TRANSCRIPT_BYTES=$((TRANSCRIPT_BYTES + window))
+    LAST_LINE=$(tail -c "$window" "$path" | tail -n +2 | grep -F '"role":"assistant"' | tail -n 1 || true)
+    if [[ -n "$LAST_LINE" ]]; then
+      return 0
+    fi
+    window=$((window * 4))
+  done
+  TRANSCRIPT_BYTES=$((TRANSCRIPT_BYTES + size))
+  LAST_LINE=$(grep -F '"role":"assistant"' "$path" | tail -n 1 || true)
+}
+
 # Read last assistant message from transcript (JSONL format - one JSON per line)
-# First check if there are any assistant messages
-if ! grep -q '"role":"assistant"' "$TRANSCRIPT_PATH"; then
+LAST_LINE=""
+last_assistant_line "$TRANSCRIPT_PATH"
+if [[ -z "$LAST_LINE" ]]; then
   echo "⚠️  Ralph loop: No assistant messages found in transcript" >&2
   echo "   Transcript: $TRANSCRIPT_PATH" >&2
   echo "   This is unusual and may indicate a transcript format issue" >&2
@@ -77,25 +157,13 @@ if ! grep -q '"role":"assistant"' "$TRANSCRIPT_PATH"; then
   exit 0
 fi
 
-# Extract last assistant message with explicit error handling
-LAST_LINE=$(grep '"role":"assistant"' "$TRANSCRIPT_PATH" | tail -1)
-if [[ -z "$LAST_LINE" ]]; then
-  echo "⚠️  Ralph loop: Failed to extract last assistant message" >&2
-  echo "   Ralph loop is stopping." >&2
-  rm "$RALPH_STATE_FILE"
-  exit 0
-fi
-
 # Parse JSON with error handling
-LAST_OUTPUT=$(echo "$LAST_LINE" | jq -r '
+if ! LAST_OUTPUT=$(jq -r '
   .message.content |
   map(select(.type == "text")) |
   map(.text) |
   join("\n")
-' 2>&1)
-
-# Check if jq succeeded
-if [[ $? -ne 0 ]]; then
+' <<< "$LAST_LINE" 2>&1); then
   echo "⚠️  Ralph loop: Failed to parse assistant message JSON" >&2
   echo "   Error: $LAST_OUTPUT" >&2
   echo "   This may indicate a transcript format issue" >&2
@@ -122,6 +190,7 @@ if [[ "$COMPLETION_PROMISE" != "null" ]] && [[ -n "$COMPLETION_PROMISE" ]]; then
   # == in [[ ]] does glob pattern matching which breaks with *, ?, [ characters
   if [[ -n "$PROMISE_TEXT" ]] && [[ "$PROMISE_TEXT" = "$COMPLETION_PROMISE" ]]; then
     echo "✅ Ralph loop: Detected <promise>$COMPLETION_PROMISE</promise>"
+    OUTCOME=complete
     rm "$RALPH_STATE_FILE"
     exit 0
   fi
@@ -130,10 +199,13 @@ fi
 # Not complete - continue loop with SAME PROMPT
 NEXT_ITERATION=$((ITERATION + 1))
 
-# Extract prompt (everything after the closing ---)
-# Skip first --- line, skip until second --- line, then print everything after
-# Use i>=2 instead of i==2 to handle --- in prompt content
-PROMPT_TEXT=$(awk '/^---$/{i++; next} i>=2' "$RALPH_STATE_FILE")
+# Extract prompt (everything after the closing ---, including any --- lines
+# in the prompt itself), without trailing newlines
+PROMPT_TEXT=""
+if [[ $PROMPT_START -lt ${#STATE_LINES[@]} ]]; then
+  printf -v PROMPT_TEXT '%s\n' "${STATE_LINES[@]:PROMPT_START}"
+  PROMPT_TEXT=${PROMPT_TEXT%"${PROMPT_TEXT##*[!$'\n']}"}
+fi
 
 if [[ -z "$PROMPT_TEXT" ]]; then
   echo "⚠️  Ralph loop: State file corrupted or incomplete" >&2
@@ -149,10 +221,16 @@ if [[ -z "$PROMPT_TEXT" ]]; then
   exit 0
 fi
 
-# Update iteration in frontmatter (portable across macOS and Linux)
-# Create temp file, then atomically replace
+# Update iteration in frontmatter from the lines already read
+# Write a temp file, then atomically replace
+for ((i = 0; i < PROMPT_START; i++)); do
+  if [[ "${STATE_LINES[$i]}" == iteration:* ]]; then
+    STATE_LINES[$i]="iteration: $NEXT_ITERATION"
+    break
+  fi
+done
 TEMP_FILE="${RALPH_STATE_FILE}.tmp.$$"
-sed "s/^iteration: .*/iteration: $NEXT_ITERATION/" "$RALPH_STATE_FILE" > "$TEMP_FILE"
+printf '%s\n' "${STATE_LINES[@]}" > "$TEMP_FILE"
 mv "$TEMP_FILE" "$RALPH_STATE_FILE"
 
 # Build system message with iteration count and completion promise info
@@ -162,6 +240,8 @@ else
   SYSTEM_MSG="🔄 Ralph iteration $NEXT_ITERATION | No completion promise set - loop runs infinitely"
 fi
 
+OUTCOME=continue
+
 # Output JSON to block the stop and feed prompt back
 # The "reason" field contains the prompt that will be sent back to Claude
 jq -n \
@@ -5,9 +5,11 @@ This module exists so that ``patterns``/``session_state``/``gitutil`` can use
 ``debug_log`` without importing ``security_reminder_hook`` (which would be a
 circular import). It must stay free of any other intra-plugin imports.
 """
+import contextlib
 import json
 import os
 import threading
+import time
 from datetime import datetime
 
 # Debug log file. Lives under the plugin state dir (default ~/.claude/security/)
@@ -111,7 +113,8 @@ def _record_usage(usage, model, cost_usd=None):
     `usage` dict (HTTP) or the SDK ResultMessage.usage dict — both use the
     same key names. `cost_usd` (SDK-provided) is preferred when present;
     otherwise computed from _PRICE_PER_MTOK keyed on the response model id
-    (longest-prefix match so `claude-sonnet-4-6-20251015` → sonnet row)."""
+    (longest-prefix match so `claude-sonnet-4-6-20251015` → sonnet row).
+    Tokens are also attributed to the calling thread's open review_stage()."""
     if not usage and cost_usd is None:
         return
     u = usage or {}
@@ -130,6 +133,10 @@ def _record_usage(usage, model, cost_usd=None):
                 pin, pout = v
                 break
         cost_usd = (i * pin + o * pout + cr * pin * 0.1 + cw * pin * 1.25) / 1_000_000
+    rec = getattr(_STAGE_TLS, "rec", None)
+    if rec is not None:
+        rec["tok_in"] = rec.get("tok_in", 0) + i + cr + cw
+        rec["tok_out"] = rec.get("tok_out", 0) + o
     with _USAGE_LOCK:
         _USAGE["in"] += i
         _USAGE["out"] += o
@@ -155,3 +162,177 @@ def _usage_metrics():
             "api_calls": _USAGE["n"],
         }
 
+
+# ──────────────────────────────────────────────────────────────────────────
+# Per-stage review timings. review_stage() wraps one unit of review work
+# (an LLM call, an SDK spawn, an agentic stage, a race fallback) and records
+# its wall time plus the tokens _record_usage attributes to it from the same
+# thread. emit_metrics appends the _stage_metrics() rollup into whatever key
+# budget is left and write_stage_log() keeps the full per-stage rows in
+# <state dir>/review_timings.jsonl so race delays and timeouts can be tuned
+# from data. SG_TIMINGS_LOG=0 disables the file.
+_STAGES = []
+_STAGES_LOCK = threading.Lock()
+_STAGE_TLS = threading.local()
+STAGE_LOG_FILE = os.path.join(_DEFAULT_STATE_DIR, "review_timings.jsonl")
+STAGE_LOG_MAX_BYTES = 1 * 1024 * 1024
+
+# (metric key, stages summed into it), in emit priority order.
+_STAGE_METRIC_KEYS = (
+    ("st_spawn_ms", ("sdk_spawn",)),
+    ("st_investigate_ms", ("investigate", "investigate2")),
+    ("st_refute_ms", ("refute",)),
+    ("st_fallback_ms", ("fallback",)),
+    ("st_llm_ms", ("llm_call",)),
+    ("st_cancel_ms", ("race_cancel",)),
+)
+
+
+def record_stage(name, ms, **fields):
+    """Record a stage that wasn't timed with review_stage()."""
+    rec = {"stage": name, "ms": int(ms), **fields}
+    with _STAGES_LOCK:
+        _STAGES.append(rec)
+
+
+@contextlib.contextmanager
+def review_stage(name, **fields):
+    """Time the enclosed block as one stage; yields its record so the block
+    can add fields (status, cancelled, ...)."""
+    rec = {"stage": name, **fields}
+    prev = getattr(_STAGE_TLS, "rec", None)
+    _STAGE_TLS.rec = rec
+    t0 = time.monotonic()
+    try:
+        yield rec
+    finally:
+        rec["ms"] = int((time.monotonic() - t0) * 1000)
+        _STAGE_TLS.rec = prev
+        with _STAGES_LOCK:
+            _STAGES.append(rec)
+
+
+def _stage_metrics():
+    """Stage rollup as metric keys: summed ms per _STAGE_METRIC_KEYS group,
+    omitting groups with no recorded stage."""
+    with _STAGES_LOCK:
+        stages = list(_STAGES)
+    out = {}
+    for key, names in _STAGE_METRIC_KEYS:
+        picked = [r["ms"] for r in stages if r.get("stage") in names]
+        if picked:
+            out[key] = sum(picked)
+    return out
+
+
+def write_stage_log(context):
+    """Append this invocation's stages (if any) with `context` (the emitted
+    metrics) as one JSON line. Rotated like the debug log."""
+    with _STAGES_LOCK:
+        stages = list(_STAGES)
+    if not stages or os.environ.get("SG_TIMINGS_LOG", "1") == "0":
+        return
+    try:
+        try:
+            if os.path.getsize(STAGE_LOG_FILE) > STAGE_LOG_MAX_BYTES:
+                os.replace(STAGE_LOG_FILE, STAGE_LOG_FILE + ".1")
+        except OSError:
+            pass
+        line = json.dumps({"ts": round(time.time(), 3), "pid": os.getpid(),
+                           "metrics": context, "stages": stages})
+        fd = os.open(STAGE_LOG_FILE, os.O_WRONLY | os.O_CREAT | os.O_APPEND, 0o600)
+        with os.fdopen(fd, "a") as f:
+            f.write(line + "\n")
+    except Exception:
+        pass
+
+
+# ──────────────────────────────────────────────────────────────────────────
+# Cross-plugin hook timings. With CLAUDE_HOOK_TIMINGS=1 every bundled plugin
+# appends one row per hook invocation to the same JSONL file
+# (CLAUDE_HOOK_TIMINGS_LOG, default ~/.claude/hook-timings.jsonl), so the
+# overhead of one tool call can be split across plugins. Rows share the
+# schema documented in plugins/README.md. Counters below are bumped from
+# wherever the work happens (pattern scans, caches) and folded into the
+# row at exit.
+HOOK_TIMINGS_ENABLED = os.environ.get("CLAUDE_HOOK_TIMINGS", "0") == "1"
+HOOK_TIMINGS_LOG = os.environ.get("CLAUDE_HOOK_TIMINGS_LOG") or os.path.expanduser(
+    "~/.claude/hook-timings.jsonl"
+)
+HOOK_TIMINGS_MAX_BYTES = 4 * 1024 * 1024
+_HOOK_COUNTS = {}
+_HOOK_COUNTS_LOCK = threading.Lock()
+
+
+def hook_count(key, n=1):
+    """Add n to a per-invocation timing counter (patterns, cache_hits, ...)."""
+    if not HOOK_TIMINGS_ENABLED or not n:
+        return
+    with _HOOK_COUNTS_LOCK:
+        _HOOK_COUNTS[key] = _HOOK_COUNTS.get(key, 0) + n
+
+
+def take_startup_ms():
+    """Wall ms since the launcher shim exported CLAUDE_HOOK_TIMING_T0 (its
+    EPOCHREALTIME), or None without one (bash < 5, or no shim). The variable
+    is consumed, so only the first timing row of a process claims the
+    startup (under merged dispatch one interpreter serves several plugins)
+    and child processes don't inherit a stale start."""
+    t0 = os.environ.pop("CLAUDE_HOOK_TIMING_T0", "")
+    try:
+        return max(0.0, time.time() * 1000 - float(t0.replace(",", ".")) * 1000)
+    except ValueError:
+        return None
+
+
+def start_hook_timing(input_data, raw_input):
+    """Start this invocation's timing row and return its finisher. The row
+    is also finished at interpreter exit, so every sys.exit path is covered;
+    a merged-dispatch entry calls the finisher itself when its own work is
+    done. startup_ms is take_startup_ms(), eval_ms the wall time after."""
+    if not HOOK_TIMINGS_ENABLED:
+        return lambda: None
+    import atexit
+
+    startup_ms = take_startup_ms()
+    t0 = time.perf_counter()
+    row = {
+        "plugin": "security-guidance",
+        "hook": "security_reminder_hook",
+        "event": input_data.get("hook_event_name", ""),
+        "tool": input_data.get("tool_name", ""),
+        "session": input_data.get("session_id", ""),
+        "tool_use_id": input_data.get("tool_use_id", ""),
+        "stdin_bytes": len(raw_input.encode("utf-8", "replace")),
+    }
+
+    def _finish():
+        if "eval_ms" in row:
+            return
+        eval_ms = (time.perf_counter() - t0) * 1000
+        row["eval_ms"] = round(eval_ms, 2)
+        if startup_ms is not None:
+            row["startup_ms"] = round(startup_ms, 2)
+        row["wall_ms"] = round((startup_ms or 0) + eval_ms, 2)
+        with _HOOK_COUNTS_LOCK:
+            row.update(_HOOK_COUNTS)
+        write_hook_timing(row)
+
+    atexit.register(_finish)
+    return _finish
+
+
+def write_hook_timing(row):
+    """Append one timing row (best-effort, rotated like the debug log)."""
+    try:
+        try:
+            if os.path.getsize(HOOK_TIMINGS_LOG) > HOOK_TIMINGS_MAX_BYTES:
+                os.replace(HOOK_TIMINGS_LOG, HOOK_TIMINGS_LOG + ".1")
+        except OSError:
+            pass
+        line = json.dumps({"ts": round(time.time(), 3), "pid": os.getpid(), **row})
+        fd = os.open(HOOK_TIMINGS_LOG, os.O_WRONLY | os.O_CREAT | os.O_APPEND, 0o600)
+        with os.fdopen(fd, "a") as f:
+            f.write(line + "\n")
+    except Exception:
+        pass
@@ -13,7 +13,8 @@ from _base import debug_log, _PV
 from gitutil import (
     GIT_CMD,
     _git_dir, _git_toplevel, _git_status_porcelain,
-    _git_rev_parse_head, _is_ancestor, _git_name_only,
+    _git_rev_parse_head, _is_ancestor, _git_name_only, _git_show_blob,
+    _diff_pathspec, _fsmonitor_daemon_configured, watchman_changed_since,
 )
 from session_state import with_locked_state
 
@@ -99,6 +100,7 @@ def consume_stop_state(session_id):
                 dict(state["untracked_at_baseline"])
                 if isinstance(state.get("untracked_at_baseline"), dict) else {}
             ),
+            "change_clock": state.get("change_clock"),
             "fire_count": 0 if expired else state.get("stop_hook_fire_count", 0),
             "fire_count_expired": expired and state.get("stop_hook_fire_count", 0) > 0,
             "previous_findings": [] if findings_expired else list(state.get("previous_findings", [])),
@@ -108,7 +110,7 @@ def consume_stop_state(session_id):
 
     return with_locked_state(session_id, _snap) or {
         "touched_paths": [], "baseline_sha": None, "head_at_capture": None,
-        "untracked_at_baseline": {},
+        "untracked_at_baseline": {}, "change_clock": None,
         "fire_count": 0, "fire_count_expired": False, "previous_findings": [],
     }
 
@@ -149,13 +151,7 @@ def get_baseline_file_content(session_id, file_path, cwd):
             rel_path = os.path.relpath(abs_path, cwd_abs)
         except ValueError:
             return None
-        result = subprocess.run(
-            [*GIT_CMD, "show", f"{baseline_sha}:{rel_path}"],
-            cwd=cwd, capture_output=True, text=True, timeout=5
-        )
-        if result.returncode == 0:
-            return result.stdout
-        return None
+        return _git_show_blob(cwd, f"{baseline_sha}:{rel_path}")
     except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
         return None
 
@@ -175,11 +171,8 @@ def capture_git_baseline(cwd):
     """
     try:
         # Check if HEAD exists (i.e., repo has at least one commit)
-        head_check = subprocess.run(
-            [*GIT_CMD, "rev-parse", "HEAD"],
-            cwd=cwd, capture_output=True, text=True, timeout=5
-        )
-        if head_check.returncode != 0:
+        head = _git_rev_parse_head(cwd)
+        if not head:
             # No commits yet — skip review rather than creating commits in the user's repo
             debug_log("No commits in repo, skipping baseline capture")
             return None
@@ -193,35 +186,14 @@ def capture_git_baseline(cwd):
             return sha
 
         # Working tree is clean — stash create returns empty. Use HEAD.
-        result = subprocess.run(
-            [*GIT_CMD, "rev-parse", "HEAD"],
-            cwd=cwd, capture_output=True, text=True, timeout=5
-        )
-        sha = result.stdout.strip()
-        return sha if sha else None
+        return head
     except (subprocess.TimeoutExpired, FileNotFoundError, OSError) as e:
         debug_log(f"Failed to capture git baseline: {e}")
         return None
 
 
-# ─── push-sweep reviewed-commit tracking ────────────────────────────────────
-#
-# Repo-local (not session-local) record of which commits the commit-review
-# hook has already reviewed, so the push-sweep can advance its diff base past
-# the contiguous reviewed prefix and skip entirely when everything pushed was
-# already covered. Lives under `.git/` (same precedent as CC's
-# `.git/claude-trailers`) so it survives across sessions and is per-clone.
-#
-# Format: one line per reviewed sha, append-only:
-#   <40-hex-sha>\t<unix-ts>\t<pv>\t<vulns_found>
-#
-# The trailing columns are observability only — load reads just the sha set.
-# GC keeps the last _REVIEWED_SHAS_CAP entries; the file is small (~64 bytes
-# per line) so even at the cap it's ~32KB.
-
-
 # =====================================================================
-# Reviewed-SHA log (commit/push dedup)
+# Reviewed-SHA store (commit/push dedup)
 # =====================================================================
 
 # ─── push-sweep reviewed-commit tracking ────────────────────────────────────
@@ -232,52 +204,190 @@ def capture_git_baseline(cwd):
 # already covered. Lives under `.git/` (same precedent as CC's
 # `.git/claude-trailers`) so it survives across sessions and is per-clone.
 #
-# Format: one line per reviewed sha, append-only:
-#   <40-hex-sha>\t<unix-ts>\t<pv>\t<vulns_found>
+# Store: a SQLite table keyed by sha (`.git/sg-reviewed-shas.db`), so a
+# lookup is a primary-key probe for just the shas in question and a record is
+# a single-row upsert — no read-modify-rewrite of the whole set under a lock
+# that every session in the clone contends on. Rows expire after
+# SG_REVIEWED_SHAS_TTL_DAYS (default 180) with a _REVIEWED_SHAS_CAP backstop,
+# so long-lived busy branches don't fall off the end and get re-reviewed.
+# Columns after sha are observability only.
 #
-# The trailing columns are observability only — load reads just the sha set.
-# GC keeps the last _REVIEWED_SHAS_CAP entries; the file is small (~64 bytes
-# per line) so even at the cap it's ~32KB.
+# The legacy text file (`.git/sg-reviewed-shas`, one
+# `<sha>\t<ts>\t<pv>\t<vulns_found>` line per commit, capped at 500) is
+# imported once when the database is created, and stays the store on a
+# Python without sqlite3.
+
+try:
+    import sqlite3
+except ImportError:  # Python built without _sqlite3
+    sqlite3 = None
+_DB_ERRORS = (sqlite3.Error, OSError) if sqlite3 is not None else (OSError,)
 
 _REVIEWED_SHAS_BASENAME = "sg-reviewed-shas"
-_REVIEWED_SHAS_CAP = 500
+_REVIEWED_SHAS_DB_BASENAME = "sg-reviewed-shas.db"
+_REVIEWED_SHAS_CAP = 50000
+_REVIEWED_SHAS_TEXT_CAP = 500
+REVIEWED_SHAS_TTL_SEC = int(os.environ.get("SG_REVIEWED_SHAS_TTL_DAYS", "180")) * 86400
+# The cap backstop needs an ordered scan; run it on ~1 in N records.
+_REVIEWED_SHAS_CAP_CHECK_EVERY = 64
+
+
+def _is_full_sha(sha):
+    return len(sha) == 40 and all(c in "0123456789abcdef" for c in sha)
+
 
 def _reviewed_shas_path(repo_root):
     gd = _git_dir(repo_root)
     return os.path.join(gd, _REVIEWED_SHAS_BASENAME) if gd else None
 
 
-def _load_reviewed_shas(repo_root):
-    """Set of full 40-hex shas previously reviewed in this clone."""
+def _reviewed_shas_db_path(repo_root):
+    gd = _git_dir(repo_root)
+    return os.path.join(gd, _REVIEWED_SHAS_DB_BASENAME) if gd else None
+
+
+def _open_reviewed_shas_db(repo_root):
+    """Open (creating and importing the legacy file on first use) the
+    reviewed-sha database, or None if unavailable."""
+    p = _reviewed_shas_db_path(repo_root)
+    if sqlite3 is None or not p:
+        return None
+    conn = sqlite3.connect(p, timeout=5.0, isolation_level=None)
+    try:
+        conn.execute("PRAGMA journal_mode=WAL")
+        conn.execute("PRAGMA synchronous=NORMAL")
+        if conn.execute("PRAGMA user_version").fetchone()[0] < 1:
+            conn.execute("BEGIN IMMEDIATE")
+            if conn.execute("PRAGMA user_version").fetchone()[0] < 1:
+                conn.execute(
+                    "CREATE TABLE IF NOT EXISTS reviewed ("
+                    "sha TEXT PRIMARY KEY, ts INTEGER NOT NULL, "
+                    "pv INTEGER NOT NULL, vulns INTEGER NOT NULL) WITHOUT ROWID"
+                )
+                conn.execute("CREATE INDEX IF NOT EXISTS reviewed_ts ON reviewed (ts)")
+                legacy = _read_reviewed_shas_text(repo_root)
+                conn.executemany(
+                    "INSERT OR IGNORE INTO reviewed (sha, ts, pv, vulns) VALUES (?, ?, ?, ?)",
+                    legacy,
+                )
+                if legacy:
+                    debug_log(f"Imported {len(legacy)} reviewed shas into {_REVIEWED_SHAS_DB_BASENAME}")
+                conn.execute("PRAGMA user_version = 1")
+            conn.execute("COMMIT")
+    except BaseException:
+        conn.close()
+        raise
+    return conn
+
+
+def _read_reviewed_shas_text(repo_root):
+    """[(sha, ts, pv, vulns)] from the legacy text file ([] if absent)."""
     p = _reviewed_shas_path(repo_root)
     if not p or not os.path.exists(p):
-        return set()
-    out = set()
+        return []
+    rows = []
     try:
         with open(p, "r") as f:
             for line in f:
-                sha = line.split("\t", 1)[0].strip()
-                if len(sha) == 40 and all(c in "0123456789abcdef" for c in sha):
-                    out.add(sha)
+                cols = line.rstrip("\n").split("\t")
+                sha = cols[0].strip()
+                if not _is_full_sha(sha):
+                    continue
+                try:
+                    ts, pv, vulns = (int(c) for c in (cols[1:4] + ["0", "0", "0"])[:3])
+                except ValueError:
+                    ts, pv, vulns = 0, 0, 0
+                rows.append((sha, ts, pv, vulns))
     except OSError:
         pass
-    return out
+    return rows
+
+
+def _load_reviewed_shas(repo_root, candidates=None):
+    """Set of full 40-hex shas previously reviewed in this clone.
+
+    candidates: the shas the caller is about to test membership of. With it,
+    only those rows are looked up (and returned); without it, every
+    reviewed sha is loaded.
+    """
+    if candidates is not None:
+        candidates = [s for s in dict.fromkeys(candidates) if _is_full_sha(s)]
+        if not candidates:
+            return set()
+    import time as _time
+    cutoff = int(_time.time()) - REVIEWED_SHAS_TTL_SEC
+    conn = None
+    try:
+        conn = _open_reviewed_shas_db(repo_root)
+        if conn is not None:
+            if candidates is None:
+                rows = conn.execute("SELECT sha FROM reviewed WHERE ts >= ?", (cutoff,))
+                return {r[0] for r in rows}
+            out = set()
+            # Chunked to stay under SQLite's bound-parameter limit.
+            for k in range(0, len(candidates), 500):
+                chunk = candidates[k:k + 500]
+                rows = conn.execute(
+                    f"SELECT sha FROM reviewed WHERE ts >= ? AND sha IN ({','.join('?' * len(chunk))})",
+                    (cutoff, *chunk),
+                )
+                out.update(r[0] for r in rows)
+            return out
+    except _DB_ERRORS as e:
+        debug_log(f"reviewed-shas lookup failed, reading text log: {e}")
+    finally:
+        if conn is not None:
+            conn.close()
+    shas = {row[0] for row in _read_reviewed_shas_text(repo_root)}
+    return shas if candidates is None else shas & set(candidates)
 
 
 def _append_reviewed_shas(repo_root, shas, vulns_found=0):
-    """Record that `shas` were reviewed. Best-effort; never raises.
+    """Record that `shas` were reviewed. Best-effort; never raises."""
+    if not shas or not _git_dir(repo_root):
+        return
+    import random as _random
+    import time as _time
+    ts = int(_time.time())
+    pv = _PV or 0
+    rows = [(s, ts, pv, int(vulns_found)) for s in shas]
+    conn = None
+    try:
+        conn = _open_reviewed_shas_db(repo_root)
+        if conn is not None:
+            conn.execute("BEGIN IMMEDIATE")
+            conn.executemany(
+                "INSERT OR REPLACE INTO reviewed (sha, ts, pv, vulns) VALUES (?, ?, ?, ?)",
+                rows,
+            )
+            conn.execute("DELETE FROM reviewed WHERE ts < ?", (ts - REVIEWED_SHAS_TTL_SEC,))
+            if _random.randrange(_REVIEWED_SHAS_CAP_CHECK_EVERY) == 0:
+                conn.execute(
+                    "DELETE FROM reviewed WHERE sha IN (SELECT sha FROM reviewed "
+                    "ORDER BY ts DESC LIMIT -1 OFFSET ?)",
+                    (_REVIEWED_SHAS_CAP,),
+                )
+            conn.execute("COMMIT")
+            return
+    except _DB_ERRORS as e:
+        debug_log(f"reviewed-shas record failed, using text log: {e}")
+    finally:
+        if conn is not None:
+            conn.close()
+    _append_reviewed_shas_text(repo_root, rows)
+
+
+def _append_reviewed_shas_text(repo_root, rows):
+    """Legacy text-log append (no sqlite3).
 
     Uses fcntl.flock for the read-gc-write; appends are O_APPEND-atomic but
     GC needs the lock so concurrent CC sessions in the same clone don't race
     each other's truncation.
     """
     p = _reviewed_shas_path(repo_root)
-    if not p or not shas:
+    if not p:
         return
-    import time as _time
-    ts = int(_time.time())
-    pv = _PV or 0
-    lines = [f"{s}\t{ts}\t{pv}\t{int(vulns_found)}\n" for s in shas]
+    lines = [f"{s}\t{ts}\t{pv}\t{v}\n" for s, ts, pv, v in rows]
     try:
         import fcntl
         with open(p, "a+") as f:
@@ -293,7 +403,7 @@ def _append_reviewed_shas(repo_root, shas, vulns_found=0):
                     if sha and sha not in seen:
                         seen.add(sha)
                         merged.append(ln if ln.endswith("\n") else ln + "\n")
-                merged = merged[:_REVIEWED_SHAS_CAP][::-1]
+                merged = merged[:_REVIEWED_SHAS_TEXT_CAP][::-1]
                 f.seek(0)
                 f.truncate()
                 f.writelines(merged)
@@ -315,6 +425,26 @@ def _append_reviewed_shas(repo_root, shas, vulns_found=0):
 
 UNTRACKED_BASELINE_CAP = 2000
 
+# Review-set strategy (SG_REVIEW_SET_MODE):
+#   auto    — whole-repo status, unless a change source makes a narrower
+#             scan exact: the builtin fsmonitor daemon (whole-repo status stays,
+#             but git answers it from the daemon), or a watchman clock captured
+#             at UPS (status/diff restricted to touched paths + everything
+#             watchman saw change, Bash edits included).
+#   touched — restrict to touched paths (+ this turn's commits) even with no
+#             change source; cheapest, but misses files only Bash changed.
+#   full    — always whole-repo status (the pre-incremental behaviour).
+REVIEW_SET_MODE = os.environ.get("SG_REVIEW_SET_MODE", "auto").strip().lower()
+# Above this many candidate paths the restricted scan stops paying for
+# itself (and a build just rewrote a directory); fall back to whole-repo.
+INCREMENTAL_MAX_PATHS = int(os.environ.get("SG_INCREMENTAL_MAX_PATHS", "2000"))
+
+# review_set_mode metric values.
+REVIEW_SET_FULL = 0
+REVIEW_SET_FSMONITOR = 1
+REVIEW_SET_WATCHMAN = 2
+REVIEW_SET_TOUCHED = 3
+
 
 def _list_untracked(cwd):
     """Repo-root-relative untracked (and not-ignored) path → mtime_ns, or {}
@@ -350,7 +480,29 @@ def _list_untracked(cwd):
         debug_log(f"_list_untracked error: {e}")
         return {}
 
-def compute_v2_review_set(cwd, baseline_sha, head_at_capture, untracked_at_baseline=None):
+def _incremental_candidates(repo, touched_paths, change_clock):
+    """(repo-relative candidate paths or None for whole-repo, fsmonitor flag,
+    review_set_mode metric) per REVIEW_SET_MODE."""
+    if REVIEW_SET_MODE == "full":
+        return None, False, REVIEW_SET_FULL
+    if REVIEW_SET_MODE != "touched" and _fsmonitor_daemon_configured(repo):
+        return None, True, REVIEW_SET_FSMONITOR
+    changed = watchman_changed_since(change_clock) if change_clock else None
+    if changed is not None:
+        mode = REVIEW_SET_WATCHMAN
+    elif REVIEW_SET_MODE == "touched":
+        changed, mode = set(), REVIEW_SET_TOUCHED
+    else:
+        return None, False, REVIEW_SET_FULL
+    candidates = set(_diff_pathspec(repo, touched_paths or [])[1:]) | changed
+    if len(candidates) > INCREMENTAL_MAX_PATHS:
+        debug_log(f"review set: {len(candidates)} candidate paths > {INCREMENTAL_MAX_PATHS}, scanning whole repo")
+        return None, False, REVIEW_SET_FULL
+    return candidates, False, mode
+
+
+def compute_v2_review_set(cwd, baseline_sha, head_at_capture, untracked_at_baseline=None,
+                          touched_paths=None, change_clock=None):
     """v2 diff strategy: derive the review set from git state alone.
 
     review_set = (files dirty vs current HEAD, plus files committed this turn
@@ -378,12 +530,30 @@ def compute_v2_review_set(cwd, baseline_sha, head_at_capture, untracked_at_basel
 
     Also returns the untracked subset of review_set so get_git_diff can do
     a targeted `add -N -- <files>` instead of a whole-tree scan.
+
+    touched_paths / change_clock (the Edit/Write paths recorded this turn and
+    the UPS watchman clock) let the status and changed-since scans be
+    restricted to what the turn could have changed — see REVIEW_SET_MODE.
+    The result is the same set a whole-repo scan would give; only the cost
+    differs (it scales with the edit instead of the repo).
     """
     repo = _git_toplevel(cwd) or cwd
     if not isinstance(untracked_at_baseline, dict):
         untracked_at_baseline = {}
 
-    tracked_dirty, untracked = _git_status_porcelain(repo)
+    candidates, fsmonitor, set_mode = _incremental_candidates(repo, touched_paths, change_clock)
+
+    diff_base = "HEAD"
+    committed = set()
+    current_head = _git_rev_parse_head(repo)
+    if (head_at_capture and current_head and head_at_capture != current_head
+            and _is_ancestor(repo, head_at_capture, current_head)):
+        committed = _git_name_only(repo, f"{head_at_capture}..HEAD") or set()
+        diff_base = head_at_capture
+    if candidates is not None:
+        candidates |= committed
+
+    tracked_dirty, untracked = _git_status_porcelain(repo, paths=candidates, fsmonitor=fsmonitor)
     if tracked_dirty is None:
         return [], "HEAD", repo, [], {"dirty_now_count": -1, "changed_since_count": -1, "review_set_count": 0}
 
@@ -398,14 +568,7 @@ def compute_v2_review_set(cwd, baseline_sha, head_at_capture, untracked_at_basel
 
     preexisting_unchanged = {p for p in untracked if _unchanged_since_baseline(p)}
     new_untracked = untracked - preexisting_unchanged
-    dirty_now = tracked_dirty | new_untracked
-
-    diff_base = "HEAD"
-    current_head = _git_rev_parse_head(repo)
-    if (head_at_capture and current_head and head_at_capture != current_head
-            and _is_ancestor(repo, head_at_capture, current_head)):
-        dirty_now |= _git_name_only(repo, f"{head_at_capture}..HEAD") or set()
-        diff_base = head_at_capture
+    dirty_now = tracked_dirty | new_untracked | committed
 
     # changed_since: tracked files vs the stash baseline (no temp index — the
     # stash never contained untracked files anyway), then union with
@@ -415,7 +578,7 @@ def compute_v2_review_set(cwd, baseline_sha, head_at_capture, untracked_at_basel
     # lists them as "only in worktree" without that, and we have the explicit
     # set from status regardless.
     if baseline_sha:
-        changed_since = _git_name_only(repo, baseline_sha)
+        changed_since = _git_name_only(repo, baseline_sha, paths=candidates, fsmonitor=fsmonitor)
         if changed_since is not None:
             changed_since |= new_untracked
     else:
@@ -435,4 +598,6 @@ def compute_v2_review_set(cwd, baseline_sha, head_at_capture, untracked_at_basel
     # Only emit when nonzero to stay under the 10-key telemetry cap.
     if preexisting_unchanged:
         metrics["preexisting_untracked_excluded"] = len(preexisting_unchanged)
+    if set_mode != REVIEW_SET_FULL:
+        metrics["review_set_mode"] = set_mode
     return review_paths, diff_base, repo, untracked_in_review, metrics
@@ -0,0 +1,76 @@
+#!/usr/bin/env bash
+#
+# dispatch.sh — merged hook dispatch, leader side (protocol 2).
+#
+# The protocol is documented in plugins/README.md under "Merged Hook
+# Dispatch". This shim and hook_dispatch.py exist only in security-guidance;
+# other plugins join with a follower shim (hookify's dispatch-follower.sh)
+# that registers and never starts the dispatcher itself. So the dispatcher
+# always runs under this plugin's runner (sg-python.sh's interpreter, under
+# this hook's timeout), whichever shim Claude Code happened to start first.
+#
+# Usage (as a hooks.json command):
+#   bash ${CLAUDE_PLUGIN_ROOT}/hooks/dispatch.sh <plugin> <entry.py> <runner...>
+#
+# <runner...> is how the plugin normally starts Python (bash sg-python.sh);
+# "<runner...> hooks/<entry.py>" is its standalone hook.
+#
+# The shim registers itself, claims the call's leader file and execs
+# hook_dispatch.py, which evaluates every registered plugin in that one
+# interpreter. A follower that registers early enough is picked up by it;
+# one that came first, or after the leader's last scan, runs itself. The
+# only fork in the common path is the cat that reads the hook input.
+#
+# CLAUDE_HOOK_DISPATCH=0 runs every plugin's entry directly, as before.
+#
+# No set -e: a failed mkdir or create below means "run this plugin
+# directly", never "drop its hook".
+
+# Hook timings' startup_ms runs from here (EPOCHREALTIME needs bash 5).
+if [[ "${CLAUDE_HOOK_TIMINGS:-0}" == "1" && -z "${CLAUDE_HOOK_TIMING_T0:-}" && -n "${EPOCHREALTIME:-}" ]]; then
+  export CLAUDE_HOOK_TIMING_T0=$EPOCHREALTIME
+fi
+
+PLUGIN=$1
+ENTRY=$2
+shift 2
+HOOKS_DIR=${BASH_SOURCE[0]%/*}
+ROOT=${HOOKS_DIR%/*}
+
+INPUT=$(cat)
+
+run_direct() {
+  CLAUDE_PLUGIN_ROOT=$ROOT exec "$@" "$HOOKS_DIR/$ENTRY" <<< "$INPUT"
+}
+
+# No tool_use_id means nothing to rendezvous on.
+if [[ "${CLAUDE_HOOK_DISPATCH:-1}" == "0" \
+      || ! $INPUT =~ \"tool_use_id\"[[:space:]]*:[[:space:]]*\"([A-Za-z0-9_-]+)\" ]]; then
+  run_direct "$@"
+fi
+CALL=${BASH_REMATCH[1]}
+
+DIR=${TMPDIR:-/tmp}
+DIR=${DIR%/}/claude-hook-dispatch-$UID
+[[ -d "$DIR" ]] || mkdir -m 700 "$DIR" 2>/dev/null
+# Only a private directory we own; anything else and plugins run separately.
+if [[ -L "$DIR" || ! -d "$DIR" || ! -O "$DIR" ]]; then
+  run_direct "$@"
+fi
+
+# noclobber makes each redirect below an O_EXCL create.
+set -C
+printf -v LINE '%s\t' 2 "$ROOT" "$ENTRY" "$@"
+# The same plugin hooked twice on one call: keep them independent.
+{ printf '%s\n' "${LINE%$'\t'}" > "$DIR/$CALL.$PLUGIN"; } 2>/dev/null || run_direct "$@"
+
+if { : > "$DIR/$CALL.leader"; } 2>/dev/null; then
+  exec "$@" "$HOOKS_DIR/hook_dispatch.py" "$DIR" "$CALL" "$PLUGIN" <<< "$INPUT"
+fi
+
+# Only this plugin leads, so a taken leader file is left over from an
+# earlier run for the same call; run ourselves unless that leader claimed us.
+if { : > "$DIR/$CALL.$PLUGIN.claim"; } 2>/dev/null; then
+  run_direct "$@"
+fi
+exit 0
@@ -1,7 +1,12 @@
 #!/usr/bin/env python3
-"""SessionStart bootstrap: ensure claude_agent_sdk is importable for the
+"""Deferred bootstrap: ensure claude_agent_sdk is importable for the
 agentic commit reviewer.
 
+security_reminder_hook.py spawns this detached on the first UserPromptSubmit
+or PostToolUse whose cached status (agent-sdk-status.json, below) is missing
+or stale, so session start never waits on it and sessions that never reach
+a hook never pay for it.
+
 If claude_agent_sdk already imports in the current python3, this is a no-op.
 Otherwise it creates a venv at ~/.claude/security/agent-sdk-venv and installs
 the SDK there. security_reminder_hook.py prepends that venv's site-packages to
@@ -12,16 +17,24 @@ The venv lives under ~/.claude/security/ (same dir the plugin already uses
 for per-session state) so it persists across plugin updates — rebuilding
 on every update is 30-60s of wasted work for a package that changes far
 less often than the plugin does.
+
+The result is cached in ~/.claude/security/agent-sdk-status.json keyed by
+_plugin_version_int() and the interpreter path, so the hook skips both the
+spawn and the ~10ms find_spec probe once the SDK is known to import. A
+plugin update, a different python3, or STATUS_TTL_S elapsing re-runs the
+check.
 """
 from __future__ import annotations
 
-import importlib.util
 import json
 import os
 import subprocess
 import sys
 import time
-from pathlib import Path
+
+# security_reminder_hook imports this module on every hook for the status
+# constants below, so pathlib and importlib.util (~4ms) are imported where
+# the bootstrap itself uses them.
 
 # Outcome codes for the sdk_bootstrap metric. Values are stable for telemetry.
 NOOP_SYSTEM = 0      # claude_agent_sdk already importable in system python
@@ -29,14 +42,24 @@ NOOP_VENV = 1        # venv already built and SDK imports from it
 BUILT = 2            # venv created + SDK pip-installed this run
 BUILD_FAILED = 3     # venv create or pip install raised/timed out
 SKIP_WIN32 = 4       # Windows; consumer glob doesn't handle Lib/ layout
-SKIP_SENTINEL = 5    # another SessionStart is currently building
+SKIP_SENTINEL = 5    # another bootstrap is currently building
+
+# Outcomes that settle the question for this plugin version + interpreter;
+# the hook stops spawning the bootstrap while a status with one of these is
+# fresh. Failures and sentinel skips are retried (throttled by the hook).
+SETTLED = (NOOP_SYSTEM, NOOP_VENV, BUILT, SKIP_WIN32)
+# A settled status is re-verified after this long, so an uninstalled system
+# SDK or a deleted venv is noticed within a day.
+STATUS_TTL_S = 24 * 3600
+STATUS_FILE = "agent-sdk-status.json"
 
 
 def _sdk_on_syspath() -> bool:
     # find_spec is ~10ms; actually importing the SDK pulls in
     # transitive deps and costs ~800ms — too heavy for a
-    # per-SessionStart no-op check that most sessions hit.
+    # no-op check that most runs hit.
     try:
+        import importlib.util
         return importlib.util.find_spec("claude_agent_sdk") is not None
     except Exception:
         return False
@@ -46,6 +69,7 @@ def _plugin_version_int() -> int:
     # Same encoding as security_reminder_hook._read_plugin_version_int so
     # metrics rows from both hooks join on pv.
     try:
+        from pathlib import Path
         p = Path(__file__).parent.parent / ".claude-plugin" / "plugin.json"
         v = json.loads(p.read_text())["version"]
         major, minor, patch = (int(x) for x in v.split(".")[:3])
@@ -54,6 +78,54 @@ def _plugin_version_int() -> int:
         return 0
 
 
+def _state_dir() -> Path:
+    from pathlib import Path
+    return Path(
+        os.environ.get("SECURITY_WARNINGS_STATE_DIR")
+        or os.path.expanduser("~/.claude/security")
+    )
+
+
+def _write_status(outcome: int, ms: int, err_phase: str, err_kind: str) -> None:
+    """Record the outcome for security_reminder_hook._sdk_status_settled.
+
+    Written via rename so a concurrent reader never sees a partial file.
+    Best-effort: an unwritable state dir only costs a re-check next time.
+    """
+    status = {
+        "pv": _plugin_version_int(),
+        "python": sys.executable,
+        "outcome": outcome,
+        "ts": int(time.time()),
+        "ms": ms,
+    }
+    if err_kind:
+        status["phase"] = err_phase or "pre"
+        status["err"] = err_kind[:96]
+    try:
+        state_dir = _state_dir()
+        state_dir.mkdir(parents=True, exist_ok=True)
+        tmp = state_dir / f"{STATUS_FILE}.{os.getpid()}.tmp"
+        tmp.write_text(json.dumps(status))
+        os.replace(tmp, state_dir / STATUS_FILE)
+    except OSError:
+        pass
+
+
+def _precompile_hooks() -> None:
+    """Byte-compile the hook modules so the first Edit of the session doesn't
+    pay source compilation (~30ms across the hook's imports). compileall
+    skips up-to-date .pyc files, and it writes them even under
+    PYTHONDONTWRITEBYTECODE, which otherwise leaves every hook compiling
+    from source. Best-effort: a read-only plugin dir just stays uncompiled."""
+    try:
+        import compileall
+        from pathlib import Path
+        compileall.compile_dir(str(Path(__file__).parent), maxlevels=0, quiet=2)
+    except Exception:
+        pass
+
+
 def main() -> tuple[int, str, str]:
     """Run the bootstrap. Returns (outcome, err_phase, err_kind).
 
@@ -70,14 +142,11 @@ def main() -> tuple[int, str, str]:
     if _sdk_on_syspath():
         return NOOP_SYSTEM, "", ""
 
-    state_dir = Path(
-        os.environ.get("SECURITY_WARNINGS_STATE_DIR")
-        or os.path.expanduser("~/.claude/security")
-    )
+    state_dir = _state_dir()
     venv = state_dir / "agent-sdk-venv"
     venv_py = venv / "bin" / "python"
 
-    # Another SessionStart (concurrent CC instance, same plugin) may already
+    # Another bootstrap (concurrent CC instance, same plugin) may already
     # be building. The sentinel lives NEXT TO the venv, not inside it —
     # `python -m venv --clear` wipes the target dir's contents, so an
     # in-venv sentinel would be deleted the instant we create the venv.
@@ -108,7 +177,7 @@ def main() -> tuple[int, str, str]:
     we_own_sentinel = False
     try:
         state_dir.mkdir(parents=True, exist_ok=True)
-        # O_EXCL makes the sentinel an atomic lock — if two SessionStarts
+        # O_EXCL makes the sentinel an atomic lock — if two bootstraps
         # race past the exists() check above, only one creates it.
         try:
             os.close(os.open(sentinel, os.O_CREAT | os.O_EXCL | os.O_WRONLY))
@@ -180,36 +249,35 @@ def main() -> tuple[int, str, str]:
         # Only remove the sentinel if THIS process created it. The
         # FileExistsError path above means another process owns the lock;
         # unconditionally unlinking here would delete its sentinel and let
-        # a third concurrent SessionStart `venv --clear` over the in-flight
+        # a third concurrent bootstrap `venv --clear` over the in-flight
         # build.
         if we_own_sentinel:
             sentinel.unlink(missing_ok=True)
 
 
 if __name__ == "__main__":
-    # Tell the harness this is async — venv create + pip install can take
-    # 30-60s on a cold cache, well past the default sync hook timeout.
-    # SessionStart runs before the user's first prompt; doing this in the
-    # background means the first commit-review of the session usually finds
-    # the venv ready.
-    print(json.dumps({"async": True, "asyncTimeout": 180000}), flush=True)
+    # Runs detached (stdout is /dev/null), so venv create + pip install can
+    # take their 30-60s on a cold cache without holding up any hook. The
+    # first prompt of a fresh install triggers it, so the first
+    # commit-review usually finds the venv ready.
     t0 = time.perf_counter()
+    _precompile_hooks()
     try:
         outcome, err_phase, err_kind = main()
     except Exception as exc:
         outcome, err_phase, err_kind = (
             BUILD_FAILED, "main", f"exc:{type(exc).__name__}"
         )
-    # CC's async-hook registry scans stdout line-by-line after process exit
-    # and takes the FIRST non-{"async":...} JSON line as the hook response;
-    # its `metrics` key is forwarded to the hook metrics event on the
-    # next attachments pass. Must be a single line — the registry splits on
-    # \n and json-parses each independently. Values must be bool|number OR
-    # short strings (CC accepts string metric values if they're not
-    # null). Stay inside the 10-key emit cap.
+    ms = round((time.perf_counter() - t0) * 1000)
+    if outcome != SKIP_SENTINEL:
+        # The sentinel holder writes its own status when it finishes.
+        _write_status(outcome, ms, err_phase, err_kind)
+    # The same one-line metrics payload the SessionStart hook used to emit,
+    # for manual runs. Values must be bool|number OR short strings; stay
+    # inside the 10-key emit cap.
     metrics: dict[str, object] = {
         "sdk_bootstrap": outcome,
-        "sdk_bootstrap_ms": round((time.perf_counter() - t0) * 1000),
+        "sdk_bootstrap_ms": ms,
     }
     if err_kind:
         # Truncate defensively; categorized values are <40 chars but the
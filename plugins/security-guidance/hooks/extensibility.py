@@ -27,18 +27,34 @@ Trust model:
   - Custom pattern reminders go into the same provenance-tagged block as the
     built-in ones. Reminder length is capped.
   - Custom regexes are validated at load for catastrophic-backtracking
-    structure and skipped (with a debug log) if they look ReDoS-prone.
+    structure and skipped (with a debug log) if they look ReDoS-prone. Those
+    that pass are then timed against synthetic worst-case inputs built from
+    their own literals and skipped if a probe runs over PATTERN_BUDGET_MS
+    with its time growing faster than polynomially in the input length
+    (see _exceeds_budget), so a backtracking regex is dropped at load
+    instead of stalling every edit. Probing shares PATTERN_PROBE_TOTAL_MS
+    per load; patterns it doesn't reach are probed on a later load.
+  - Validated patterns are cached in ``<state dir>/user-patterns-cache.json``,
+    keyed by file path, mtime, size and content hash, so an unchanged config
+    costs one stat per path rather than a read, parse and re-timing. Probe
+    verdicts are cached with the spec; a rejection is retried once (it may
+    have been a loaded machine) and then stays rejected until the file
+    changes.
   - Built-in patterns cannot be disabled. ``ENABLE_PATTERN_RULES=0`` disables
     all pattern checks; there is no per-rule kill switch in v1.
 """
 
 import fnmatch
+import hashlib
 import json
+import math
 import os
 import re
+import time
 from typing import Any, Dict, List, Optional, Tuple
 
-from _base import debug_log
+from _base import debug_log, hook_count
+from patterns import _sre_parse
 
 # ── caps ─────────────────────────────────────────────────────────────────────
 
@@ -46,6 +62,12 @@ GUIDANCE_MAX_BYTES = 8 * 1024
 PATTERN_MAX_RULES = 50
 PATTERN_REMINDER_MAX_BYTES = 1024
 
+# Probe time past which the growth rate is judged; see _exceeds_budget.
+PATTERN_BUDGET_MS = float(os.environ.get("SG_PATTERN_BUDGET_MS", "20"))
+# Probe time one load may spend before leaving the remaining unprobed
+# patterns to a later load; see _load_user_patterns.
+PATTERN_PROBE_TOTAL_MS = float(os.environ.get("SG_PATTERN_PROBE_TOTAL_MS", "250"))
+
 GUIDANCE_BASENAME = "claude-security-guidance.md"
 PATTERNS_BASENAMES = ("security-patterns.yaml", "security-patterns.yml", "security-patterns.json")
 
@@ -145,29 +167,157 @@ def _wrap_guidance(guidance: str) -> str:
 
 
 def _load_user_patterns(cwd: Optional[str]) -> List[Dict[str, Any]]:
+    cache = _load_pattern_cache()
+    dirty = False
     rules: List[Dict[str, Any]] = []
+    deadline: Optional[float] = None  # set by the first probe
+    deferred = 0
     for label, path in _config_paths(cwd, "security-patterns"):
         # _config_paths returns an extensionless stem (e.g.
         # ".claude/security-patterns" or ".claude/security-patterns.local");
         # try each supported extension.
         for ext in (".yaml", ".yml", ".json"):
             candidate = path + ext
-            data = _read_config(candidate)
-            if data is None:
+            try:
+                st = os.stat(candidate)
+            except OSError:
+                continue
+            specs, changed = _validated_specs(candidate, st, label, cache)
+            dirty = dirty or changed
+            if specs is None:
                 continue
-            for entry in (data or {}).get("patterns", []):
-                rule = _validate_pattern(entry, source=label)
+            for spec in specs:
+                if "regex" in spec and not spec.get("probed"):
+                    if spec.get("probe_rejects", 0) > _PROBE_RETRIES:
+                        continue
+                    # A started probe always finishes (each is bounded), so
+                    # every load settles at least one pattern.
+                    if deadline is None:
+                        deadline = time.perf_counter() + PATTERN_PROBE_TOTAL_MS / 1000
+                    elif time.perf_counter() > deadline:
+                        deferred += 1
+                        continue
+                    dirty = True
+                    if not _probe_spec(spec):
+                        continue
+                rule = _rule_from_spec(spec)
                 if rule:
                     rules.append(rule)
             break  # found one extension; don't double-load .yaml AND .json
         if len(rules) >= PATTERN_MAX_RULES:
             break
+    if deferred:
+        debug_log(f"extensibility: {deferred} user patterns left unprobed for a later load "
+                  f"(probe time {PATTERN_PROBE_TOTAL_MS:g}ms used up)")
+    if dirty:
+        _save_pattern_cache(cache)
     if len(rules) > PATTERN_MAX_RULES:
         debug_log(f"extensibility: {len(rules)} user patterns > cap {PATTERN_MAX_RULES}; truncating")
         rules = rules[:PATTERN_MAX_RULES]
     return rules
 
 
+# ── validated-pattern cache ──────────────────────────────────────────────────
+#
+# {"key": ..., "files": {abs path: {mtime_ns, size, sha256, label, specs}}}.
+# `specs` are the JSON-able outputs of _pattern_spec; regex compilation and
+# the path_filter closure are rebuilt per process (cheap). A regex spec
+# carries "probed" once it passed the timing probes, or "probe_rejects" (how
+# many loads rejected it; past _PROBE_RETRIES it isn't probed again). The
+# specs belong to one content hash, so an edit to the file re-probes. A bump of
+# _PATTERN_CACHE_VERSION or a different budget invalidates everything.
+
+_PATTERN_CACHE_VERSION = 1
+_PATTERN_CACHE_MAX_FILES = 64
+
+
+def _pattern_cache_enabled() -> bool:
+    return os.environ.get("SG_PATTERN_CACHE", "1") != "0"
+
+
+def _pattern_cache_path() -> str:
+    state_dir = os.environ.get("SECURITY_WARNINGS_STATE_DIR", os.path.expanduser("~/.claude/security"))
+    return os.path.join(state_dir, "user-patterns-cache.json")
+
+
+def _pattern_cache_key() -> str:
+    return f"{_PATTERN_CACHE_VERSION}:{PATTERN_BUDGET_MS:g}"
+
+
+def _load_pattern_cache() -> Dict[str, Any]:
+    if not _pattern_cache_enabled():
+        return {}
+    try:
+        with open(_pattern_cache_path(), encoding="utf-8") as f:
+            cache = json.load(f)
+    except (OSError, ValueError):
+        return {}
+    if not isinstance(cache, dict) or cache.get("key") != _pattern_cache_key() \
+            or not isinstance(cache.get("files"), dict):
+        return {}
+    return cache["files"]
+
+
+def _save_pattern_cache(files: Dict[str, Any]) -> None:
+    if not _pattern_cache_enabled():
+        return
+    while len(files) > _PATTERN_CACHE_MAX_FILES:
+        files.pop(next(iter(files)))
+    path = _pattern_cache_path()
+    tmp = f"{path}.{os.getpid()}.tmp"
+    try:
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump({"key": _pattern_cache_key(), "files": files}, f)
+        os.replace(tmp, path)
+    except OSError as e:
+        debug_log(f"extensibility: could not write pattern cache: {e}")
+        try:
+            os.unlink(tmp)
+        except OSError:
+            pass
+
+
+def _validated_specs(path: str, st: os.stat_result, label: str,
+                     cache: Dict[str, Any]) -> Tuple[Optional[List[Dict[str, Any]]], bool]:
+    """(specs or None, cache_changed) for one config file.
+
+    An mtime+size match returns the cached specs without opening the file; a
+    content-hash match (touched but unchanged, e.g. a checkout) refreshes the
+    stat fields. Files that don't parse are not cached, so installing PyYAML
+    or fixing the file takes effect on the next invocation.
+    """
+    entry = cache.get(path)
+    if isinstance(entry, dict) and entry.get("label") == label \
+            and entry.get("mtime_ns") == st.st_mtime_ns and entry.get("size") == st.st_size:
+        hook_count("cache_hits")
+        return entry.get("specs"), False
+    try:
+        with open(path, "rb") as f:
+            raw = f.read()
+    except OSError:
+        return None, False
+    digest = hashlib.sha256(raw).hexdigest()
+    if isinstance(entry, dict) and entry.get("label") == label and entry.get("sha256") == digest:
+        entry.update(mtime_ns=st.st_mtime_ns, size=st.st_size)
+        hook_count("cache_hits")
+        return entry.get("specs"), True
+    hook_count("cache_misses")
+    data = _parse_config(path, raw.decode("utf-8", errors="replace"))
+    if data is None:
+        cache.pop(path, None)
+        return None, entry is not None
+    specs = []
+    for item in (data or {}).get("patterns", []) if isinstance(data, dict) else []:
+        spec = _pattern_spec(item, source=label)
+        if spec:
+            specs.append(spec)
+    cache.pop(path, None)
+    cache[path] = {"mtime_ns": st.st_mtime_ns, "size": st.st_size, "sha256": digest,
+                   "label": label, "specs": specs}
+    return specs, True
+
+
 def _read_config(path: str) -> Optional[Dict[str, Any]]:
     """Read a YAML or JSON config file. Returns None on missing/malformed."""
     try:
@@ -175,6 +325,10 @@ def _read_config(path: str) -> Optional[Dict[str, Any]]:
             raw = f.read()
     except OSError:
         return None
+    return _parse_config(path, raw)
+
+
+def _parse_config(path: str, raw: str) -> Optional[Dict[str, Any]]:
     if not raw.strip():
         return None
     if path.endswith(".json"):
@@ -199,6 +353,16 @@ def _read_config(path: str) -> Optional[Dict[str, Any]]:
 def _validate_pattern(entry: Any, source: str) -> Optional[Dict[str, Any]]:
     """Validate one user pattern entry. Returns a rule dict in the same shape
     as the built-in SECURITY_PATTERNS, or None if invalid (logged)."""
+    spec = _pattern_spec(entry, source)
+    if spec and "regex" in spec and not _probe_spec(spec):
+        return None
+    return _rule_from_spec(spec) if spec else None
+
+
+def _pattern_spec(entry: Any, source: str) -> Optional[Dict[str, Any]]:
+    """The validated, JSON-serializable form of one pattern entry (what the
+    cache stores), or None if invalid (logged). Static checks only; the
+    timing probes are _probe_spec's, since a rejection there is retried."""
     if not isinstance(entry, dict):
         return None
     name = str(entry.get("rule_name", "")).strip()
@@ -216,20 +380,20 @@ def _validate_pattern(entry: Any, source: str) -> Optional[Dict[str, Any]]:
         debug_log(f"extensibility: skipping {name}: no regex or substrings")
         return None
 
-    rule: Dict[str, Any] = {"ruleName": f"user:{name}", "reminder": reminder, "_source": source}
+    spec: Dict[str, Any] = {"ruleName": f"user:{name}", "reminder": reminder, "_source": source}
 
     if substrings:
-        rule["substrings"] = substrings
+        spec["substrings"] = substrings
     if regex:
         if _has_redos_structure(regex):
             debug_log(f"extensibility: skipping {name}: regex looks ReDoS-prone: {regex!r:.60}")
             return None
         try:
-            rule["regex"] = regex
-            re.compile(regex)
+            compiled = re.compile(regex)
         except re.error as e:
             debug_log(f"extensibility: skipping {name}: invalid regex: {e}")
             return None
+        spec["regex"] = regex
 
     paths = entry.get("paths") or []
     exclude = entry.get("exclude_paths") or []
@@ -237,6 +401,24 @@ def _validate_pattern(entry: Any, source: str) -> Optional[Dict[str, Any]]:
         if not isinstance(paths, list) or not isinstance(exclude, list):
             debug_log(f"extensibility: skipping {name}: paths/exclude_paths must be lists")
             return None
+        spec["paths"] = [str(p) for p in paths]
+        spec["exclude_paths"] = [str(p) for p in exclude]
+    return spec
+
+
+def _rule_from_spec(spec: Dict[str, Any]) -> Optional[Dict[str, Any]]:
+    """Rule dict (SECURITY_PATTERNS shape) for a spec. The compiled regex
+    rides along as ``_compiled`` so PatternScanner doesn't compile it again."""
+    rule = {k: v for k, v in spec.items()
+            if k not in ("paths", "exclude_paths", "probed", "probe_rejects")}
+    if "regex" in rule:
+        try:
+            rule["_compiled"] = re.compile(rule["regex"])
+        except re.error:
+            return None
+    paths = spec.get("paths") or []
+    exclude = spec.get("exclude_paths") or []
+    if paths or exclude:
         # Capture as defaults so the lambda doesn't share state across rules.
         rule["path_filter"] = (
             lambda p, _inc=tuple(paths), _exc=tuple(exclude): _glob_match(p, _inc, _exc)
@@ -287,3 +469,130 @@ def _has_redos_structure(regex: str) -> bool:
                 if a.startswith(b) or b.startswith(a):
                     return True
     return False
+
+
+# ── match-time budget ────────────────────────────────────────────────────────
+
+# Probe lengths, short first: an exponential regex shows up within a few
+# extra characters and is rejected before a longer probe could hang the
+# load; polynomial ones show up at the long end.
+_PROBE_LENGTHS = (8, 12, 16, 20, 24, 32, 64, 128, 256, 512, 1024, 2048, 4096)
+# Tails that make the overall match fail, forcing full backtracking.
+_PROBE_TAILS = ("\x00", "!\n")
+_PROBE_MAX_UNITS = 8
+# Largest accepted growth exponent k (time ~ length**k) between two probe
+# lengths. re.search retries every start offset, so ordinary patterns like
+# `\w+\s*=\s*\w+` or `.*secret.*` are quadratic on a long run of one
+# character (k measures 1.8-2.4); backtracking blowups measure 10 and up.
+_PROBE_MAX_GROWTH = 3.0
+# Loads that may reject a regex before the rejection is final.
+_PROBE_RETRIES = 1
+
+
+def _probe_units(regex: str) -> List[str]:
+    """Strings whose repetition exercises the regex's loops: each literal
+    character it mentions, a representative of each class it uses, and its
+    longest literal run."""
+    units: List[str] = []
+    run: List[str] = []
+    runs: List[str] = []
+
+    def _walk(items):
+        for op, av in items:
+            if op is _sre_parse.LITERAL:
+                run.append(chr(av))
+                units.append(chr(av))
+                continue
+            if run:
+                runs.append("".join(run))
+                del run[:]
+            if op is _sre_parse.IN:
+                for iop, iav in av:
+                    if iop is _sre_parse.LITERAL:
+                        units.append(chr(iav))
+                    elif iop is _sre_parse.RANGE:
+                        units.append(chr(iav[0]))
+                    elif iop is _sre_parse.CATEGORY:
+                        units.append(" " if "SPACE" in str(iav) else
+                                     "1" if "DIGIT" in str(iav) else "a")
+            elif op is _sre_parse.ANY:
+                units.append("a")
+            elif op in (_sre_parse.MAX_REPEAT, _sre_parse.MIN_REPEAT):
+                _walk(av[2])
+            elif op is _sre_parse.SUBPATTERN:
+                _walk(av[-1])
+            elif op is _sre_parse.BRANCH:
+                for branch in av[1]:
+                    _walk(branch)
+        if run:
+            runs.append("".join(run))
+            del run[:]
+
+    try:
+        _walk(_sre_parse.parse(regex))
+    except Exception:
+        pass
+    units = list(dict.fromkeys(units + ["a", " "]))[:_PROBE_MAX_UNITS]
+    if runs and len(max(runs, key=len)) > 1:
+        units.append(max(runs, key=len))
+    return units
+
+
+def _time_search(compiled: "re.Pattern[str]", text: str) -> float:
+    start = time.perf_counter()
+    compiled.search(text)
+    return (time.perf_counter() - start) * 1000
+
+
+def _exceeds_budget(compiled: "re.Pattern[str]", regex: str) -> Optional[float]:
+    """Milliseconds of the probe that showed super-polynomial growth, or None.
+
+    Probes run over increasing lengths. Once one takes longer than
+    PATTERN_BUDGET_MS it is timed again (the faster run counts, so a
+    scheduling hiccup doesn't reject), and its growth exponent against the
+    same probe at the previous length decides: above _PROBE_MAX_GROWTH the
+    regex is rejected; otherwise it is polynomial, longer probes would only
+    cost time, and it passes. Budget <= 0 disables timing."""
+    if PATTERN_BUDGET_MS <= 0:
+        return None
+    units = _probe_units(regex)
+    previous: Dict[Tuple[str, str], Tuple[int, float]] = {}
+    for n in _PROBE_LENGTHS:
+        for unit in units:
+            body = unit * max(1, n // len(unit))
+            length = len(body)
+            for tail in _PROBE_TAILS:
+                elapsed = _time_search(compiled, body + tail)
+                prev = previous.get((unit, tail))
+                previous[(unit, tail)] = (length, elapsed)
+                if elapsed <= PATTERN_BUDGET_MS:
+                    continue
+                elapsed = min(elapsed, _time_search(compiled, body + tail))
+                if elapsed <= PATTERN_BUDGET_MS:
+                    continue
+                if prev is None or prev[0] >= length:
+                    return elapsed  # over budget on its shortest probe
+                growth = math.log(elapsed / max(prev[1], 1e-3)) / math.log(length / prev[0])
+                return elapsed if growth > _PROBE_MAX_GROWTH else None
+    return None
+
+
+def _probe_spec(spec: Dict[str, Any]) -> bool:
+    """Time a spec's regex; True (and spec["probed"] set) if it passed.
+
+    A rejection bumps spec["probe_rejects"]; the loader retries it up to
+    _PROBE_RETRIES times, since one slow load can be a busy machine."""
+    try:
+        compiled = re.compile(spec["regex"])
+    except re.error:
+        return False
+    slow = _exceeds_budget(compiled, spec["regex"])
+    if slow:
+        spec["probe_rejects"] = spec.get("probe_rejects", 0) + 1
+        debug_log(f"extensibility: skipping {spec['ruleName']}: regex took {slow:.0f}ms on a "
+                  f"worst-case probe (budget {PATTERN_BUDGET_MS:g}ms) and grows faster than "
+                  f"polynomially: {spec['regex']!r:.60}")
+        return False
+    spec.pop("probe_rejects", None)
+    spec["probed"] = True
+    return True
@@ -14,10 +14,22 @@ Functions that DO compose patched leaves (``compute_v2_review_set``,
 ``_list_untracked``, ``_append_reviewed_shas``) deliberately remain in
 ``security_reminder_hook.py`` for that reason.
 """
+import atexit
 import contextlib
+import functools
+import hashlib
+import json
 import os
 import re
+import select
 import subprocess
+import threading
+import time
+
+try:
+    import fcntl
+except ImportError:
+    fcntl = None
 
 from _base import debug_log
 
@@ -28,23 +40,216 @@ GIT_CMD = [
     "-c", "core.hooksPath=/dev/null",
 ]
 
+# Same, but using git's builtin fsmonitor daemon. Only used when the repo
+# already opts into it (core.fsmonitor=true); a core.fsmonitor hook *command*
+# is never run, which is why GIT_CMD forces it off.
+GIT_CMD_FSMONITOR = [
+    "git",
+    "-c", "core.fsmonitor=true",
+    "-c", "core.hooksPath=/dev/null",
+]
+
+# Windows caps a command line at 32K chars; keep each pathspec-restricted
+# invocation well under that and split longer path lists across calls.
+_PATHSPEC_CHUNK_CHARS = 24000
 
-def _git_rev_parse_head(cwd):
-    """Return the current HEAD SHA, or None if not a git repo / no commits."""
+
+# =====================================================================
+# Per-invocation memo + cat-file coprocess
+#
+# One Stop/commit hook run asks for the toplevel, git-dir and HEAD of the
+# same repo many times over, and resolves refs / reads baseline blobs one
+# fork+exec each. Repo-shape queries are memoized for the life of the
+# process (one hook invocation), and ref/blob lookups go through a single
+# long-lived `git cat-file --batch-check` / `--batch` per repo.
+# =====================================================================
+
+_MEMO = {}
+
+
+def _memoized_per_repo(fn):
+    """Cache fn(cwd) per realpath(cwd) for this process. None (failure) is
+    not cached, so a transient timeout is retried on the next call."""
+    @functools.wraps(fn)
+    def wrapper(cwd):
+        key = (fn.__name__, os.path.realpath(cwd) if cwd else cwd)
+        if key in _MEMO:
+            return _MEMO[key]
+        value = fn(cwd)
+        if value is not None:
+            _MEMO[key] = value
+        return value
+    return wrapper
+
+
+def clear_git_memo():
+    """Drop memoized repo queries (for callers that move HEAD themselves)."""
+    _MEMO.clear()
+
+
+# Per-query deadline, matching the timeout of the one-shot calls the
+# coprocess replaced. In a partial clone cat-file fetches missing blobs from
+# the remote, which can otherwise hang the hook.
+CAT_FILE_TIMEOUT_S = 5
+
+
+class _CatFile:
+    """A `git cat-file --batch` or `--batch-check` coprocess for one repo.
+
+    Thread-safe (UPS queries from a worker pool). Raises OSError once the
+    process is gone, or after killing it when a query passes
+    CAT_FILE_TIMEOUT_S, so callers fall back to a one-shot subprocess.
+    """
+
+    def __init__(self, cwd, with_contents):
+        if os.name == "nt":
+            # select() only waits on sockets there; without a deadline the
+            # one-shot calls (which have timeouts) are the safer path.
+            raise OSError("cat-file coprocess needs select() on pipes")
+        self._with_contents = with_contents
+        self._lock = threading.Lock()
+        self._buf = bytearray()
+        self._proc = subprocess.Popen(
+            [*GIT_CMD, "cat-file", "--batch" if with_contents else "--batch-check"],
+            cwd=cwd, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+            stderr=subprocess.DEVNULL, bufsize=0,
+        )
+
+    def _fill(self, deadline):
+        """Append the next chunk of stdout to the buffer, or raise."""
+        fd = self._proc.stdout.fileno()
+        remaining = deadline - time.monotonic()
+        if remaining <= 0 or not select.select([fd], [], [], remaining)[0]:
+            self._proc.kill()
+            raise OSError("cat-file timed out")
+        chunk = os.read(fd, 65536)
+        if not chunk:
+            raise OSError("cat-file exited")
+        self._buf += chunk
+
+    def query(self, name):
+        """(oid, type, contents-or-None), or None if the object is missing."""
+        with self._lock:
+            if self._proc.poll() is not None:
+                raise OSError("cat-file exited")
+            deadline = time.monotonic() + CAT_FILE_TIMEOUT_S
+            self._proc.stdin.write(name.encode("utf-8", "surrogateescape") + b"\n")
+            self._proc.stdin.flush()
+            while b"\n" not in self._buf:
+                self._fill(deadline)
+            end = self._buf.index(b"\n")
+            header = bytes(self._buf[:end])
+            del self._buf[:end + 1]
+            parts = header.split()
+            # Found: "<oid> <type> <size>". Anything else ("<name> missing",
+            # "<name> ambiguous") means not found; the name may contain spaces.
+            if len(parts) != 3 or not parts[2].isdigit():
+                return None
+            contents = None
+            if self._with_contents:
+                size = int(parts[2])
+                while len(self._buf) < size + 1:  # contents + trailing LF
+                    self._fill(deadline)
+                contents = bytes(self._buf[:size])
+                del self._buf[:size + 1]
+            return parts[0].decode(), parts[1].decode(), contents
+
+    def close(self):
+        try:
+            self._proc.stdin.close()
+            self._proc.wait(timeout=1)
+        except (OSError, subprocess.TimeoutExpired):
+            self._proc.kill()
+
+
+_CAT_FILES = {}
+_CAT_FILES_LOCK = threading.Lock()
+
+# Names cat-file can resolve without dying. cat-file exits on a fatal ref
+# error (e.g. `@{u}` with no upstream), so reflog/upstream syntax and other
+# exotic revisions go through rev-parse instead.
+_BATCH_REF_RE = re.compile(r"^[A-Za-z0-9._/~^-]+$")
+
+
+def _cat_file(cwd, with_contents):
+    key = (os.path.realpath(cwd) if cwd else cwd, with_contents)
+    with _CAT_FILES_LOCK:
+        proc = _CAT_FILES.get(key)
+        if proc is None:
+            proc = _CatFile(cwd, with_contents)
+            _CAT_FILES[key] = proc
+        return proc
+
+
+def _cat_file_query(cwd, name, with_contents):
+    """Query the coprocess. Returns (found, result); found=False means the
+    coprocess is unusable and the caller should fall back."""
+    if "\n" in name or not name:
+        return False, None
+    try:
+        return True, _cat_file(cwd, with_contents).query(name)
+    except (OSError, ValueError) as e:
+        debug_log(f"cat-file coprocess unavailable: {e}")
+        with _CAT_FILES_LOCK:
+            proc = _CAT_FILES.pop((os.path.realpath(cwd) if cwd else cwd, with_contents), None)
+        if proc is not None:
+            proc.close()
+        return False, None
+
+
+@atexit.register
+def _close_cat_files():
+    with _CAT_FILES_LOCK:
+        procs = list(_CAT_FILES.values())
+        _CAT_FILES.clear()
+    for proc in procs:
+        proc.close()
+
+
+def _git_resolve(cwd, ref):
+    """Full object id `ref` resolves to (like `rev-parse --verify -q`), or None."""
+    if _BATCH_REF_RE.match(ref):
+        ok, hit = _cat_file_query(cwd, ref, with_contents=False)
+        if ok:
+            return hit[0] if hit else None
+    try:
+        r = subprocess.run(
+            [*GIT_CMD, "rev-parse", "--verify", "-q", ref],
+            cwd=cwd, capture_output=True, text=True, timeout=5,
+        )
+        return r.stdout.strip() if r.returncode == 0 and r.stdout.strip() else None
+    except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
+        return None
+
+
+def _git_show_blob(cwd, spec):
+    """Text of the blob `spec` names (e.g. "<sha>:<path>"), or None if it
+    doesn't exist / isn't a blob. Decoded as UTF-8 with replacement."""
+    ok, hit = _cat_file_query(cwd, spec, with_contents=True)
+    if ok:
+        if not hit or hit[1] != "blob":
+            return None
+        return hit[2].decode("utf-8", errors="replace")
     try:
         result = subprocess.run(
-            [*GIT_CMD, "rev-parse", "HEAD"],
-            cwd=cwd, capture_output=True, text=True, timeout=5
+            [*GIT_CMD, "show", spec],
+            cwd=cwd, capture_output=True, timeout=5,
         )
-        if result.returncode == 0 and result.stdout.strip():
-            return result.stdout.strip()
+        if result.returncode == 0:
+            return result.stdout.decode("utf-8", errors="replace")
         return None
     except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
         return None
 
 
+@_memoized_per_repo
+def _git_rev_parse_head(cwd):
+    """Return the current HEAD SHA, or None if not a git repo / no commits.
+    Memoized for the invocation."""
+    return _git_resolve(cwd, "HEAD")
 
 
+@_memoized_per_repo
 def _find_git_index(cwd):
     """
     Find the real index file for a git repo. Handles worktrees where .git
@@ -88,16 +293,181 @@ def _diff_pathspec(cwd, paths):
     return ["--"] + rel if rel else []
 
 
+# Reuse one shadow index per repo across reviews instead of copying the real
+# index for every diff. SG_SHADOW_INDEX=0 restores copy-per-diff.
+SHADOW_INDEX_ENABLED = os.environ.get("SG_SHADOW_INDEX", "1") != "0"
+
+
+def _shadow_index_paths(real_index):
+    """(index, stamp, lock) paths of the shadow index for a real index.
+
+    Named under the state-file prefix so cleanup_old_state_files() GCs them.
+    The lock is deliberately NOT `<index>.lock` — git takes that one itself.
+    """
+    state_dir = os.environ.get("SECURITY_WARNINGS_STATE_DIR", os.path.expanduser("~/.claude/security"))
+    key = hashlib.sha1(os.path.realpath(real_index).encode("utf-8", "replace")).hexdigest()[:16]
+    base = os.path.join(state_dir, f"security_warnings_state_shadow_{key}")
+    return base + ".index", base + ".stamp", base + ".lock"
+
+
+def _surviving(cwd, paths):
+    """Filter to paths that still exist (lexists so dangling symlinks count).
+
+    `git add -N -- a b nonexistent` is atomic — one missing path makes it
+    exit 128 and add NOTHING, so a file removed between `git status` and
+    here would silently drop ALL untracked files from the diff.
+    --ignore-missing only works with --dry-run, hence the filter."""
+    return [p for p in paths if os.path.lexists(os.path.join(cwd, p))]
+
+
+def _list_untracked_files(cwd):
+    """Untracked, non-ignored files relative to `cwd` per the REAL index, or
+    None on error. Same worktree walk `add -N .` does."""
+    r = subprocess.run(
+        [*GIT_CMD, "-c", "core.quotePath=false", "ls-files", "-z", "--others", "--exclude-standard"],
+        cwd=cwd, capture_output=True, text=True, timeout=10,
+    )
+    if r.returncode != 0:
+        return None
+    return [p for p in r.stdout.split("\0") if p]
+
+
+def _open_shadow_index(cwd, real_index, untracked_paths, refresh_paths):
+    """Bring the repo's shadow index up to date and lock it for one diff.
+
+    Returns (env, lock_fd), or None if the shadow can't be used right now
+    (another review holds it, or any step failed) — the caller then falls
+    back to a throwaway copy.
+
+    The shadow is re-copied from the real index only when the real index's
+    (mtime, size) or HEAD differ from the stamp recorded at the last copy.
+    Otherwise it is reused as-is: intent-to-add entries from earlier calls
+    that are no longer wanted are force-removed, new untracked files are
+    added, and the stat info of `refresh_paths` (the touched files) is
+    refreshed with `git add --refresh` so unchanged files aren't re-hashed
+    on every diff.
+    """
+    import shutil
+
+    shadow, stamp_path, lock_path = _shadow_index_paths(real_index)
+    try:
+        os.makedirs(os.path.dirname(shadow), exist_ok=True)
+        lock_fd = os.open(lock_path, os.O_RDWR | os.O_CREAT)
+    except OSError:
+        return None
+    try:
+        fcntl.flock(lock_fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+    except OSError:
+        # Busy (parallel review of the same repo) — don't wait on it.
+        os.close(lock_fd)
+        return None
+
+    ok = False
+    try:
+        st = os.stat(real_index)
+        stamp = {"index": [st.st_mtime_ns, st.st_size], "head": _git_rev_parse_head(cwd)}
+        prev = None
+        try:
+            with open(stamp_path) as f:
+                prev = json.load(f)
+        except (OSError, ValueError):
+            pass
+        reuse = (isinstance(prev, dict) and os.path.isfile(shadow)
+                 and prev.get("index") == stamp["index"] and prev.get("head") == stamp["head"])
+        if reuse:
+            added = set(prev.get("added") or [])
+        else:
+            shutil.copy2(real_index, shadow)
+            added = set()
+        env = {**os.environ, "GIT_INDEX_FILE": shadow}
+
+        # Drop the stamp while the shadow is being mutated, so a crash
+        # mid-update forces a fresh copy next time.
+        try:
+            os.unlink(stamp_path)
+        except OSError:
+            pass
+
+        if untracked_paths is None:
+            untracked_paths = _list_untracked_files(cwd)
+            if untracked_paths is None:
+                return None
+        wanted = set(_surviving(cwd, untracked_paths))
+
+        stale = sorted(added - wanted)
+        if stale:
+            r = subprocess.run(
+                [*GIT_CMD, "update-index", "--force-remove", "-z", "--stdin"],
+                cwd=cwd, input="\0".join(stale) + "\0", capture_output=True, text=True,
+                timeout=10, env=env,
+            )
+            if r.returncode != 0:
+                return None
+        new = sorted(wanted - added)
+        # Chunked: a large untracked tree would overflow one argv (E2BIG).
+        for chunk in _pathspec_chunks(new):
+            r = subprocess.run(
+                [*GIT_CMD, "add", "--intent-to-add", "--"] + chunk,
+                cwd=cwd, capture_output=True, text=True, timeout=10, env=env,
+            )
+            if r.returncode != 0:
+                return None
+        if reuse and refresh_paths:
+            pathspec = _diff_pathspec(cwd, refresh_paths)
+            if pathspec:
+                # `add --refresh` aborts on any path not in the index
+                # (ignored / never-added files), so narrow to indexed ones.
+                # Best-effort: a failed refresh only costs re-hashing.
+                r = subprocess.run(
+                    [*GIT_CMD, "-c", "core.quotePath=false", "ls-files", "-z"] + pathspec,
+                    cwd=cwd, capture_output=True, text=True, timeout=10, env=env,
+                )
+                indexed = [p for p in r.stdout.split("\0") if p] if r.returncode == 0 else []
+                for chunk in _pathspec_chunks(indexed):
+                    subprocess.run(
+                        [*GIT_CMD, "add", "--refresh", "--"] + chunk,
+                        cwd=cwd, capture_output=True, text=True, timeout=10, env=env,
+                    )
+
+        stamp["added"] = sorted(wanted)
+        with open(stamp_path, "w") as f:
+            json.dump(stamp, f)
+        debug_log(f"shadow index {'reused' if reuse else 'rebuilt'} (+{len(new)} -{len(stale)} intent-to-add)")
+        ok = True
+        return env, lock_fd
+    except (subprocess.TimeoutExpired, FileNotFoundError, OSError, ValueError) as e:
+        debug_log(f"shadow index unavailable: {e}")
+        return None
+    finally:
+        if not ok:
+            _release_shadow_index(lock_fd)
+
+
+def _release_shadow_index(lock_fd):
+    try:
+        fcntl.flock(lock_fd, fcntl.LOCK_UN)
+        os.close(lock_fd)
+    except OSError:
+        pass
+
+
 @contextlib.contextmanager
-def _temp_index(cwd, untracked_paths=None):
-    """Yield an env dict pointing GIT_INDEX_FILE at a throwaway copy of the
+def _temp_index(cwd, untracked_paths=None, refresh_paths=None):
+    """Yield an env dict pointing GIT_INDEX_FILE at a private copy of the
     repo's index with `git add --intent-to-add` applied, so untracked files
     show up in subsequent `git diff` calls without touching the user's real
     index. Yields None if no index can be found (bare repo / not a repo); the
-    caller should fall back to a plain diff. Always cleans up the temp file.
+    caller should fall back to a plain diff.
+
+    The copy is a persistent per-repo shadow index (see _open_shadow_index)
+    locked for the duration of the `with`, so back-to-back reviews don't
+    re-copy a large index. If the shadow is busy or unusable (or on
+    platforms without fcntl), a throwaway copy is made instead and always
+    cleaned up. `refresh_paths` (absolute touched paths) only affects the
+    shadow's stat cache, never the diff result.
 
     Perf: when `untracked_paths` is given, only those paths are added (O(n)
-    in untracked count). The default `add -N .` stats every file in the
+    in untracked count). The default lists every untracked file in the
     worktree — slow in large repos vs fast targeted scan. v2 callers
     already know the untracked set from `git status --porcelain`, so they
     pass it; v1 keeps the whole-tree scan since it has no prior list."""
@@ -109,25 +479,29 @@ def _temp_index(cwd, untracked_paths=None):
         yield None
         return
 
+    shadow = None
+    if SHADOW_INDEX_ENABLED and fcntl is not None:
+        shadow = _open_shadow_index(cwd, real_index, untracked_paths, refresh_paths)
+    if shadow is not None:
+        env, lock_fd = shadow
+        try:
+            yield env
+        finally:
+            _release_shadow_index(lock_fd)
+        return
+
     tmp_fd, tmp_index = tempfile.mkstemp(prefix="security_hook_idx_")
     os.close(tmp_fd)
     try:
         shutil.copy2(real_index, tmp_index)
         env = {**os.environ, "GIT_INDEX_FILE": tmp_index}
         if untracked_paths is None:
-            add_args = ["."]
+            add_chunks = [["."]]
         elif untracked_paths:
-            # `git add -N -- a b nonexistent` is atomic — one missing path
-            # makes it exit 128 and add NOTHING, so a file removed between
-            # `git status` and here would silently drop ALL untracked files
-            # from the diff. --ignore-missing only works with --dry-run, so
-            # filter to surviving paths (lexists so dangling symlinks count).
-            surviving = [p for p in untracked_paths
-                         if os.path.lexists(os.path.join(cwd, p))]
-            add_args = ["--"] + surviving if surviving else None
+            add_chunks = [["--"] + chunk for chunk in _pathspec_chunks(_surviving(cwd, untracked_paths))]
         else:
-            add_args = None
-        if add_args:
+            add_chunks = []
+        for add_args in add_chunks:
             subprocess.run(
                 [*GIT_CMD, "add", "--intent-to-add"] + add_args,
                 cwd=cwd, capture_output=True, text=True, timeout=10,
@@ -141,8 +515,10 @@ def _temp_index(cwd, untracked_paths=None):
             pass
 
 
+@_memoized_per_repo
 def _git_toplevel(cwd):
-    """Absolute repo root for `cwd`, or None if not in a work tree."""
+    """Absolute repo root for `cwd`, or None if not in a work tree.
+    Memoized for the invocation."""
     try:
         r = subprocess.run(
             [*GIT_CMD, "rev-parse", "--show-toplevel"],
@@ -153,8 +529,9 @@ def _git_toplevel(cwd):
         return None
 
 
+@_memoized_per_repo
 def _git_dir(repo_root):
-    """Absolute shared `.git` directory for repo_root.
+    """Absolute shared `.git` directory for repo_root (memoized).
 
     Uses `rev-parse --git-common-dir` so linked worktrees resolve to the
     SHARED gitdir, not the per-worktree `.git/worktrees/<name>/`. That way
@@ -212,15 +589,8 @@ def _git_diff_range(repo_root, base, head="HEAD"):
 
 def _detect_main_branch(repo_root):
     for ref in ("origin/HEAD", "origin/main", "origin/master", "main", "master"):
-        try:
-            r = subprocess.run(
-                [*GIT_CMD, "rev-parse", "--verify", "-q", ref],
-                cwd=repo_root, capture_output=True, text=True, timeout=5,
-            )
-            if r.returncode == 0 and r.stdout.strip():
-                return ref
-        except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
-            pass
+        if _git_resolve(repo_root, ref):
+            return ref
     return None
 
 
@@ -300,15 +670,45 @@ def _git_reflog_recent_commits(repo_root, max_age_s=120, max_n=5):
     return fresh, stale
 
 
-def _git_name_only(cwd, base, include_untracked=False):
+def _pathspec_chunks(paths):
+    """Split repo-relative paths into argv-sized literal pathspec lists.
+    [None] (one unrestricted call) when paths is None."""
+    if paths is None:
+        return [None]
+    chunks, chunk, size = [], [], 0
+    for p in sorted(paths):
+        if chunk and size + len(p) + 1 > _PATHSPEC_CHUNK_CHARS:
+            chunks.append(chunk)
+            chunk, size = [], 0
+        chunk.append(p)
+        size += len(p) + 1
+    if chunk:
+        chunks.append(chunk)
+    return chunks
+
+
+def _git_base_cmd(fsmonitor, literal):
+    cmd = list(GIT_CMD_FSMONITOR if fsmonitor else GIT_CMD)
+    if literal:
+        # Recorded paths are file names, not globs.
+        cmd.append("--literal-pathspecs")
+    return cmd
+
+
+def _git_name_only(cwd, base, include_untracked=False, paths=None, fsmonitor=False):
     """Return the set of repo-root-relative paths that differ from `base`,
     or None if git failed (unresolvable ref, not a repo, timeout). Callers
     must distinguish None (error → don't trust as a filter) from set()
     (genuinely nothing changed). `-c core.quotePath=false -z` keeps non-ASCII
-    and space-containing paths intact."""
-    def _run(env):
+    and space-containing paths intact.
+
+    paths: repo-relative paths to restrict the diff to (None = whole tree).
+    fsmonitor: use the builtin fsmonitor daemon (see GIT_CMD_FSMONITOR)."""
+    def _run(env, chunk):
         result = subprocess.run(
-            [*GIT_CMD, "-c", "core.quotePath=false", "diff", "--name-only", "-z", base],
+            [*_git_base_cmd(fsmonitor, chunk is not None),
+             "-c", "core.quotePath=false", "diff", "--name-only", "-z", base,
+             *(["--", *chunk] if chunk is not None else [])],
             cwd=cwd, capture_output=True, text=True, timeout=30,
             env=env,
         )
@@ -317,17 +717,114 @@ def _git_name_only(cwd, base, include_untracked=False):
             return None
         return {p for p in result.stdout.split("\0") if p}
 
+    def _run_all(env):
+        out = set()
+        for chunk in _pathspec_chunks(paths):
+            names = _run(env, chunk)
+            if names is None:
+                return None
+            out |= names
+        return out
+
+    if paths is not None and not paths:
+        return set()
     try:
         if not include_untracked:
-            return _run(None)
+            return _run_all(None)
         with _temp_index(cwd) as env:
-            return _run(env)
+            return _run_all(env)
     except (subprocess.TimeoutExpired, FileNotFoundError, OSError) as e:
         debug_log(f"_git_name_only({base!r}) error: {e}")
         return None
 
 
-def _git_status_porcelain(cwd):
+@_memoized_per_repo
+def _fsmonitor_daemon_configured(repo_root):
+    """True if the repo enables git's builtin fsmonitor daemon
+    (core.fsmonitor=true). A hook-command value doesn't count. Memoized."""
+    if os.environ.get("SG_FSMONITOR", "1") == "0":
+        return False
+    try:
+        r = subprocess.run(
+            ["git", "config", "--get", "core.fsmonitor"],
+            cwd=repo_root, capture_output=True, text=True, timeout=5,
+        )
+    except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
+        return False
+    return r.stdout.strip().lower() in ("true", "yes", "on", "1")
+
+
+def _watchman(command, timeout=3):
+    """Send one JSON command to an already-running watchman server. None if
+    watchman isn't installed or running (--no-spawn: never start one) or
+    the command fails."""
+    try:
+        r = subprocess.run(
+            ["watchman", "--no-spawn", "--no-pretty", "-j"],
+            input=json.dumps(command), capture_output=True, text=True,
+            timeout=timeout,
+        )
+    except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
+        return None
+    if r.returncode != 0:
+        return None
+    try:
+        out = json.loads(r.stdout)
+    except ValueError:
+        return None
+    if not isinstance(out, dict) or "error" in out:
+        return None
+    return out
+
+
+def watchman_clock(cwd):
+    """{"root", "rel", "clock"} for the watchman watch covering cwd's repo,
+    or None when watchman isn't already watching it. Captured at UPS so the
+    Stop hook can ask for every file changed since (Bash edits included).
+    A repo that isn't watched is never added — the initial crawl of a large
+    tree is exactly the cost this avoids."""
+    if os.environ.get("SG_WATCHMAN", "1") == "0":
+        return None
+    import shutil
+    if shutil.which("watchman") is None:
+        return None
+    repo = os.path.realpath(_git_toplevel(cwd) or cwd)
+    roots = (_watchman(["watch-list"]) or {}).get("roots") or []
+    root = next(
+        (r for r in sorted(roots, key=len, reverse=True)
+         if isinstance(r, str) and (repo == r or repo.startswith(r.rstrip(os.sep) + os.sep))),
+        None,
+    )
+    if root is None:
+        return None
+    out = _watchman(["clock", root])
+    clock = out.get("clock") if out else None
+    if not isinstance(clock, str):
+        return None
+    return {"root": root, "rel": os.path.relpath(repo, root), "clock": clock}
+
+
+def watchman_changed_since(info):
+    """Repo-relative paths created, modified or deleted since the clock in
+    `info` (from watchman_clock), or None if the answer can't be trusted
+    (watchman gone, or restarted since — a fresh instance lists everything)."""
+    if not isinstance(info, dict) or not isinstance(info.get("clock"), str):
+        return None
+    query = {"since": info["clock"], "fields": ["name"],
+             "expression": ["not", ["type", "d"]]}
+    if info.get("rel") not in (None, "", "."):
+        query["relative_root"] = info["rel"]
+    out = _watchman(["query", info.get("root"), query], timeout=5)
+    if out is None or out.get("is_fresh_instance"):
+        return None
+    files = out.get("files")
+    if not isinstance(files, list):
+        return None
+    return {f for f in files
+            if isinstance(f, str) and f != ".git" and not f.startswith(".git/")}
+
+
+def _git_status_porcelain(cwd, paths=None, fsmonitor=False):
     """One `git status --porcelain=v1 -z` → (tracked_dirty, untracked) sets of
     repo-root-relative paths, or (None, None) on error. Replaces the
     `_temp_index + git diff HEAD --name-only` pair for the v2 dirty_now
@@ -338,35 +835,43 @@ def _git_status_porcelain(cwd):
     -uall: list individual files inside untracked directories (default
     collapses to `dir/`). Required so the untracked set subtracts cleanly
     against the UPS-time `_list_untracked` snapshot, which uses ls-files and
-    therefore always lists individual files."""
+    therefore always lists individual files.
+
+    paths / fsmonitor: as for _git_name_only. Restricting to the paths a turn
+    touched makes the cost scale with the edit, not the repo."""
+    if paths is not None and not paths:
+        return set(), set()
     try:
-        r = subprocess.run(
-            [*GIT_CMD, "-c", "core.quotePath=false", "status",
-             "--porcelain=v1", "-uall", "-z"],
-            cwd=cwd, capture_output=True, text=True, timeout=30,
-        )
-        if r.returncode != 0:
-            debug_log(f"_git_status_porcelain rc={r.returncode}: {r.stderr[:200]}")
-            return None, None
         tracked, untracked = set(), set()
-        entries = r.stdout.split("\0")
-        i = 0
-        while i < len(entries):
-            e = entries[i]
-            if not e:
-                i += 1
-                continue
-            xy, path = e[:2], e[3:]
-            if xy == "??":
-                untracked.add(path)
-            else:
-                tracked.add(path)
-                # Rename/copy entries are XY old\0new\0 — second NUL field is
-                # the origin path; consume it so it isn't misparsed as a new
-                # 2-char-status entry.
-                if "R" in xy or "C" in xy:
+        for chunk in _pathspec_chunks(paths):
+            r = subprocess.run(
+                [*_git_base_cmd(fsmonitor, chunk is not None),
+                 "-c", "core.quotePath=false", "status",
+                 "--porcelain=v1", "-uall", "-z",
+                 *(["--", *chunk] if chunk is not None else [])],
+                cwd=cwd, capture_output=True, text=True, timeout=30,
+            )
+            if r.returncode != 0:
+                debug_log(f"_git_status_porcelain rc={r.returncode}: {r.stderr[:200]}")
+                return None, None
+            entries = r.stdout.split("\0")
+            i = 0
+            while i < len(entries):
+                e = entries[i]
+                if not e:
                     i += 1
-            i += 1
+                    continue
+                xy, path = e[:2], e[3:]
+                if xy == "??":
+                    untracked.add(path)
+                else:
+                    tracked.add(path)
+                    # Rename/copy entries are XY old\0new\0 — second NUL field is
+                    # the origin path; consume it so it isn't misparsed as a new
+                    # 2-char-status entry.
+                    if "R" in xy or "C" in xy:
+                        i += 1
+                i += 1
         return tracked, untracked
     except (subprocess.TimeoutExpired, FileNotFoundError, OSError) as e:
         debug_log(f"_git_status_porcelain error: {e}")
@@ -393,10 +898,9 @@ def get_git_diff(cwd, baseline_sha, full_context=False, paths=None, untracked_pa
     Get the git diff between the baseline SHA and the current working tree,
     including untracked (new) files.
 
-    Uses a temporary copy of the git index (GIT_INDEX_FILE) so the user's
-    real index is never modified. The temp index gets intent-to-add entries
-    for untracked files, making them visible in the diff output. Cleanup
-    is just deleting the temp file in a finally block.
+    Uses a private copy of the git index (GIT_INDEX_FILE, see _temp_index)
+    so the user's real index is never modified. The copy gets intent-to-add
+    entries for untracked files, making them visible in the diff output.
 
     If `paths` is given, the diff is restricted to those paths (relative to
     cwd; absolute paths are converted, paths outside cwd are dropped).
@@ -413,7 +917,7 @@ def get_git_diff(cwd, baseline_sha, full_context=False, paths=None, untracked_pa
 
     cmd = [*GIT_CMD, "diff", "--no-color", "--no-ext-diff", baseline_sha] + (["--unified=99999"] if full_context else []) + pathspec
     try:
-        with _temp_index(cwd, untracked_paths) as env:
+        with _temp_index(cwd, untracked_paths, refresh_paths=paths) as env:
             # env is None when no index could be found (bare repo / not a
             # repo) — diff still runs, just without untracked-file support.
             result = subprocess.run(cmd, cwd=cwd, capture_output=True, timeout=30, env=env)
@@ -476,6 +980,7 @@ SKIP_PATH_PATTERNS = (
 SKIP_FILE_SUFFIXES = (
     '.min.js', '.min.css', '.d.ts', '.d.mts', '.d.cts',
     '.lock', '_pb2.py', '.pb.go',
+    'package-lock.json', 'npm-shrinkwrap.json', 'pnpm-lock.yaml',
 )
 
 # Path tokens that bump a file's review priority when a commit exceeds
@@ -721,3 +1226,212 @@ def filter_preexisting_from_diff(diff_files, cwd, baseline_sha):
 
     return filtered
 
+
+# ---------------------------------------------------------------------------
+# Diff normalization
+# ---------------------------------------------------------------------------
+#
+# Runs between parse_diff_into_files and the prompt byte cap so the budget
+# goes to real changes. Three rewrites, all on the parsed hunk text (no extra
+# git calls):
+#   - hunks whose -/+ lines are equal once whitespace is normalized are
+#     dropped (`git diff -b --ignore-blank-lines` semantics, plus leading
+#     indentation where the language doesn't care about it);
+#   - a run of MOVE_MIN_LINES+ lines removed in one place and added verbatim
+#     elsewhere (same file or another) keeps its first and last line and the
+#     middle becomes a one-line marker on both sides;
+#   - files whose header carries a generated-code marker are dropped — but
+#     only when the marker line is unchanged context, so a diff can't opt
+#     itself out of review by adding (or rewriting) `// @generated`.
+# SG_DIFF_NORMALIZE=0 turns all of it off.
+
+DIFF_NORMALIZE_ENABLED = os.environ.get("SG_DIFF_NORMALIZE", "1") != "0"
+MOVE_MIN_LINES = 6
+# Generated-code markers are only honored within the first lines of a file,
+# and only the conventional tool-written forms at the start of a line (after
+# a comment leader): `@generated`, Go's `Code generated ... DO NOT EDIT.` and
+# .NET's `<auto-generated>`. Looser prose ("auto-generated", "generated by
+# ... do not edit") is as often a hand-written note about a hand-edited file.
+_GENERATED_HEAD_LINES = 5
+_GENERATED_MARKER_RE = re.compile(
+    r"^\s*(?:(?://+|#+|/?\*+|<!--|--|;+|%+)\s*)?"
+    r"(?:@generated\b|Code generated .* DO NOT EDIT\.|<auto-generated\b)"
+)
+# Leading indentation is syntax in these, so a re-indent is a real change
+# (it can move a statement out of an `if` guard).
+_INDENT_SENSITIVE_EXTENSIONS = {'.py', '.pyi', '.yaml', '.yml', '.ipynb', '.hcl'}
+_INDENT_SENSITIVE_BASENAMES = {'makefile', 'gnumakefile', 'justfile'}
+_HUNK_START_RE = re.compile(r"^@@ -(\d+)(?:,\d+)? \+(\d+)(?:,\d+)? @@")
+_WS_RUN_RE = re.compile(r"\s+")
+
+
+def _indent_sensitive(file_path):
+    base = os.path.basename(file_path).lower()
+    return (os.path.splitext(base)[1] in _INDENT_SENSITIVE_EXTENSIONS
+            or base.split(".", 1)[0] in _INDENT_SENSITIVE_BASENAMES)
+
+
+def _split_hunks(content):
+    """[[header, line, ...], ...] — content starts at the first @@."""
+    hunks = []
+    for line in content.split("\n"):
+        if line.startswith("@@") or not hunks:
+            hunks.append([line])
+        else:
+            hunks[-1].append(line)
+    return hunks
+
+
+def _ws_key(text, keep_indent):
+    """Line text with whitespace runs collapsed; leading indentation kept
+    verbatim only when keep_indent."""
+    body = text.strip()
+    if not body:
+        return ""
+    collapsed = _WS_RUN_RE.sub(" ", body)
+    if keep_indent:
+        return text[:len(text) - len(text.lstrip())] + collapsed
+    return collapsed
+
+
+def _whitespace_only_hunk(hunk, keep_indent):
+    removed, added = [], []
+    for line in hunk[1:]:
+        if line.startswith("-"):
+            removed.append(_ws_key(line[1:], keep_indent))
+        elif line.startswith("+"):
+            added.append(_ws_key(line[1:], keep_indent))
+    if not removed and not added:
+        return False
+    return ([k for k in removed if k] == [k for k in added if k])
+
+
+def _runs(hunks, sign):
+    """(hunk index, start, end) of each maximal run of `sign` lines."""
+    out = []
+    for hi, hunk in enumerate(hunks):
+        start = None
+        for li in range(1, len(hunk) + 1):
+            inside = li < len(hunk) and hunk[li].startswith(sign)
+            if inside and start is None:
+                start = li
+            elif not inside and start is not None:
+                out.append((hi, start, li))
+                start = None
+    return out
+
+
+def _generated_marker_preexisting(file_path, hunks, repo_root):
+    """True when the file's head carries a generated-code marker on a line
+    this change leaves untouched. A marker on an added line never counts."""
+    head_context, head_added = [], []
+    covered = False
+    for hunk in hunks:
+        m = _HUNK_START_RE.match(hunk[0])
+        if not m:
+            continue
+        old_no, new_no = int(m.group(1)), int(m.group(2))
+        if old_no > _GENERATED_HEAD_LINES and new_no > _GENERATED_HEAD_LINES:
+            break
+        covered = True
+        for line in hunk[1:]:
+            tag, text = line[:1], line[1:]
+            if tag == " " and old_no <= _GENERATED_HEAD_LINES and new_no <= _GENERATED_HEAD_LINES:
+                head_context.append(text)
+            elif tag == "+" and new_no <= _GENERATED_HEAD_LINES:
+                head_added.append(text)
+            if tag in (" ", "-"):
+                old_no += 1
+            if tag in (" ", "+"):
+                new_no += 1
+    if covered:
+        # A pure addition (new file) has no context lines — never generated
+        # here; neither is a file whose marker the change itself writes.
+        if any(_GENERATED_MARKER_RE.search(t) for t in head_added):
+            return False
+        return any(_GENERATED_MARKER_RE.search(t) for t in head_context)
+    # No hunk touches the head, so the head is identical on both sides and
+    # the working-tree copy can stand in for it.
+    if not repo_root:
+        return False
+    try:
+        with open(os.path.join(repo_root, file_path), "rb") as f:
+            head = f.read(4096).decode("utf-8", "replace").split("\n")
+    except OSError:
+        return False
+    return any(_GENERATED_MARKER_RE.search(t)
+               for t in head[:_GENERATED_HEAD_LINES])
+
+
+def normalize_diff_files(diff_files, repo_root=None):
+    """Return (diff_files, bytes_saved) with whitespace-only hunks dropped,
+    moved blocks collapsed and pre-existing generated files removed.
+
+    Files left with no hunks are dropped, so a whitespace-only commit comes
+    back empty and callers take their usual no-reviewable-files path.
+    bytes_saved is the content size removed, for the `diff_normalized`
+    metric.
+    """
+    if not DIFF_NORMALIZE_ENABLED or not diff_files:
+        return diff_files, 0
+
+    parsed = []
+    for file_path, content in diff_files:
+        hunks = _split_hunks(content)
+        if _generated_marker_preexisting(file_path, hunks, repo_root):
+            debug_log(f"diff normalize: {file_path} is generated, dropped")
+            continue
+        keep_indent = _indent_sensitive(file_path)
+        hunks = [h for h in hunks if not _whitespace_only_hunk(h, keep_indent)]
+        if hunks:
+            parsed.append((file_path, hunks))
+
+    # Moved blocks: index every removed run long enough to matter by its
+    # exact text (indentation included — re-indented code is not a pure
+    # move), then collapse added runs that match one.
+    removed_at = {}
+    for fi, (file_path, hunks) in enumerate(parsed):
+        for hi, start, end in _runs(hunks, "-"):
+            if end - start >= MOVE_MIN_LINES:
+                key = tuple(l[1:].rstrip() for l in hunks[hi][start:end])
+                removed_at.setdefault(key, (fi, hi, start, end))
+    collapse = {}
+    if removed_at:
+        for fi, (file_path, hunks) in enumerate(parsed):
+            for hi, start, end in _runs(hunks, "+"):
+                if end - start < MOVE_MIN_LINES:
+                    continue
+                key = tuple(l[1:].rstrip() for l in hunks[hi][start:end])
+                src = removed_at.get(key)
+                if src is None:
+                    continue
+                src_fi, src_hi, src_start, src_end = src
+                src_path = parsed[src_fi][0]
+                dst_path = parsed[fi][0]
+                n = end - start
+                collapse[(fi, hi, start)] = (
+                    end, f"+... [moved by security-guidance: {n}-line block, unchanged, from {src_path}]")
+                collapse.setdefault((src_fi, src_hi, src_start), (
+                    src_end, f"-... [moved by security-guidance: {n}-line block, unchanged, to {dst_path}]"))
+
+    out = []
+    for fi, (file_path, hunks) in enumerate(parsed):
+        lines = []
+        for hi, hunk in enumerate(hunks):
+            li = 0
+            while li < len(hunk):
+                hit = collapse.get((fi, hi, li))
+                if hit is None:
+                    lines.append(hunk[li])
+                    li += 1
+                    continue
+                end, marker = hit
+                lines.extend((hunk[li], marker, hunk[end - 1]))
+                li = end
+        out.append((file_path, "\n".join(lines)))
+
+    saved = sum(len(c) for _, c in diff_files) - sum(len(c) for _, c in out)
+    if saved > 0:
+        debug_log(f"diff normalize: {len(diff_files)} -> {len(out)} files, "
+                  f"{saved} bytes saved")
+    return out, max(saved, 0)
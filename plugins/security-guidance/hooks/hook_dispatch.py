@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+"""Merged hook dispatch: one interpreter for every plugin hooked on an event.
+
+This file and dispatch.sh, the leader's shim, live only in
+security-guidance; other plugins join through a follower shim (hookify's
+dispatch-follower.sh). The protocol is documented in plugins/README.md
+under "Merged Hook Dispatch"; bump PROTOCOL here and in every shim together
+when it changes.
+
+Claude Code still spawns each plugin's hook command, but those commands are
+the shims. For one tool call, each shim registers its plugin in the
+dispatch directory, and security-guidance's claims the leader file and
+execs this script under its own runner. The leader parses the hook input
+once, then for each registered plugin imports the plugin's entry script and
+calls its dispatch(ctx) with a shared HookContext. It merges the results
+into the one response Claude Code reads. Followers it claims exit without
+starting Python.
+
+A plugin whose entry can't be imported or speaks another protocol version
+runs as its own subprocess instead, so its rules are never dropped. One
+whose dispatch() raises is not re-run: it may already have saved state or
+counted the edit, and a second run would repeat that.
+"""
+
+import contextlib
+import importlib.util
+import json
+import os
+import random
+import re
+import subprocess
+import sys
+import time
+
+PROTOCOL = "2"
+
+# Call files older than this are removed now and then by a leader.
+STALE_SECS = 600
+
+
+class HookContext:
+    """Hook input parsed once and the fields every rule set reads."""
+
+    def __init__(self, input_data, raw_input):
+        self.input = input_data
+        self.raw = raw_input
+        self.event = input_data.get("hook_event_name", "")
+        self.session_id = input_data.get("session_id", "default")
+        self.cwd = input_data.get("cwd")
+        self.tool_name = input_data.get("tool_name", "")
+        tool_input = input_data.get("tool_input")
+        self.tool_input = tool_input if isinstance(tool_input, dict) else {}
+        self.file_path = self.tool_input.get("file_path") or self.tool_input.get("notebook_path") or ""
+        self._new_content = None
+
+    @property
+    def new_content(self):
+        """Text the edit introduced: Write content, Edit new_string, or the
+        MultiEdit new_strings joined with spaces. Empty for other tools."""
+        if self._new_content is None:
+            ti = self.tool_input
+            if self.tool_name == "Write":
+                content = ti.get("content", "")
+            elif self.tool_name == "Edit":
+                content = ti.get("new_string", "")
+            elif self.tool_name == "MultiEdit":
+                content = " ".join(e.get("new_string", "") for e in ti.get("edits", []) or [])
+            else:
+                content = ""
+            self._new_content = content if isinstance(content, str) else ""
+        return self._new_content
+
+
+def _registrations(d, call_id):
+    """{plugin: fields} for every shim that has checked in for this call.
+
+    Registration lines are "<protocol>\\t<plugin root>\\t<entry>\\t<runner...>\\n";
+    one without its newline is still being written and is skipped (its shim
+    then finds the done file and runs itself).
+    """
+    prefix = call_id + "."
+    found = {}
+    for name in os.listdir(d):
+        if not name.startswith(prefix):
+            continue
+        plugin = name[len(prefix):]
+        if "." in plugin:
+            continue  # .leader / .done / <plugin>.claim
+        try:
+            with open(os.path.join(d, name)) as f:
+                line = f.read()
+        except OSError:
+            continue
+        if line.endswith("\n"):
+            found[plugin] = line[:-1].split("\t")
+    return found
+
+
+def _claim(d, call_id, plugin):
+    try:
+        os.close(os.open(os.path.join(d, f"{call_id}.{plugin}.claim"),
+                         os.O_CREAT | os.O_EXCL | os.O_WRONLY, 0o600))
+        return True
+    except OSError:
+        return False
+
+
+def _run_subprocess(root, entry, runner, ctx):
+    """The plugin's own hook command, fed the same input."""
+    env = dict(os.environ, CLAUDE_PLUGIN_ROOT=root)
+    try:
+        proc = subprocess.run(runner + [os.path.join(root, "hooks", entry)],
+                              input=ctx.raw, capture_output=True, text=True, env=env)
+    except OSError:
+        return None
+    if proc.stderr:
+        sys.stderr.write(proc.stderr)
+    result = None
+    for line in proc.stdout.splitlines():
+        try:
+            line_result = json.loads(line)
+        except ValueError:
+            continue
+        if isinstance(line_result, dict):
+            result = merge([result, line_result])
+    return result
+
+
+class _LoadError(Exception):
+    """The entry script couldn't be imported or has no dispatch(); nothing
+    of the plugin has run, so its own hook command can still run it."""
+
+
+def _run_in_process(plugin, root, entry, ctx):
+    """Import the plugin's entry script and call its dispatch(ctx).
+
+    Raises _LoadError on import failure or a missing dispatch(), and
+    whatever dispatch() raises; returns None when the plugin's
+    DISPATCH_MATCHER excludes this tool.
+    """
+    hooks_dir = os.path.join(root, "hooks")
+    module_name = "_dispatch_" + re.sub(r"\W", "_", plugin)
+    # Entry scripts locate their own modules through CLAUDE_PLUGIN_ROOT or
+    # their directory, as they do when run as the hook command.
+    previous_root = os.environ.get("CLAUDE_PLUGIN_ROOT")
+    os.environ["CLAUDE_PLUGIN_ROOT"] = root
+    if hooks_dir not in sys.path:
+        sys.path.insert(0, hooks_dir)
+    try:
+        try:
+            spec = importlib.util.spec_from_file_location(module_name, os.path.join(hooks_dir, entry))
+            module = importlib.util.module_from_spec(spec)
+            sys.modules[module_name] = module
+            # stdout is the merged response; an entry that reports its own
+            # import error there (then exits) would corrupt it.
+            with contextlib.redirect_stdout(sys.stderr):
+                spec.loader.exec_module(module)
+            dispatch = module.dispatch
+        except (Exception, SystemExit) as e:
+            raise _LoadError(repr(e)) from e
+        matcher = getattr(module, "DISPATCH_MATCHER", None)
+        if matcher and not re.fullmatch(matcher, ctx.tool_name):
+            return None
+        return dispatch(ctx)
+    finally:
+        if previous_root is None:
+            os.environ.pop("CLAUDE_PLUGIN_ROOT", None)
+        else:
+            os.environ["CLAUDE_PLUGIN_ROOT"] = previous_root
+
+
+def run_plugin(plugin, fields, ctx):
+    version, root, entry, runner = fields[0], fields[1], fields[2], fields[3:]
+    if version == PROTOCOL:
+        try:
+            return _run_in_process(plugin, root, entry, ctx)
+        except _LoadError as e:
+            print(f"hook dispatch: can't load {plugin} ({e}); running it directly",
+                  file=sys.stderr)
+        except (Exception, SystemExit) as e:
+            print(f"hook dispatch: {plugin} failed in-process ({e!r})", file=sys.stderr)
+            return None
+    return _run_subprocess(root, entry, runner, ctx)
+
+
+def merge(outputs):
+    """Fold several hook responses into one.
+
+    Messages and additionalContext are concatenated, a block or deny from one
+    wins, and metrics dicts are unioned; other keys keep the first one's
+    value.
+    """
+    merged = {}
+    for out in outputs:
+        if not out:
+            continue
+        for key, value in out.items():
+            if key == "hookSpecificOutput" and isinstance(value, dict):
+                specific = merged.setdefault(key, {})
+                for k, v in value.items():
+                    if k == "additionalContext" and specific.get(k):
+                        specific[k] += "\n\n" + v
+                    elif k == "permissionDecision" and v == "deny":
+                        specific[k] = v
+                    else:
+                        specific.setdefault(k, v)
+            elif key in ("systemMessage", "reason", "stopReason") and merged.get(key):
+                merged[key] += "\n\n" + value
+            elif key == "metrics" and isinstance(value, dict):
+                merged.setdefault(key, {}).update(value)
+            elif key == "decision" and value == "block":
+                merged[key] = value
+            elif key == "continue":
+                merged[key] = merged.get(key, True) and value
+            else:
+                merged.setdefault(key, value)
+    return merged
+
+
+def _sweep(d):
+    cutoff = time.time() - STALE_SECS
+    for name in os.listdir(d):
+        path = os.path.join(d, name)
+        try:
+            if os.path.getmtime(path) < cutoff:
+                os.unlink(path)
+        except OSError:
+            pass
+
+
+def main():
+    d, call_id, leader = sys.argv[1], sys.argv[2], sys.argv[3]
+    raw_input = sys.stdin.read()
+    try:
+        input_data = json.loads(raw_input)
+    except ValueError:
+        input_data = {}
+    ctx = HookContext(input_data if isinstance(input_data, dict) else {}, raw_input)
+
+    outputs = []
+    # Scan, publish done, scan once more: a shim that registered before the
+    # done file existed is picked up by the second scan, and one that sees
+    # the done file races us for its claim and runs itself if it wins.
+    for final in (False, True):
+        if final:
+            with open(os.path.join(d, f"{call_id}.done"), "w"):
+                pass
+        for plugin, fields in sorted(_registrations(d, call_id).items()):
+            if len(fields) >= 3 and _claim(d, call_id, plugin):
+                out = run_plugin(plugin, fields, ctx)
+                # Claude Code records a response's metrics as the printing
+                # hook's, and only the leader's hook prints; a follower's
+                # would be counted as the leader's.
+                if out and plugin != leader:
+                    out = {k: v for k, v in out.items() if k != "metrics"}
+                outputs.append(out)
+
+    print(json.dumps(merge(outputs)), flush=True)
+    if random.random() < 0.05:
+        _sweep(d)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
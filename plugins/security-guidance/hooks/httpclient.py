@@ -0,0 +1,328 @@
+"""
+Keep-alive HTTP client for the security-guidance LLM calls.
+
+``urllib.request.urlopen`` opens (and TLS-handshakes) a new connection for
+every request. One Stop review can make the reachability probe, several
+retries, two dual-OR legs and the agentic investigate/refute calls, all to
+the same host. Behind a corporate proxy every handshake costs hundreds of
+milliseconds. This module keeps finished connections in a small
+process-wide pool keyed by (scheme, host, port, proxy), so later requests to
+the same endpoint reuse an open socket. Concurrent requests (the two dual-OR
+legs) each check out their own connection and both return to the pool.
+
+``request()`` mirrors the urlopen error contract the callers already handle:
+HTTP status >= 400 raises ``urllib.error.HTTPError`` (with a readable body)
+and connection failures raise ``urllib.error.URLError``.
+
+Proxies come from the same environment lookup urllib uses (HTTPS_PROXY /
+NO_PROXY, re-read per request so a NO_PROXY scrub takes effect). HTTPS goes
+through a CONNECT tunnel. Setups this pool doesn't model (a non-http proxy
+scheme, plain-http targets through a proxy) fall back to urlopen, as does
+SG_HTTP_KEEPALIVE=0.
+
+Stdlib only: HTTP/2 multiplexing would need a third-party client, so each
+concurrent request uses its own HTTP/1.1 connection.
+"""
+import atexit
+import base64
+import contextlib
+import http.client
+import io
+import os
+import socket
+import ssl
+import threading
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+from typing import Dict, List, Optional, Tuple
+
+from _base import debug_log
+
+# Idle connections kept per endpoint. Two covers the dual-OR legs.
+MAX_IDLE_PER_KEY = 4
+# Servers commonly drop idle keep-alive sockets after ~60s; don't bother
+# reusing anything older than this (a stale socket is retried anyway).
+IDLE_TTL_SEC = 50.0
+
+_lock = threading.Lock()
+_idle: Dict[tuple, List[Tuple[http.client.HTTPConnection, float]]] = {}
+_ssl_context: Optional[ssl.SSLContext] = None
+
+# Errors that mean a reused socket was already closed by the peer before it
+# saw our request; one transparent retry on a fresh connection is safe.
+_STALE_ERRORS = (http.client.RemoteDisconnected, http.client.BadStatusLine,
+                 ConnectionResetError, BrokenPipeError, ConnectionAbortedError)
+
+
+class CancelToken:
+    """Cooperative cancellation for in-flight work on another thread.
+
+    cancel() runs every registered callback once; callbacks registered after
+    cancellation run immediately. request()/stream() register their socket
+    so cancel() shuts it down and the blocked read fails at once.
+    """
+
+    def __init__(self):
+        self._event = threading.Event()
+        self._lock = threading.Lock()
+        self._callbacks: Dict[int, object] = {}
+        self._next = 0
+
+    def cancelled(self) -> bool:
+        return self._event.is_set()
+
+    def wait(self, timeout: float) -> bool:
+        """Sleep up to timeout; True if cancelled meanwhile."""
+        return self._event.wait(timeout)
+
+    def on_cancel(self, callback) -> Optional[int]:
+        with self._lock:
+            if not self._event.is_set():
+                self._next += 1
+                self._callbacks[self._next] = callback
+                return self._next
+        callback()
+        return None
+
+    def discard(self, handle: Optional[int]) -> None:
+        if handle is not None:
+            with self._lock:
+                self._callbacks.pop(handle, None)
+
+    def cancel(self) -> None:
+        with self._lock:
+            if self._event.is_set():
+                return
+            self._event.set()
+            callbacks = list(self._callbacks.values())
+            self._callbacks.clear()
+        for callback in callbacks:
+            try:
+                callback()
+            except Exception as e:
+                debug_log(f"cancel callback failed: {e}")
+
+
+def _shutdown(conn: http.client.HTTPConnection) -> None:
+    sock = conn.sock
+    if sock is not None:
+        try:
+            sock.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+
+
+def keepalive_enabled() -> bool:
+    return os.environ.get("SG_HTTP_KEEPALIVE", "1") != "0"
+
+
+def _context() -> ssl.SSLContext:
+    global _ssl_context
+    if _ssl_context is None:
+        _ssl_context = ssl.create_default_context()
+    return _ssl_context
+
+
+def _proxy_for(scheme: str, host: str) -> Optional[str]:
+    if urllib.request.proxy_bypass(host):
+        return None
+    return urllib.request.getproxies().get(scheme)
+
+
+def _route(url: str):
+    """(pool key, request target) for url, or None to fall back to urlopen."""
+    parts = urllib.parse.urlsplit(url)
+    scheme = parts.scheme.lower()
+    if scheme not in ("http", "https") or not parts.hostname:
+        return None
+    port = parts.port or (443 if scheme == "https" else 80)
+    proxy = _proxy_for(scheme, parts.hostname)
+    if proxy:
+        p = urllib.parse.urlsplit(proxy if "://" in proxy else "http://" + proxy)
+        if scheme != "https" or p.scheme.lower() != "http" or not p.hostname:
+            return None
+        proxy = (p.hostname, p.port or 80, p.username, p.password)
+    target = parts.path or "/"
+    if parts.query:
+        target += "?" + parts.query
+    return (scheme, parts.hostname, port, proxy), target
+
+
+def _connect(key: tuple, timeout: float) -> http.client.HTTPConnection:
+    scheme, host, port, proxy = key
+    if scheme == "http":
+        return http.client.HTTPConnection(host, port, timeout=timeout)
+    if not proxy:
+        return http.client.HTTPSConnection(host, port, timeout=timeout, context=_context())
+    p_host, p_port, user, password = proxy
+    conn = http.client.HTTPSConnection(p_host, p_port, timeout=timeout, context=_context())
+    tunnel_headers = {}
+    if user is not None:
+        cred = f"{urllib.parse.unquote(user)}:{urllib.parse.unquote(password or '')}"
+        tunnel_headers["Proxy-Authorization"] = "Basic " + base64.b64encode(cred.encode()).decode()
+    conn.set_tunnel(host, port, headers=tunnel_headers)
+    return conn
+
+
+def _checkout(key: tuple, timeout: float) -> Tuple[http.client.HTTPConnection, bool]:
+    """(connection, reused) — an idle pooled connection if one is fresh."""
+    now = time.monotonic()
+    with _lock:
+        pool = _idle.get(key, [])
+        while pool:
+            conn, since = pool.pop()
+            if now - since <= IDLE_TTL_SEC and conn.sock is not None:
+                conn.sock.settimeout(timeout)
+                conn.timeout = timeout
+                return conn, True
+            conn.close()
+    return _connect(key, timeout), False
+
+
+def _checkin(key: tuple, conn: http.client.HTTPConnection) -> None:
+    with _lock:
+        pool = _idle.setdefault(key, [])
+        if len(pool) < MAX_IDLE_PER_KEY:
+            pool.append((conn, time.monotonic()))
+            return
+    conn.close()
+
+
+def close_all() -> None:
+    with _lock:
+        pools = list(_idle.values())
+        _idle.clear()
+    for pool in pools:
+        for conn, _ in pool:
+            conn.close()
+
+
+atexit.register(close_all)
+
+
+def _cancelled_error() -> urllib.error.URLError:
+    return urllib.error.URLError("cancelled")
+
+
+def _send(method: str, url: str, body: Optional[bytes], headers: Dict[str, str],
+          timeout: float, cancel: Optional[CancelToken] = None):
+    """Send a request and return (pool key or None, connection or None,
+    response, cancel handle).
+
+    Response headers have been read; the body has not. A None key means the
+    urlopen fallback served it (not cancellable mid-flight). Raises HTTPError
+    (body read) for status >= 400 and URLError("cancelled") once cancelled.
+    """
+    if cancel is not None and cancel.cancelled():
+        raise _cancelled_error()
+    route = _route(url) if keepalive_enabled() else None
+    if route is None:
+        req = urllib.request.Request(url, data=body, headers=headers, method=method)
+        return None, None, urllib.request.urlopen(req, timeout=timeout), None
+    key, target = route
+
+    for attempt in range(2):
+        conn, reused = _checkout(key, timeout)
+        handle = cancel.on_cancel(lambda c=conn: _shutdown(c)) if cancel is not None else None
+        try:
+            conn.request(method, target, body=body, headers=headers)
+            response = conn.getresponse()
+            if response.status >= 400:
+                data = response.read()
+        except _STALE_ERRORS as e:
+            conn.close()
+            if cancel is not None:
+                cancel.discard(handle)
+                if cancel.cancelled():
+                    raise _cancelled_error()
+            if reused and attempt == 0:
+                debug_log(f"http: pooled connection to {key[1]} was closed ({type(e).__name__}), reconnecting")
+                continue
+            raise urllib.error.URLError(e)
+        except (OSError, http.client.HTTPException) as e:
+            conn.close()
+            if cancel is not None:
+                cancel.discard(handle)
+                if cancel.cancelled():
+                    raise _cancelled_error()
+            if isinstance(e, TimeoutError):
+                raise
+            raise urllib.error.URLError(e)
+
+        if response.status >= 400:
+            _release(key, conn, response, cancel, handle)
+            raise urllib.error.HTTPError(url, response.status, response.reason,
+                                         response.headers, io.BytesIO(data))
+        return key, conn, response, handle
+    raise urllib.error.URLError("unreachable")  # loop always returns or raises
+
+
+def _release(key: Optional[tuple], conn, response,
+             cancel: Optional[CancelToken] = None, handle: Optional[int] = None) -> None:
+    """Return conn to the pool if its response was fully consumed."""
+    if cancel is not None:
+        cancel.discard(handle)
+        if cancel.cancelled() and conn is not None:
+            conn.close()
+            return
+    if key is None:
+        response.close()
+    elif response.isclosed() and not response.will_close:
+        _checkin(key, conn)
+    else:
+        conn.close()
+
+
+def request(method: str, url: str, body: Optional[bytes] = None,
+            headers: Optional[Dict[str, str]] = None, timeout: float = 120,
+            cancel: Optional[CancelToken] = None) -> Tuple[int, bytes]:
+    """Send one request and return (status, body).
+
+    Raises urllib.error.HTTPError for status >= 400 and URLError for
+    connection / protocol failures (TimeoutError for timeouts), like urlopen.
+    cancel.cancel() from another thread aborts it with URLError("cancelled").
+    """
+    key, conn, response, handle = _send(method, url, body, dict(headers or {}), timeout, cancel)
+    try:
+        data = response.read()
+    except (OSError, http.client.HTTPException) as e:
+        if conn is not None:
+            conn.close()
+        if cancel is not None:
+            cancel.discard(handle)
+            if cancel.cancelled():
+                raise _cancelled_error()
+        if isinstance(e, TimeoutError):
+            raise
+        raise urllib.error.URLError(e)
+    _release(key, conn, response, cancel, handle)
+    if cancel is not None and cancel.cancelled():
+        raise _cancelled_error()
+    return response.status, data
+
+
+@contextlib.contextmanager
+def stream(method: str, url: str, body: Optional[bytes] = None,
+           headers: Optional[Dict[str, str]] = None, timeout: float = 120,
+           cancel: Optional[CancelToken] = None):
+    """Like request(), but yields the response before its body is read.
+
+    The caller reads incrementally (readline) and may stop at any point; an
+    abandoned body means the connection can't be reused, so it is closed.
+    Read failures inside the block surface as URLError, like request().
+    """
+    key, conn, response, handle = _send(method, url, body, dict(headers or {}), timeout, cancel)
+    try:
+        yield response
+    except (urllib.error.URLError, TimeoutError):
+        if cancel is not None and cancel.cancelled():
+            raise _cancelled_error()
+        raise
+    except (OSError, http.client.HTTPException) as e:
+        if cancel is not None and cancel.cancelled():
+            raise _cancelled_error()
+        raise urllib.error.URLError(e)
+    finally:
+        _release(key, conn, response, cancel, handle)
@@ -12,22 +12,27 @@ module (e.g. patch ``_call_claude`` then call ``analyze_code_security``) must
 patch on ``llm`` rather than ``hook``: bare-name lookups in the function bodies
 below resolve in this module's globals.
 
-Two reassignable globals here are read by handlers in
+Reassignable globals here are read by handlers in
 ``security_reminder_hook``: ``_last_call_claude_http_error`` and
-``_last_review_truncated_bytes``. Handlers reference them as ``llm.X`` (not via
-``from``-import) so they observe reassignment.
+``_last_review_truncated_bytes``. Handlers reference them as ``llm.X`` (not
+via ``from``-import) so they observe reassignment.
 """
 import glob
 import json
 import os
 import re
 import sys
-import urllib.request
+import threading
+import time
+import urllib.error
 from typing import Optional, Tuple, Dict, Any, List
 
 import extensibility
+import httpclient
 import review_api
-from _base import debug_log, _record_usage, _PV, PROVENANCE_TAG  # noqa: F401
+import review_cache
+import streaming
+from _base import debug_log, _record_usage, _PV, PROVENANCE_TAG, review_stage, record_stage  # noqa: F401
 from session_state import with_locked_state
 
 
@@ -74,6 +79,26 @@ CLAUDE_CODE_SYSTEM_PROMPT = "You are a Claude agent, built on Anthropic's Claude
 # each call. None = no error; int = HTTP status code; -1 = network/timeout;
 _last_call_claude_http_error = None
 
+# Per-thread details of the last call: http_error (as above) and, after
+# _call_claude_dual_or, the model(s) whose answer it returned. Shards and
+# dual_or legs call concurrently, so one thread's success must not clear
+# another's failure; the global above is only for single-threaded readers.
+_call_state = threading.local()
+
+
+def _set_call_error(code):
+    global _last_call_claude_http_error
+    _last_call_claude_http_error = code
+    _call_state.http_error = code
+
+
+def _thread_call_error():
+    return getattr(_call_state, "http_error", None)
+
+# The model a failed primary review call falls back to (not used when
+# SECURITY_REVIEW_MODEL pins the model).
+FALLBACK_REVIEW_MODEL = "claude-sonnet-4-6"
+
 
 # =====================================================================
 # Outbound connectivity probe
@@ -100,10 +125,11 @@ def _anthropic_base_url() -> str:
 
 
 def _probe_anthropic(timeout: float = 5.0) -> bool:
-    req = urllib.request.Request(_anthropic_base_url() + "/", method="HEAD")
+    # Through the keep-alive pool, so a successful probe leaves a warm
+    # connection for the first review call.
     try:
-        with urllib.request.urlopen(req, timeout=timeout):
-            return True
+        httpclient.request("HEAD", _anthropic_base_url() + "/", timeout=timeout)
+        return True
     except urllib.error.HTTPError:
         return True  # got a status code → connected
     except (urllib.error.URLError, TimeoutError, OSError):
@@ -119,25 +145,75 @@ def _strip_anthropic_from_no_proxy() -> None:
             )
 
 
-def ensure_anthropic_reachable() -> bool:
+# Each hook fire is a new process, so the probe outcome is also kept in
+# session state ("reachability": {"base", "outcome", "ts"}). "direct" and
+# "scrub" (reachable once NO_PROXY is scrubbed) are trusted for the session;
+# "dead" is re-probed after REACHABILITY_DEAD_TTL_SEC so a transient outage
+# doesn't disable reviews for the rest of it.
+REACHABILITY_DEAD_TTL_SEC = 300
+
+
+def _cached_reachability(session_id: Optional[str]) -> Optional[str]:
+    if not session_id:
+        return None
+    try:
+        entry = with_locked_state(session_id, lambda s: s.get("reachability")) or {}
+    except Exception as e:
+        debug_log(f"reachability cache read failed: {e}")
+        return None
+    if not isinstance(entry, dict) or entry.get("base") != _anthropic_base_url():
+        return None
+    outcome = entry.get("outcome")
+    if outcome == "dead" and time.time() - entry.get("ts", 0) > REACHABILITY_DEAD_TTL_SEC:
+        return None
+    return outcome if outcome in ("direct", "scrub", "dead") else None
+
+
+def _record_reachability(session_id: Optional[str], outcome: str) -> None:
+    if not session_id:
+        return
+    entry = {"base": _anthropic_base_url(), "outcome": outcome, "ts": time.time()}
+
+    def _put(s):
+        s["reachability"] = entry
+        return True
+
+    try:
+        with_locked_state(session_id, _put)
+    except Exception as e:
+        debug_log(f"reachability cache write failed: {e}")
+
+
+def ensure_anthropic_reachable(session_id: Optional[str] = None) -> bool:
     """Run once. Under a remote/proxied environment, probe api.anthropic.com;
     if blackholed, scrub NO_PROXY and re-probe. Returns True if reachable
     (or not in a remote env), False if still dead. Gated on
-    CLAUDE_CODE_REMOTE so local installs never pay the probe cost."""
+    CLAUDE_CODE_REMOTE so local installs never pay the probe cost.
+    With a session_id, a previous fire's outcome is reused instead of
+    probing again."""
     global _anthropic_reachable
     if _anthropic_reachable is not None:
         return _anthropic_reachable
     if os.environ.get("CLAUDE_CODE_REMOTE", "").lower() not in ("1", "true", "yes", "on"):
         _anthropic_reachable = True
         return True
+    cached = _cached_reachability(session_id)
+    if cached is not None:
+        debug_log(f"Remote env: reachability from session cache: {cached}")
+        if cached == "scrub":
+            _strip_anthropic_from_no_proxy()
+        _anthropic_reachable = cached != "dead"
+        return _anthropic_reachable
     if _probe_anthropic():
         _anthropic_reachable = True
+        _record_reachability(session_id, "direct")
         return True
     debug_log("Remote env: api.anthropic.com unreachable, stripping anthropic.com from NO_PROXY")
     _strip_anthropic_from_no_proxy()
     _anthropic_reachable = _probe_anthropic()
     if not _anthropic_reachable:
         debug_log("Remote env: api.anthropic.com still unreachable after NO_PROXY scrub")
+    _record_reachability(session_id, "scrub" if _anthropic_reachable else "dead")
     return _anthropic_reachable
 
 
@@ -279,8 +355,7 @@ def _call_claude_via_sdk(prompt, output_schema, *, max_tokens=16000, model=None)
     No tools (`allowed_tools=[]`) — the security review only needs structured
     output, not Read/Grep/Glob. Single turn keeps cost predictable.
     """
-    global _last_call_claude_http_error
-    _last_call_claude_http_error = None
+    _set_call_error(None)
 
     try:
         import asyncio as _asyncio
@@ -314,7 +389,7 @@ def _call_claude_via_sdk(prompt, output_schema, *, max_tokens=16000, model=None)
             )
         except Exception as e:
             debug_log(f"3P sdk-single-turn: SDK unavailable ({e})")
-            _last_call_claude_http_error = -1
+            _set_call_error(-1)
             return None
 
     cli_path = os.environ.get("SG_AGENTIC_CLI_PATH") or None
@@ -371,7 +446,7 @@ def _call_claude_via_sdk(prompt, output_schema, *, max_tokens=16000, model=None)
         return result
     except _asyncio.TimeoutError:
         debug_log("3P sdk-single-turn: timeout after 60s")
-        _last_call_claude_http_error = -1
+        _set_call_error(-1)
         return None
     except Exception as e:
         debug_log(f"3P sdk-single-turn: query failed ({e})")
@@ -379,12 +454,29 @@ def _call_claude_via_sdk(prompt, output_schema, *, max_tokens=16000, model=None)
             debug_log(f"3P sdk-single-turn child stderr ({len(_captured_stderr)} lines):")
             for _l in _captured_stderr[:20]:
                 debug_log(f"  | {_l.rstrip()}")
-        _last_call_claude_http_error = -1
+        _set_call_error(-1)
         return None
 
 
+def _stream_enabled() -> bool:
+    """SSE streaming for /v1/messages (SG_STREAM_REVIEW=0 to disable).
+
+    A gateway that ignores "stream" and answers with plain JSON is handled
+    by _call_claude, so this only needs turning off for one that breaks on it.
+    """
+    return os.environ.get("SG_STREAM_REVIEW", "1") != "0"
+
+
+def _backoff(seconds, cancel):
+    """Retry sleep; True (stop retrying) if cancel fired meanwhile."""
+    if cancel is None:
+        time.sleep(seconds)
+        return False
+    return cancel.wait(seconds)
+
+
 def _call_claude(prompt, output_schema, thinking_budget=10000, max_tokens=16000, model=None,
-                 retry_5xx=True):
+                 retry_5xx=True, stream_keys=None, on_item=None, cancel=None):
     """
     Call the configured LLM model with extended thinking and structured outputs.
     Model defaults to Sonnet 4.6 but can be overridden via SECURITY_REVIEW_MODEL env var.
@@ -397,9 +489,35 @@ def _call_claude(prompt, output_schema, thinking_budget=10000, max_tokens=16000,
     chain can fall through fast instead of paying ~6s of backoff before trying
     the next model. 429 still retries regardless — that's a per-key throttle a
     different model won't help with.
+
+    stream_keys=(bool_key, list_key): stream the response and parse the
+    structured output as it arrives — on_item(finding) fires as each element
+    of list_key completes, and a clean result (bool_key false, list_key
+    empty) returns without waiting for the rest of the stream.
+
+    cancel (httpclient.CancelToken): cancel() from another thread aborts the
+    in-flight request and any retry backoff; the call then returns None
+    without recording an HTTP error (the result is being discarded anyway).
+    Raw-HTTP path only — the 3P SDK subprocess runs to completion.
+
+    Each call is recorded as an "llm_call" review stage (wall time including
+    retries, tokens, outcome).
     """
-    global _last_call_claude_http_error
-    _last_call_claude_http_error = None
+    with review_stage("llm_call", model=model or SECURITY_REVIEW_MODEL) as rec:
+        result = _call_claude_once(prompt, output_schema, thinking_budget, max_tokens, model,
+                                   retry_5xx, stream_keys, on_item, cancel)
+        rec["ok"] = result is not None
+        if cancel is not None and cancel.cancelled():
+            rec["cancelled"] = True
+        elif _thread_call_error() is not None:
+            rec["error"] = _thread_call_error()
+        return result
+
+
+def _call_claude_once(prompt, output_schema, thinking_budget, max_tokens, model,
+                      retry_5xx, stream_keys, on_item, cancel):
+    """Body of _call_claude (one model, with its retries)."""
+    _set_call_error(None)
 
     if _is_3p_provider():
         # On Bedrock/Vertex/Foundry/Mantle the api.anthropic.com path below
@@ -415,7 +533,6 @@ def _call_claude(prompt, output_schema, thinking_budget=10000, max_tokens=16000,
         return None
 
     global _auth_prefer_token
-    import time as _time
 
     api_url = _anthropic_base_url() + "/v1/messages"
     use_token = _auth_prefer_token or not ANTHROPIC_API_KEY
@@ -444,22 +561,41 @@ def _call_claude(prompt, output_schema, thinking_budget=10000, max_tokens=16000,
                 "budget_tokens": thinking_budget,
             }
 
+    use_stream = bool(stream_keys) and _stream_enabled()
+    if use_stream:
+        payload["stream"] = True
+
     response_data = None
     for attempt in range(3):
         try:
-            request = urllib.request.Request(
-                api_url,
-                data=json.dumps(payload).encode("utf-8"),
-                headers=headers,
-                method="POST",
-            )
-            with urllib.request.urlopen(request, timeout=120) as response:
-                response_body = response.read().decode("utf-8")
-                response_data = json.loads(response_body)
+            if use_stream:
+                with httpclient.stream(
+                    "POST", api_url,
+                    body=json.dumps(payload).encode("utf-8"),
+                    headers=headers,
+                    timeout=120,
+                    cancel=cancel,
+                ) as response:
+                    if "text/event-stream" in (response.headers.get("Content-Type") or ""):
+                        response_data = streaming.read_message(
+                            response, api_url, *stream_keys, on_item=on_item)
+                    else:
+                        response_data = json.loads(response.read().decode("utf-8"))
+            else:
+                _, response_body = httpclient.request(
+                    "POST", api_url,
+                    body=json.dumps(payload).encode("utf-8"),
+                    headers=headers,
+                    timeout=120,
+                    cancel=cancel,
+                )
+                response_data = json.loads(response_body.decode("utf-8"))
             _record_usage(response_data.get("usage") or {},
                           response_data.get("model") or payload["model"])
             break
         except urllib.error.HTTPError as e:
+            if cancel is not None and cancel.cancelled():
+                return None
             if e.code == 401 and not use_token and ANTHROPIC_AUTH_TOKEN:
                 debug_log("API 401 on x-api-key; falling back to ANTHROPIC_AUTH_TOKEN")
                 use_token = True
@@ -470,28 +606,33 @@ def _call_claude(prompt, output_schema, thinking_budget=10000, max_tokens=16000,
             if retryable and attempt < 2:
                 wait = (attempt + 1) * 5 if e.code == 429 else (attempt + 1) * 2
                 debug_log(f"API {e.code}, retrying in {wait}s (attempt {attempt+1})")
-                _time.sleep(wait)
+                if _backoff(wait, cancel):
+                    return None
             else:
                 error_body = e.read().decode("utf-8") if e.fp else ""
                 debug_log(f"API error: {e.code} - {error_body[:200]}")
-                _last_call_claude_http_error = e.code
+                _set_call_error(e.code)
                 return None
         except (urllib.error.URLError, TimeoutError) as e:
+            if cancel is not None and cancel.cancelled():
+                debug_log("Request cancelled")
+                return None
             if attempt < 2:
                 wait = (attempt + 1) * 3
                 debug_log(f"Request failed, retrying in {wait}s: {e}")
-                _time.sleep(wait)
+                if _backoff(wait, cancel):
+                    return None
             else:
                 debug_log(f"Request failed after retries: {e}")
-                _last_call_claude_http_error = -1
+                _set_call_error(-1)
                 return None
 
     if not response_data:
         # Only reachable when the 401→token fallback `continue` landed on the
         # final loop iteration. The sticky flag is already set so the next
         # call uses the token; record the 401 so callers don't see error=None.
-        if _last_call_claude_http_error is None:
-            _last_call_claude_http_error = 401
+        if _thread_call_error() is None:
+            _set_call_error(401)
         return None
 
     # Find the text block (skip thinking blocks)
@@ -519,7 +660,7 @@ def _dual_or_enabled() -> bool:
 
 
 def _call_claude_dual_or(prompt, output_schema, *, bool_key: str, list_key: str,
-                         thinking_budget=10000, max_tokens=16000):
+                         thinking_budget=10000, max_tokens=16000, on_item=None, cancel=None):
     """Run prompt through the model 2× in parallel and OR-merge the results.
 
     The second look samples the model again on the same prompt — independent
@@ -538,39 +679,50 @@ def _call_claude_dual_or(prompt, output_schema, *, bool_key: str, list_key: str,
     2× API cost. When disabled, short-circuits to a single _call_claude
     and wraps the result in the same {bool_key, list_key} envelope so
     callers don't need to branch.
+
+    Each call streams the response (see _call_claude stream_keys); on_item
+    fires per finding as it completes, from either leg. cancel is passed to
+    every call and suppresses the sonnet fallback once fired.
     """
     from concurrent.futures import ThreadPoolExecutor
 
     explicit = os.environ.get("SECURITY_REVIEW_MODEL", "").strip()
     primary = explicit or SECURITY_REVIEW_MODEL
 
-    if not _dual_or_enabled():
-        # Single-call path. Reuse the same sonnet-fallback retry as a dual_or
-        # leg so a 529/400 on the primary doesn't drop recall to zero.
+    def _leg(label):
+        """(result, model that produced it, this thread's call error)."""
         r = _call_claude(prompt, output_schema, thinking_budget=thinking_budget,
-                         max_tokens=max_tokens, model=primary, retry_5xx=False)
-        if r is None and not explicit:
-            debug_log(f"single: {primary} failed, falling back to sonnet")
+                         max_tokens=max_tokens, model=primary, retry_5xx=False,
+                         stream_keys=(bool_key, list_key), on_item=on_item,
+                         cancel=cancel)
+        if r is not None:
+            return r, primary, None
+        if not explicit and not (cancel and cancel.cancelled()):
+            debug_log(f"{label}: {primary} failed, falling back to sonnet")
             r = _call_claude(prompt, output_schema, thinking_budget=thinking_budget,
-                             max_tokens=max_tokens, model="claude-sonnet-4-6",
-                             retry_5xx=True)
-        return r
+                             max_tokens=max_tokens, model=FALLBACK_REVIEW_MODEL,
+                             retry_5xx=True, stream_keys=(bool_key, list_key),
+                             on_item=on_item, cancel=cancel)
+            if r is not None:
+                return r, FALLBACK_REVIEW_MODEL, None
+        return None, None, _thread_call_error()
 
-    def _leg():
-        r = _call_claude(prompt, output_schema, thinking_budget=thinking_budget,
-                         max_tokens=max_tokens, model=primary, retry_5xx=False)
-        if r is None and not explicit:
-            debug_log(f"dual_or: {primary} leg failed, falling back to sonnet")
-            r = _call_claude(prompt, output_schema, thinking_budget=thinking_budget,
-                             max_tokens=max_tokens, model="claude-sonnet-4-6",
-                             retry_5xx=True)
+    if not _dual_or_enabled():
+        # Single-call path. Reuse the same sonnet-fallback retry as a dual_or
+        # leg so a 529/400 on the primary doesn't drop recall to zero.
+        r, _call_state.model, _ = _leg("single")
         return r
 
     with ThreadPoolExecutor(max_workers=2) as ex:
-        fa = ex.submit(_leg)
-        fb = ex.submit(_leg)
-        ra, rb = fa.result(), fb.result()
-
+        fa = ex.submit(_leg, "dual_or")
+        fb = ex.submit(_leg, "dual_or")
+        (ra, ma, ea), (rb, mb, eb) = fa.result(), fb.result()
+
+    # A merge of two models' answers is recorded as "a+b", so its cache
+    # entries match neither model's lookups.
+    _call_state.model = "+".join(sorted({m for m in (ma, mb) if m})) or None
+    # The legs ran on their own threads; report for this one.
+    _set_call_error(None if ra is not None or rb is not None else (ea if ea is not None else eb))
     if ra is None and rb is None:
         return None
 
@@ -707,7 +859,34 @@ def _dedup_against_state(session_id: str, vulns: List[Dict[str, Any]],
     return kept, len(vulns) - len(kept)
 
 
-def analyze_code_security(files: List[Tuple[str, str]], is_diff: bool = False, previous_findings: Optional[List[str]] = None) -> Tuple[Optional[str], List[Dict[str, Any]]]:
+# Bump whenever the analyze_code_security prompt, output schema or severity
+# filter changes, so review_cache entries from the old prompt stop matching.
+REVIEW_PROMPT_VERSION = "1"
+
+def _review_models():
+    """Models whose cached verdicts a review can reuse, preferred first: the
+    primary, then the fallback it would be retried with."""
+    explicit = os.environ.get("SECURITY_REVIEW_MODEL", "").strip()
+    if explicit:
+        return [explicit]
+    return [SECURITY_REVIEW_MODEL, FALLBACK_REVIEW_MODEL]
+
+
+def _review_fingerprint(is_diff: bool, model: str) -> str:
+    """Everything besides the file itself that shapes a per-file verdict,
+    including the model that produced it."""
+    parts = [
+        REVIEW_PROMPT_VERSION,
+        model,
+        "diff" if is_diff else "file",
+        "dual_or" if _dual_or_enabled() else "single",
+        extensibility.guidance_block(),
+    ]
+    return "\0".join(parts)
+
+
+def analyze_code_security(files: List[Tuple[str, str]], is_diff: bool = False, previous_findings: Optional[List[str]] = None,
+                          cancel: Optional[httpclient.CancelToken] = None) -> Tuple[Optional[str], List[Dict[str, Any]]]:
     """
     Use Haiku to perform a security review of code.
     files: list of (file_path, content_or_diff) tuples
@@ -715,9 +894,77 @@ def analyze_code_security(files: List[Tuple[str, str]], is_diff: bool = False, p
     previous_findings: list of category strings from earlier stop hook firings this turn,
         used to prompt the reviewer to verify those issues were actually fixed.
     Returns (formatted guidance string or None, list of vuln dicts with severity/category).
+
+    Files whose normalized diff was already reviewed under the same
+    prompt / guidance (review_cache) are not sent again; their cached
+    findings are merged into the result, minus any the developer was already
+    shown this turn (the model is told not to re-flag unchanged code that
+    appears in previous_findings, and a cache hit means it is unchanged).
+    Entries are keyed by the model that answered; a verdict from the primary
+    model is preferred over one from its fallback.
+
+    cancel aborts the model call (see _call_claude); a cancelled review
+    caches nothing.
+    """
+    global _last_review_truncated_bytes
+    guidance, vulns, _error, _last_review_truncated_bytes = _review_files(
+        files, is_diff, previous_findings, cancel)
+    return guidance, vulns
+
+
+def _review_files(files: List[Tuple[str, str]], is_diff: bool,
+                  previous_findings: Optional[List[str]],
+                  cancel: Optional[httpclient.CancelToken]
+                  ) -> Tuple[Optional[str], List[Dict[str, Any]], Optional[int], int]:
+    """Body of analyze_code_security: (guidance, vulns, call error,
+    truncated bytes). Reports through its return value rather than module
+    globals so concurrent shards each get their own outcome. call error is
+    this thread's _call_claude error when the model call failed, else None.
     """
     if not HAS_API_CREDENTIALS or not files:
-        return None, []
+        return None, [], None, 0
+
+    structured_prev = [f for f in (previous_findings or []) if isinstance(f, dict)]
+
+    cache_enabled = review_cache.review_cache_enabled()
+    cached_vulns: List[Dict[str, Any]] = []
+    if cache_enabled:
+        # Primary model first; files it has no verdict for try the fallback.
+        found_by_file: Dict[str, List[Dict[str, Any]]] = {}
+        for model in _review_models():
+            fingerprint = _review_fingerprint(is_diff, model)
+            keys = {fp: review_cache.file_key(fingerprint, fp, content)
+                    for fp, content in files if fp not in found_by_file}
+            hits = review_cache.lookup(list(keys.values()))
+            found_by_file.update((fp, hits[k]) for fp, k in keys.items() if k in hits)
+        if found_by_file:
+            prompted = _finding_keys(structured_prev)
+            remaining = []
+            for fp, content in files:
+                found = found_by_file.get(fp)
+                if found is None:
+                    remaining.append((fp, content))
+                    continue
+                cached_vulns.extend(
+                    v for v in found
+                    if isinstance(v, dict)
+                    and (v.get("filePath", ""), v.get("category", "")) not in prompted
+                )
+            debug_log(f"LLM code review: {len(files) - len(remaining)}/{len(files)} files from review cache "
+                      f"({len(cached_vulns)} cached findings)")
+            files = remaining
+            if not files:
+                if cached_vulns:
+                    return _format_vulns_guidance(cached_vulns), cached_vulns, None, 0
+                return None, [], None, 0
+
+    error: Optional[int] = None
+
+    def _merged(vulns: List[Dict[str, Any]]):
+        vulns = list(vulns) + cached_vulns
+        if not vulns:
+            return None, [], error, truncated
+        return _format_vulns_guidance(vulns), vulns, error, truncated
 
     # Build language context from file extensions
     lang_hints = {
@@ -735,7 +982,19 @@ def analyze_code_security(files: List[Tuple[str, str]], is_diff: bool = False, p
             languages.add(lang_hints[ext])
     language = ", ".join(sorted(languages)) if languages else "server-side"
 
-    files = _cap_files_for_prompt(files)
+    uncapped = dict(files)
+    files, truncated = review_api.cap_diff_for_prompt(files)
+    # Only files the model saw in full get cached.
+    cacheable = [fp for fp, content in files if cache_enabled and uncapped.get(fp) == content]
+
+    def _store(verdicts: Dict[str, List[Dict[str, Any]]]) -> None:
+        # Keyed by the model(s) that actually answered, not the one asked.
+        model = getattr(_call_state, "model", None)
+        if not model or not verdicts:
+            return
+        fingerprint = _review_fingerprint(is_diff, model)
+        review_cache.store({review_cache.file_key(fingerprint, fp, uncapped[fp]): found
+                            for fp, found in verdicts.items()})
 
     # Build the files section
     files_section = []
@@ -764,7 +1023,6 @@ EXCEPTION — data flow to pre-existing sinks: If + lines route user-controlled
     else:
         diff_instruction = ""
 
-    structured_prev = [f for f in (previous_findings or []) if isinstance(f, dict)]
     if structured_prev:
         prev_lines = "\n".join(
             f"  - {f.get('filePath', '?')} [{f.get('category', '?')}]: {f.get('vulnerableCode', '?')}"
@@ -960,23 +1218,141 @@ Respond with a JSON object. If vulnerabilities are found, set hasVulnerabilities
     }
 
     prompt += extensibility.guidance_block()
+    # The rewake message is a single stderr payload written at exit, so
+    # streamed findings can only be logged as they arrive; the guidance is
+    # still built from the merged result below.
+    def _on_finding(v):
+        if isinstance(v, dict):
+            debug_log(f"LLM code review: streamed finding {v.get('filePath', '?')} "
+                      f"[{v.get('category', '?')}/{v.get('severity', '?')}]")
+
     analysis = _call_claude_dual_or(prompt, output_schema,
                                     bool_key="hasVulnerabilities",
-                                    list_key="vulnerabilities")
-    if not analysis or not analysis.get("hasVulnerabilities") or not analysis.get("vulnerabilities"):
+                                    list_key="vulnerabilities",
+                                    on_item=_on_finding, cancel=cancel)
+    if cancel is not None and cancel.cancelled():
+        return None, [], None, truncated
+    if not analysis:
+        error = _thread_call_error()
         debug_log("LLM code review: no vulnerabilities found")
-        return None, []
+        return _merged([])
+    if not analysis.get("hasVulnerabilities") or not analysis.get("vulnerabilities"):
+        debug_log("LLM code review: no vulnerabilities found")
+        _store({fp: [] for fp in cacheable})
+        return _merged([])
 
     vulns = analysis["vulnerabilities"]
 
     # Filter to medium/high/critical severity — low causes too many false positives
     vulns = [v for v in vulns if v.get("severity", "medium") in ("critical", "high", "medium")]
+    by_file = review_cache.attribute(vulns, [fp for fp, _ in files])
+    if by_file is not None:
+        _store({fp: by_file[fp] for fp in cacheable})
     if not vulns:
         debug_log("LLM code review: no medium+ vulnerabilities found")
-        return None, []
+        return _merged([])
 
     debug_log(f"LLM code review found {len(vulns)} high/critical vulnerabilities")
-    return _format_vulns_guidance(vulns), vulns
+    return _merged(vulns)
+
+
+def review_shard_budget() -> int:
+    """Max concurrent analyze_code_security calls for one oversized diff.
+
+    SG_REVIEW_MAX_SHARDS caps both concurrency and spend — a diff beyond
+    MAX_DIFF_FILES files costs up to this many reviews instead of one. 1
+    restores the old behaviour (review only the top-prioritized files).
+    """
+    try:
+        return max(1, int(os.environ.get("SG_REVIEW_MAX_SHARDS", "4")))
+    except ValueError:
+        return 1
+
+
+def _plan_shards(files: List[Tuple[str, str]], files_per_shard: int,
+                 max_shards: int) -> List[List[Tuple[str, str]]]:
+    """Split files into the fewest shards (at most max_shards) that fit the
+    per-review file and byte caps, balanced by per-file-capped size: largest
+    file first onto the lightest shard that still has a file slot. Within a
+    shard files keep the caller's (priority) order, so if a shard still
+    overflows DIFF_TOTAL_BYTES its lowest-priority files are the ones
+    _cap_files_for_prompt truncates."""
+    sizes = [min(len(content), DIFF_PER_FILE_BYTES) for _, content in files]
+    n = max(1, -(-len(files) // max(1, files_per_shard)), -(-sum(sizes) // max(1, DIFF_TOTAL_BYTES)))
+    n = min(n, len(files), max(1, max_shards))
+    loads = [0] * n
+    counts = [0] * n
+    owner = [0] * len(files)
+    for i in sorted(range(len(files)), key=lambda i: sizes[i], reverse=True):
+        open_shards = [j for j in range(n) if counts[j] < files_per_shard] or list(range(n))
+        j = min(open_shards, key=lambda j: loads[j])
+        owner[i] = j
+        loads[j] += sizes[i]
+        counts[j] += 1
+    shards: List[List[Tuple[str, str]]] = [[] for _ in range(n)]
+    for i, item in enumerate(files):
+        shards[owner[i]].append(item)
+    return [sh for sh in shards if sh]
+
+
+def analyze_code_security_sharded(files: List[Tuple[str, str]], is_diff: bool = False,
+                                  previous_findings: Optional[List[str]] = None,
+                                  files_per_shard: int = 30) -> Tuple[Optional[str], List[Dict[str, Any]]]:
+    """analyze_code_security for file sets larger than one review.
+
+    Splits files into token-balanced shards (see _plan_shards) and reviews
+    them concurrently, at most review_shard_budget() at a time. A file set
+    that fits one review goes straight to analyze_code_security. Findings
+    are concatenated in shard order; a (filePath, category) an earlier
+    shard already reported is dropped (_finding_keys), which only matters
+    when the model names a file from outside its shard. Cross-file flows
+    whose source and sink land in different shards are not seen together.
+
+    Each shard reports its own (findings, call error, truncated bytes).
+    Afterwards _last_review_truncated_bytes is the total over the files the
+    shards actually sent, and _last_call_claude_http_error is the first
+    shard's error, if any, so a failed shard isn't masked by a later
+    successful one and its commits are not marked reviewed.
+    """
+    global _last_review_truncated_bytes
+    budget = review_shard_budget()
+    shards = _plan_shards(files, files_per_shard, budget) if files else []
+    if len(shards) <= 1:
+        return analyze_code_security(files, is_diff=is_diff, previous_findings=previous_findings)
+
+    from concurrent.futures import ThreadPoolExecutor
+
+    debug_log(f"LLM code review: {len(files)} files in {len(shards)} shards "
+              f"({', '.join(str(len(sh)) for sh in shards)} files)")
+
+    def _review(shard):
+        try:
+            _guidance, vulns, error, truncated = _review_files(shard, is_diff, previous_findings, None)
+            return vulns, error, truncated
+        except Exception as e:
+            debug_log(f"LLM code review: shard failed: {e}")
+            return [], -1, 0
+
+    with ThreadPoolExecutor(max_workers=len(shards)) as ex:
+        results = list(ex.map(_review, shards))
+
+    errors = [error for _, error, _ in results if error is not None]
+    if errors:
+        debug_log(f"LLM code review: {len(errors)}/{len(shards)} shards failed ({errors})")
+    _set_call_error(errors[0] if errors else None)
+    _last_review_truncated_bytes = sum(truncated for _, _, truncated in results)
+
+    merged: List[Dict[str, Any]] = []
+    seen: set = set()
+    for vulns, _, _ in results:
+        keys = _finding_keys(vulns)
+        merged.extend(v for v in vulns
+                      if (v.get("filePath", ""), v.get("category", "")) not in seen)
+        seen |= keys
+    if not merged:
+        return None, []
+    debug_log(f"LLM code review: {len(merged)} findings across {len(shards)} shards")
+    return _format_vulns_guidance(merged), merged
 
 
 def _agentic_commit_review_enabled() -> bool:
@@ -1058,11 +1434,17 @@ def _agentic_spawn_env() -> Dict[str, str]:
 
 def agentic_review(
     repo_dir: str, diff_files: List[Tuple[str, str]], touched_paths: List[str],
+    cancel: Optional[httpclient.CancelToken] = None,
 ) -> Tuple[Optional[str], List[Dict[str, Any]], Dict[str, Any]]:
     """Two-stage Agent-SDK review: investigate (Read/Grep/Glob over the repo)
     then a self-refute filter pass. Returns (guidance_or_None, vulns,
     metrics). On SDK unavailability returns (None, [], {"agentic_fallback":
-    reason}) so the caller can fall back to the single-shot path."""
+    reason}) so the caller can fall back to the single-shot path.
+
+    cancel: cancel() from another thread cancels the running agent loop
+    (which closes the SDK's CLI subprocess) and raises
+    asyncio.CancelledError out of this call. Each agent loop is recorded as
+    a review stage (sdk_spawn = time to the CLI's first message)."""
     import time as _t
 
     # Note: do NOT pop ANTHROPIC_AUTH_TOKEN from os.environ here. The race
@@ -1085,7 +1467,7 @@ def agentic_review(
         )
     except Exception:
         # Some users don't have claude_agent_sdk in their system python.
-        # The SessionStart hook (ensure_agent_sdk.py) creates a venv under
+        # The deferred bootstrap (ensure_agent_sdk.py) creates a venv under
         # ~/.claude/security/ with the SDK installed; try that as a fallback
         # before giving up. The system import is attempted first so users
         # who DO have it never touch the venv.
@@ -1274,30 +1656,60 @@ def agentic_review(
             yield {"type": "user",
                    "message": {"role": "user", "content": prompt}}
 
-        async for msg in query(prompt=_once(), options=opts):
-            if isinstance(msg, AssistantMessage):
-                n += 1
-            elif isinstance(msg, ResultMessage):
-                subtype = msg.subtype
-                if msg.structured_output is not None:
-                    structured = msg.structured_output
-                # SDK ResultMessage carries aggregate usage + cache-aware
-                # cost across the whole multi-turn run; prefer its cost over
-                # the price-table estimate. getattr guards older SDK builds.
-                _record_usage(getattr(msg, "usage", None) or {}, model,
-                              cost_usd=getattr(msg, "total_cost_usd", None))
+        spawn_t0 = _t.monotonic()
+        spawned = False
+        # Closed explicitly (not left to loop shutdown) so a cancelled run
+        # tears down the CLI subprocess before _run returns.
+        messages = query(prompt=_once(), options=opts)
+        try:
+            async for msg in messages:
+                if not spawned:
+                    spawned = True
+                    record_stage("sdk_spawn", (_t.monotonic() - spawn_t0) * 1000)
+                if isinstance(msg, AssistantMessage):
+                    n += 1
+                elif isinstance(msg, ResultMessage):
+                    subtype = msg.subtype
+                    if msg.structured_output is not None:
+                        structured = msg.structured_output
+                    # SDK ResultMessage carries aggregate usage + cache-aware
+                    # cost across the whole multi-turn run; prefer its cost over
+                    # the price-table estimate. getattr guards older SDK builds.
+                    _record_usage(getattr(msg, "usage", None) or {}, model,
+                                  cost_usd=getattr(msg, "total_cost_usd", None))
+        finally:
+            await messages.aclose()
         return structured, n, subtype
 
-    def _run(system: str, prompt: str, *, schema: Dict[str, Any]
+    def _run(system: str, prompt: str, *, schema: Dict[str, Any], stage: str
              ) -> Tuple[Optional[Dict[str, Any]], int, Optional[str]]:
-        return _asyncio.run(_arun(system, prompt, schema=schema))
+        async def _main():
+            if cancel is None:
+                return await _arun(system, prompt, schema=schema)
+            loop = _asyncio.get_running_loop()
+            task = _asyncio.current_task()
+            handle = cancel.on_cancel(lambda: loop.call_soon_threadsafe(task.cancel))
+            try:
+                return await _arun(system, prompt, schema=schema)
+            finally:
+                cancel.discard(handle)
+
+        with review_stage(stage, model=model) as rec:
+            try:
+                result = _asyncio.run(_main())
+            except _asyncio.CancelledError:
+                rec["cancelled"] = True
+                raise
+            rec["turns"] = result[1]
+            return result
 
     # Stage 1: investigate — SDK enforces _FINDINGS_SCHEMA and retries the
     # agent on mismatch, so `inv` is either a validated dict or None.
     t0 = _t.time()
     try:
         inv, inv_turns, inv_subtype = _run(
-            _AGENTIC_INVESTIGATE_SYSTEM, user_prompt, schema=_FINDINGS_SCHEMA
+            _AGENTIC_INVESTIGATE_SYSTEM, user_prompt, schema=_FINDINGS_SCHEMA,
+            stage="investigate",
         )
         if os.environ.get("SG_AGENTIC_DEBUG_DIR"):
             _dd = os.environ["SG_AGENTIC_DEBUG_DIR"]
@@ -1361,7 +1773,8 @@ def agentic_review(
         )
         try:
             inv2, _, _ = _run(
-                _AGENTIC_INVESTIGATE_SYSTEM, iter2_prompt, schema=_FINDINGS_SCHEMA
+                _AGENTIC_INVESTIGATE_SYSTEM, iter2_prompt, schema=_FINDINGS_SCHEMA,
+                stage="investigate2",
             )
             if inv2:
                 seen = {(c.get("filePath"), c.get("category")) for c in candidates}
@@ -1532,6 +1945,7 @@ def agentic_review(
                 "find concrete refuting evidence.",
                 refute_prompt,
                 schema=_SURVIVED_SCHEMA,
+                stage="refute",
             )
             if ref is None:
                 # Schema retries exhausted — fail OPEN (keep all).
@@ -1,9 +1,11 @@
 """
 Regex-based security pattern definitions for the security-guidance plugin.
 
-Pure data + one pure helper. No env-var reads, no I/O, no debug_log — kept
-side-effect-free so it can be imported in isolation.
+Pure data, the RuleId mapping, and the compiled PatternScanner. No env-var
+reads, no I/O, no debug_log — kept side-effect-free so it can be imported in
+isolation.
 """
+import re
 from enum import IntEnum
 
 
@@ -343,3 +345,174 @@ def rule_names_to_mask(rule_names):
         if name in _RULE_NAME_TO_ID:
             mask |= 1 << _RULE_NAME_TO_ID[name]
     return mask
+
+
+# The stdlib regex parser, used to derive anchors from a pattern's parse
+# tree. It moved to re._parser in 3.11; extensibility reuses this import.
+try:
+    import re._parser as _sre_parse  # Python 3.11+
+except ImportError:  # pragma: no cover - older interpreters
+    import sre_parse as _sre_parse
+
+# Shortest literal worth gating a regex on. Shorter runs ("(", "os") occur in
+# nearly every file and would never skip the regex.
+_MIN_ANCHOR_LEN = 3
+
+
+def _anchors(subpattern):
+    """Anchor literals for a parsed (sub)pattern, or None if there are none."""
+    items = list(subpattern)
+    if len(items) == 1 and items[0][0] is _sre_parse.BRANCH:
+        return _branch_anchors(items[0][1][1])
+    return _sequence_anchors(items)
+
+
+def _branch_anchors(branches):
+    """Union of every alternative's anchors; None if any alternative has none."""
+    anchors = []
+    for branch in branches:
+        found = _sequence_anchors(list(branch))
+        if found is None:
+            return None
+        anchors.extend(found)
+    return tuple(dict.fromkeys(anchors))
+
+
+def _sequence_anchors(items):
+    """Best anchor set for one alternative: its longest run of mandatory
+    literals, or a mandatory group / alternation whose own alternatives all
+    have anchors — whichever has the longer shortest literal."""
+    candidates = []
+    run = []
+    for op, av in items + [(None, None)]:
+        if op is _sre_parse.LITERAL:
+            run.append(chr(av))
+            continue
+        if run:
+            candidates.append(("".join(run),))
+            run = []
+        if op is _sre_parse.BRANCH:
+            found = _branch_anchors(av[1])
+            if found:
+                candidates.append(found)
+        elif op is _sre_parse.SUBPATTERN:
+            _group, add_flags, _del_flags, sub = av
+            if not add_flags & re.IGNORECASE:
+                found = _anchors(sub)
+                if found:
+                    candidates.append(found)
+    candidates = [c for c in candidates if min(map(len, c)) >= _MIN_ANCHOR_LEN]
+    if not candidates:
+        return None
+    return max(candidates, key=lambda c: min(map(len, c)))
+
+
+def regex_anchors(regex):
+    """Literals at least one of which occurs in any text the regex matches.
+
+    Each top-level alternative contributes its longest run of mandatory
+    literals (or a mandatory group's alternatives). If any alternative has
+    no literal of _MIN_ANCHOR_LEN chars, or the regex is case-insensitive
+    or unparseable, returns None, meaning "always run the regex".
+    Conservative by construction: None or an anchor hit only ever means the
+    regex itself decides.
+    """
+    if not isinstance(regex, str):
+        return None
+    try:
+        parsed = _sre_parse.parse(regex)
+    except Exception:
+        return None
+    if parsed.state.flags & (re.IGNORECASE | re.VERBOSE):
+        return None
+    return _anchors(parsed)
+
+
+class PatternScanner:
+    """A pattern table compiled once for repeated scanning.
+
+    Regexes are compiled up front and each is gated on the literals it
+    cannot match without (regex_anchors): "exec(" for the exec rule, "pickle."
+    or "pkl_load(" for pickle, and so on. str.__contains__ is a single fast C
+    pass, so on a typical edit — where nothing dangerous appears — most
+    regexes are never run over the content at all. Substrings are checked
+    with the same `in` test as before. Evaluation order, path gates and
+    exception handling mirror the per-rule loop exactly, so output is
+    identical to checking each rule in turn.
+    """
+
+    def __init__(self, table):
+        self._rules = []
+        for pattern in table:
+            regex = None
+            anchors = None
+            if "regex" in pattern:
+                try:
+                    regex = pattern.get("_compiled") or re.compile(pattern["regex"])
+                    anchors = regex_anchors(pattern["regex"])
+                except Exception:
+                    regex = None  # invalid regex never matches
+            self._rules.append((
+                pattern["ruleName"],
+                pattern["reminder"],
+                "path_filter" in pattern,
+                pattern.get("path_filter"),
+                "path_check" in pattern,
+                pattern.get("path_check"),
+                tuple(pattern["substrings"]) if "substrings" in pattern else None,
+                "regex" in pattern,
+                regex,
+                anchors,
+                1 << _RULE_NAME_TO_ID[pattern["ruleName"]]
+                if pattern["ruleName"] in _RULE_NAME_TO_ID else 0,
+            ))
+
+    def scan(self, normalized_path, content):
+        """Return ([(ruleName, reminder), ...], rule_mask) in table order."""
+        matches = []
+        mask = 0
+
+        for (name, reminder, has_filter, path_filter, has_check, path_check,
+                subs, has_regex, regex, anchors, bit) in self._rules:
+            # path_filter is a gate: when present, the rule only applies to
+            # matching paths. Distinct from path_check, which is itself a
+            # positive match condition (e.g. .github/workflows/).
+            if has_filter:
+                try:
+                    if not path_filter(normalized_path):
+                        continue
+                except Exception:
+                    continue
+
+            matched = False
+
+            if has_check:
+                try:
+                    if path_check(normalized_path):
+                        matched = True
+                except Exception:
+                    pass
+
+            if not matched and subs is not None and content:
+                for substring in subs:
+                    if substring in content:
+                        matched = True
+                        break
+
+            if not matched and has_regex and content and regex is not None:
+                if anchors is None or any(a in content for a in anchors):
+                    try:
+                        if regex.search(content):
+                            matched = True
+                    except Exception:
+                        pass
+
+            if matched:
+                matches.append((name, reminder))
+                mask |= bit
+
+        return matches, mask
+
+
+# Built-in table compiled once at import.
+BUILTIN_SCANNER = PatternScanner(SECURITY_PATTERNS)
@@ -0,0 +1,152 @@
+"""
+Content-addressed per-file cache of LLM diff-review findings.
+
+``analyze_code_security`` reviews every file in the capped diff on every
+Stop/commit/push review. After a small follow-up edit most of those files
+have byte-identical hunks, and re-reviewing them costs the same tokens and
+latency as the first time. This cache stores the (medium+) findings the
+model returned for each file, keyed by
+
+    sha256(review fingerprint, file path, normalized file diff)
+
+where the review fingerprint covers the model that answered (the primary,
+or the fallback when the primary failed), prompt version, diff/file mode,
+dual-OR mode and the project guidance block. Only files whose key misses
+are sent to the model; cached findings for the rest are merged back.
+
+Shared across sessions (the key is content-addressed) in one SQLite file
+under the state dir. Entries expire after SG_REVIEW_CACHE_TTL_SEC (default
+7 days). SG_REVIEW_CACHE=0 disables it. Every operation is best-effort: a
+cache failure just means a normal full review.
+"""
+import hashlib
+import json
+import os
+import re
+import time
+from typing import Any, Dict, List, Optional
+
+from _base import debug_log, hook_count
+
+try:
+    import sqlite3
+except ImportError:  # Python built without _sqlite3
+    sqlite3 = None
+
+REVIEW_CACHE_TTL_SEC = int(os.environ.get("SG_REVIEW_CACHE_TTL_SEC", str(7 * 24 * 3600)))
+REVIEW_CACHE_MAX_ROWS = 5000
+
+_HUNK_HEADER_RE = re.compile(r"^@@ -\d+(?:,\d+)? \+\d+(?:,\d+)? @@", re.M)
+
+
+def review_cache_enabled() -> bool:
+    return sqlite3 is not None and os.environ.get("SG_REVIEW_CACHE", "1") != "0"
+
+
+def _db_path() -> str:
+    state_dir = os.environ.get("SECURITY_WARNINGS_STATE_DIR", os.path.expanduser("~/.claude/security"))
+    return os.path.join(state_dir, "review_cache.db")
+
+
+def normalize_file_diff(content: str) -> str:
+    """Drop line numbers from hunk headers and trailing whitespace, so an
+    edit elsewhere that only shifts a hunk doesn't change its key."""
+    content = _HUNK_HEADER_RE.sub("@@", content)
+    return "\n".join(line.rstrip() for line in content.split("\n"))
+
+
+def file_key(fingerprint: str, file_path: str, content: str) -> str:
+    h = hashlib.sha256()
+    for part in (fingerprint, file_path, normalize_file_diff(content)):
+        h.update(part.encode("utf-8", "replace"))
+        h.update(b"\0")
+    return h.hexdigest()
+
+
+def _connect():
+    path = _db_path()
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    conn = sqlite3.connect(path, timeout=5.0, isolation_level=None)
+    conn.execute("PRAGMA journal_mode=WAL")
+    conn.execute("PRAGMA synchronous=NORMAL")
+    conn.execute(
+        "CREATE TABLE IF NOT EXISTS findings ("
+        "key TEXT PRIMARY KEY, findings TEXT NOT NULL, ts REAL NOT NULL)"
+    )
+    return conn
+
+
+def lookup(keys: List[str]) -> Dict[str, List[Dict[str, Any]]]:
+    """Cached findings for each key that hits (missing keys are absent)."""
+    if not keys or not review_cache_enabled():
+        return {}
+    conn = None
+    try:
+        conn = _connect()
+        cutoff = time.time() - REVIEW_CACHE_TTL_SEC
+        hits = {}
+        for key in dict.fromkeys(keys):
+            row = conn.execute(
+                "SELECT findings FROM findings WHERE key = ? AND ts >= ?", (key, cutoff)
+            ).fetchone()
+            if row:
+                findings = json.loads(row[0])
+                if isinstance(findings, list):
+                    hits[key] = findings
+        hook_count("cache_hits", len(hits))
+        hook_count("cache_misses", len(set(keys)) - len(hits))
+        return hits
+    except (sqlite3.Error, OSError, ValueError) as e:
+        debug_log(f"review cache lookup failed: {e}")
+        return {}
+    finally:
+        if conn is not None:
+            conn.close()
+
+
+def store(entries: Dict[str, List[Dict[str, Any]]]) -> None:
+    """Record findings (possibly empty) per key, pruning expired rows."""
+    if not entries or not review_cache_enabled():
+        return
+    conn = None
+    try:
+        conn = _connect()
+        now = time.time()
+        conn.execute("BEGIN IMMEDIATE")
+        conn.executemany(
+            "INSERT OR REPLACE INTO findings (key, findings, ts) VALUES (?, ?, ?)",
+            [(k, json.dumps(v), now) for k, v in entries.items()],
+        )
+        conn.execute("DELETE FROM findings WHERE ts < ?", (now - REVIEW_CACHE_TTL_SEC,))
+        conn.execute(
+            "DELETE FROM findings WHERE key NOT IN "
+            "(SELECT key FROM findings ORDER BY ts DESC LIMIT ?)",
+            (REVIEW_CACHE_MAX_ROWS,),
+        )
+        conn.execute("COMMIT")
+    except (sqlite3.Error, OSError, TypeError, ValueError) as e:
+        debug_log(f"review cache store failed: {e}")
+    finally:
+        if conn is not None:
+            conn.close()
+
+
+def attribute(vulns: List[Dict[str, Any]], file_paths: List[str]) -> Optional[Dict[str, List[Dict[str, Any]]]]:
+    """Group findings by the reviewed file they name.
+
+    The model is told to echo the exact path from the === header; accept a
+    suffix match for the occasional shortened path. Returns None if any
+    finding can't be attributed to exactly one file — the caller then skips
+    caching for this review rather than pin a finding to the wrong file.
+    """
+    by_file: Dict[str, List[Dict[str, Any]]] = {fp: [] for fp in file_paths}
+    for v in vulns:
+        fp = v.get("filePath", "") if isinstance(v, dict) else ""
+        if fp in by_file:
+            by_file[fp].append(v)
+            continue
+        candidates = [p for p in file_paths if fp and (p.endswith("/" + fp) or fp.endswith("/" + p))]
+        if len(candidates) != 1:
+            return None
+        by_file[candidates[0]].append(v)
+    return by_file
@@ -56,42 +56,33 @@ try:
     import fcntl
 except ImportError:
     fcntl = None
-import contextlib
-import glob
+import hashlib
 import json
 import os
 import random
 import re
 import subprocess
 import sys
-import threading
-import urllib.request
-from datetime import datetime
-from enum import IntEnum
 from typing import Optional, Tuple, Dict, Any, List
 
-# review_api is the importable surface for the agentic-review prompts,
-# schemas, and pure filters.  External callers (e.g. agentic review harnesses)
-# import review_api directly so they run the same eval-covered prompts
-# without going through the CC hook protocol.  The underscored names below
-# alias into it so this script stays the single CC-hook entrypoint.
 sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
-import review_api  # noqa: E402
 from _base import (  # noqa: E402,F401
     DEBUG_LOG_FILE, DEBUG_LOG_MAX_BYTES, debug_log,
     PROVENANCE_TAG, PROVENANCE_BANNER,
     _read_plugin_version_int, _PV, _USAGE, _USAGE_LOCK,
     _PRICE_PER_MTOK, _PRICE_DEFAULT, _record_usage, _usage_metrics,
+    review_stage, record_stage, _stage_metrics, write_stage_log,
+    hook_count, start_hook_timing,
 )
 import extensibility  # noqa: E402
 from patterns import (  # noqa: E402,F401
     _JS_EXTS, _PY_EXTS, _DOC_EXTS,
     _UNSAFE_DESERIALIZATION_REMINDER, _UNSAFE_YAML_LOAD_REMINDER,
     _UNSAFE_TORCH_LOAD_REMINDER, SECURITY_PATTERNS, RuleId,
-    _RULE_NAME_TO_ID, rule_names_to_mask,
+    _RULE_NAME_TO_ID, rule_names_to_mask, PatternScanner, BUILTIN_SCANNER,
 )
 from session_state import (  # noqa: E402,F401
-    _state_key, get_state_file, get_lock_file, cleanup_old_state_files,
+    _state_key, get_state_file, get_lock_file, get_db_file, cleanup_old_state_files,
     load_state, save_state, with_locked_state,
 )
 from gitutil import (  # noqa: E402,F401
@@ -100,13 +91,19 @@ from gitutil import (  # noqa: E402,F401
     _git_toplevel, _git_dir, _git_rev_list_range, _git_diff_range,
     _detect_main_branch, _git_reflog_recent_commits, _git_name_only,
     _git_status_porcelain, _is_ancestor, get_git_diff,
+    _git_resolve, _git_show_blob, clear_git_memo,
+    _fsmonitor_daemon_configured, watchman_clock, watchman_changed_since,
     SOURCE_CODE_EXTENSIONS, SOURCE_CODE_BASENAMES,
     NON_SOURCE_EXTENSIONLESS_BASENAMES, SKIP_PATH_PATTERNS,
     SKIP_FILE_SUFFIXES, _SECURITY_RISK_PATH_TOKENS,
     _LOW_PRIORITY_SUFFIXES, _LOW_PRIORITY_PATH_TOKENS,
     _prioritize_diff_files, _is_reviewable_source,
     extract_file_paths_from_diff, parse_diff_into_files,
-    filter_preexisting_from_diff,
+    filter_preexisting_from_diff, normalize_diff_files,
+)
+from ensure_agent_sdk import (  # noqa: E402
+    SETTLED as _SDK_STATUS_SETTLED, STATUS_TTL_S as _SDK_STATUS_TTL_S,
+    STATUS_FILE as _SDK_STATUS_FILE,
 )
 from diffstate import (  # noqa: E402,F401
     STOP_LOOP_STATE_TTL_SEC, PREVIOUS_FINDINGS_TTL_SEC,
@@ -116,21 +113,61 @@ from diffstate import (  # noqa: E402,F401
     _REVIEWED_SHAS_BASENAME, _REVIEWED_SHAS_CAP,
     _reviewed_shas_path, _load_reviewed_shas, _append_reviewed_shas,
     UNTRACKED_BASELINE_CAP, _list_untracked, compute_v2_review_set,
+    REVIEW_SET_MODE, INCREMENTAL_MAX_PATHS,
 )
-import llm  # noqa: E402  module ref for reassignable globals (_last_call_claude_http_error etc.)
-from llm import (  # noqa: E402,F401
-    ANTHROPIC_API_KEY, ANTHROPIC_AUTH_TOKEN, HAS_API_CREDENTIALS,
-    SECURITY_REVIEW_MODEL, CLAUDE_CODE_SYSTEM_PROMPT,
-    _last_call_claude_http_error,
-    ensure_anthropic_reachable,
-    _last_review_truncated_bytes, _auth_prefer_token,
-    DIFF_PER_FILE_BYTES, DIFF_TOTAL_BYTES, _AGENTIC_INVESTIGATE_SYSTEM,
-    _FINDINGS_SCHEMA, _SURVIVED_SCHEMA, _REWAKE_SUMMARY_BUDGET,
-    _cap_files_for_prompt, _build_auth_headers, _call_claude, _call_claude_dual_or,
-    _format_vulns_guidance, _format_vulns_summary, _finding_keys, _dedup_against_state,
-    analyze_code_security, _agentic_commit_review_enabled, agentic_review,
-    analyze_security_concerns,
-)
+# Modules only the LLM-review events (PostToolUse Bash commit/push, Stop)
+# need. llm pulls in http.client/ssl/email plus ~2k lines of prompts, which
+# the hot Edit PostToolUse and UserPromptSubmit paths never use, so these are
+# bound on first use by _load_review_modules() (main() calls it before
+# dispatching a review). Module-level __getattr__ keeps the old re-exports
+# (`security_reminder_hook.analyze_code_security`, `.llm`, `.review_api`)
+# working for harnesses and tests; a name they've monkeypatched is kept.
+#
+# review_api is the importable surface for the agentic-review prompts,
+# schemas, and pure filters.  External callers (e.g. agentic review harnesses)
+# import review_api directly so they run the same eval-covered prompts
+# without going through the CC hook protocol.  The underscored llm names
+# alias into it so this script stays the single CC-hook entrypoint.
+_LAZY_MODULES = ("review_api", "httpclient", "llm")
+_LAZY_NAMES = {
+    "httpclient": ("CancelToken",),
+    "llm": (
+        "ANTHROPIC_API_KEY", "ANTHROPIC_AUTH_TOKEN", "HAS_API_CREDENTIALS",
+        "SECURITY_REVIEW_MODEL", "CLAUDE_CODE_SYSTEM_PROMPT",
+        "_last_call_claude_http_error",
+        "ensure_anthropic_reachable",
+        "_last_review_truncated_bytes", "_auth_prefer_token",
+        "DIFF_PER_FILE_BYTES", "DIFF_TOTAL_BYTES", "_AGENTIC_INVESTIGATE_SYSTEM",
+        "_FINDINGS_SCHEMA", "_SURVIVED_SCHEMA", "_REWAKE_SUMMARY_BUDGET",
+        "_cap_files_for_prompt", "_build_auth_headers", "_call_claude", "_call_claude_dual_or",
+        "_format_vulns_guidance", "_format_vulns_summary", "_finding_keys", "_dedup_against_state",
+        "analyze_code_security", "_agentic_commit_review_enabled", "agentic_review",
+        "analyze_security_concerns", "analyze_code_security_sharded", "review_shard_budget",
+    ),
+}
+_LAZY_OWNER = {name: mod for mod, names in _LAZY_NAMES.items() for name in names}
+
+
+def _load_review_modules():
+    """Import the review modules and bind their re-exported names here.
+
+    setdefault, not assignment: anything already bound (a monkeypatch, or a
+    previous call) wins.
+    """
+    import importlib
+    g = globals()
+    for mod_name in _LAZY_MODULES:
+        mod = g.setdefault(mod_name, importlib.import_module(mod_name))
+        for name in _LAZY_NAMES.get(mod_name, ()):
+            g.setdefault(name, getattr(mod, name))
+
+
+def __getattr__(name):
+    if name in _LAZY_OWNER or name in _LAZY_MODULES:
+        _load_review_modules()
+        return globals()[name]
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
+
 
 # LLM-based code security review (enabled by default when API key is available)
 # Empty string or unset = enabled (default); "0" = disabled
@@ -190,6 +227,9 @@ CONTINUATION_SUFFIX = (
     "response."
 )
 
+METRICS_KEY_CAP = 20
+
+
 def emit_metrics(metrics, rewake_summary=None):
     """
     Write a SyncHookJSONOutput line to stdout for Claude Code to pick up.
@@ -220,6 +260,13 @@ def emit_metrics(metrics, rewake_summary=None):
     head.update(_usage_metrics())
     if head:
         metrics = {**head, **metrics}
+    # Stage timings (st_*_ms) only fill keys left under the cap, so they never
+    # displace an existing metric; the full breakdown goes to the timings log.
+    for k, v in _stage_metrics().items():
+        if len(metrics) >= METRICS_KEY_CAP:
+            break
+        metrics.setdefault(k, v)
+    write_stage_log(metrics)
     out = {"metrics": metrics}
     if rewake_summary:
         out["rewakeSummary"] = rewake_summary
@@ -231,7 +278,7 @@ def emit_metrics(metrics, rewake_summary=None):
 
 #
 # Low-level state-file plumbing (_state_key, get_state_file,
-# get_lock_file, cleanup_old_state_files, load_state, save_state,
+# get_lock_file, get_db_file, cleanup_old_state_files, load_state, save_state,
 # with_locked_state) moved to session_state.py and re-exported above.
 
 def atomic_check_and_mark_warning(session_id, warning_key):
@@ -307,6 +354,57 @@ def atomic_check_rate_limit(session_id, key, max_per_window, window_s):
     # State unavailable → fail-open (same posture as atomic_check_counter).
     return result if result is not None else (True, 0)
 
+# =====================================================================
+# Cleared-hunk memo
+#
+# Hashes of edit hunks that scanned clean for a file, so a large hunk that
+# is re-applied (retried MultiEdit, revert-and-redo) is not scanned again.
+# Only hunks of at least SCAN_MEMO_MIN_BYTES are remembered — smaller ones
+# scan faster than the state round-trip. Entries are tied to a fingerprint
+# of the active pattern tables, so editing security-patterns.* mid-session
+# invalidates them.
+#
+# State key: cleared_hunks: {"fp": "<tables>", "keys": ["<hash>", ...]}
+# =====================================================================
+
+SCAN_MEMO_MIN_BYTES = 2048
+SCAN_MEMO_MAX_KEYS = 256
+
+def _pattern_fingerprint():
+    """Digest of the rule tables a cleared-hunk entry was computed against."""
+    tables = list(SECURITY_PATTERNS) + extensibility.user_patterns()
+    desc = repr([(p.get("ruleName"), p.get("regex"), p.get("substrings")) for p in tables])
+    return hashlib.sha1(desc.encode("utf-8", "replace")).hexdigest()[:16]
+
+def _hunk_key(file_path, hunk):
+    h = hashlib.sha1(file_path.encode("utf-8", "replace") + b"\0")
+    h.update(hunk.encode("utf-8", "replace"))
+    return h.hexdigest()[:20]
+
+def load_cleared_hunks(session_id, fingerprint):
+    """Set of cleared hunk keys recorded under the current fingerprint."""
+    def _load(state):
+        memo = state.get("cleared_hunks")
+        if not isinstance(memo, dict) or memo.get("fp") != fingerprint:
+            return set()
+        return set(memo.get("keys") or [])
+    return with_locked_state(session_id, _load) or set()
+
+def record_cleared_hunks(session_id, fingerprint, keys):
+    """Append cleared hunk keys (oldest dropped past SCAN_MEMO_MAX_KEYS)."""
+    def _record(state):
+        memo = state.get("cleared_hunks")
+        if not isinstance(memo, dict) or memo.get("fp") != fingerprint:
+            memo = {"fp": fingerprint, "keys": []}
+            state["cleared_hunks"] = memo
+        existing = memo.setdefault("keys", [])
+        for key in keys:
+            if key not in existing:
+                existing.append(key)
+        if len(existing) > SCAN_MEMO_MAX_KEYS:
+            del existing[:len(existing) - SCAN_MEMO_MAX_KEYS]
+    with_locked_state(session_id, _record)
+
 # =====================================================================
 # Warning outcome tracking
 #
@@ -383,48 +481,37 @@ def sweep_pending_warnings(session_id):
 # Pattern matching
 # =====================================================================
 
-def check_patterns(file_path, content):
-    """Check if file path or content matches any security patterns. Returns ALL matches."""
+# Compiled scanners keyed on the pattern table object (plus its length), so a
+# replaced or extended table is recompiled instead of scanned stale. The
+# built-in table is compiled once at import in patterns.py.
+_SCANNERS = {id(SECURITY_PATTERNS): (SECURITY_PATTERNS, len(SECURITY_PATTERNS), BUILTIN_SCANNER)}
+
+def _scanner_for(table):
+    entry = _SCANNERS.get(id(table))
+    if entry is None or entry[0] is not table or entry[1] != len(table):
+        if len(_SCANNERS) >= 4:
+            _SCANNERS.clear()
+        entry = (table, len(table), PatternScanner(table))
+        _SCANNERS[id(table)] = entry
+    return entry[2]
+
+def scan_patterns(file_path, content):
+    """Single-pass pattern check. Returns (matches, rule_mask) where matches
+    is ALL (ruleName, reminder) hits — built-ins first, then user patterns —
+    and rule_mask is the rule_names_to_mask() of those hits."""
     normalized_path = file_path.lstrip("/")
-    matches = []
-
-    for pattern in list(SECURITY_PATTERNS) + extensibility.user_patterns():
-        # path_filter is a gate: when present, the rule only applies to
-        # matching paths. Distinct from path_check, which is itself a
-        # positive match condition (e.g. .github/workflows/).
-        if "path_filter" in pattern:
-            try:
-                if not pattern["path_filter"](normalized_path):
-                    continue
-            except Exception:
-                continue
-
-        matched = False
-
-        if "path_check" in pattern:
-            try:
-                if pattern["path_check"](normalized_path):
-                    matched = True
-            except Exception:
-                pass
-
-        if not matched and "substrings" in pattern and content:
-            for substring in pattern["substrings"]:
-                if substring in content:
-                    matched = True
-                    break
-
-        if not matched and "regex" in pattern and content:
-            try:
-                if re.search(pattern["regex"], content):
-                    matched = True
-            except Exception:
-                pass
-
-        if matched:
-            matches.append((pattern["ruleName"], pattern["reminder"]))
+    matches, mask = _scanner_for(SECURITY_PATTERNS).scan(normalized_path, content)
+    user = extensibility.user_patterns()
+    hook_count("patterns", len(SECURITY_PATTERNS) + len(user or ()))
+    if user:
+        # User patterns have no RuleId, so they never contribute to the mask.
+        user_matches, _ = _scanner_for(user).scan(normalized_path, content)
+        matches = matches + user_matches
+    return matches, mask
 
-    return matches
+def check_patterns(file_path, content):
+    """Check if file path or content matches any security patterns. Returns ALL matches."""
+    return scan_patterns(file_path, content)[0]
 
 def extract_content_from_input(tool_name, tool_input):
     """Extract content to check from tool input based on tool type."""
@@ -439,6 +526,103 @@ def extract_content_from_input(tool_name, tool_input):
         return ""
     return ""
 
+# Context kept around each edit hunk: the rest of the hunk's first and last
+# lines, capped so a minified one-line file doesn't pull in the whole file.
+HUNK_CONTEXT_CHARS = 200
+
+# Files larger than this are not read for hunk context; the bare new_string
+# is scanned instead.
+HUNK_CONTEXT_MAX_FILE_BYTES = 8 * 1024 * 1024
+
+def _read_for_context(file_path):
+    try:
+        if os.path.getsize(file_path) > HUNK_CONTEXT_MAX_FILE_BYTES:
+            return None
+        with open(file_path, "r", encoding="utf-8", errors="replace") as f:
+            return f.read()
+    except (OSError, IOError):
+        return None
+
+def _hunk_with_context(text, new_string):
+    """new_string widened to its surrounding lines in the post-edit file."""
+    if text is None:
+        return new_string
+    i = text.find(new_string)
+    if i < 0:
+        return new_string
+    j = i + len(new_string)
+    start = max(text.rfind("\n", 0, i) + 1, i - HUNK_CONTEXT_CHARS)
+    end = text.find("\n", j)
+    if end < 0:
+        end = len(text)
+    end = min(end, j + HUNK_CONTEXT_CHARS)
+    return text[start:end]
+
+def extract_content_hunks(tool_name, tool_input, file_path, content=None):
+    """Content to check, split into independently scanned hunks.
+
+    Edit/MultiEdit yield one hunk per new_string, widened with a little
+    context from the post-edit file (PostToolUse runs after the write) so a
+    pattern completed by the edit — e.g. `eval(` typed into an existing
+    call — is still seen. Scanning hunks separately also stops matches that
+    only exist across the old space-joined edit boundaries. Write and
+    NotebookEdit yield the same single string as extract_content_from_input,
+    or `content` when the caller already extracted it.
+    """
+    if tool_name == "Edit":
+        new_strings = [tool_input.get("new_string", "")]
+    elif tool_name == "MultiEdit":
+        new_strings = [edit.get("new_string", "") for edit in tool_input.get("edits", []) or []]
+    else:
+        if content is None:
+            content = extract_content_from_input(tool_name, tool_input)
+        return [content]
+
+    new_strings = [ns for ns in new_strings if isinstance(ns, str) and ns]
+    if not new_strings:
+        return [""]
+    text = _read_for_context(file_path)
+    return [_hunk_with_context(text, ns) for ns in dict.fromkeys(new_strings)]
+
+def scan_content_hunks(session_id, file_path, hunks):
+    """scan_patterns() over each hunk, merged. Returns (matches, rule_mask).
+
+    Matches are deduped by rule and kept in table order, as for a single
+    scan. Large hunks that already scanned clean for this file in this
+    session (see cleared_hunks) are skipped.
+    """
+    if len(hunks) == 1 and len(hunks[0]) < SCAN_MEMO_MIN_BYTES:
+        return scan_patterns(file_path, hunks[0])
+
+    fingerprint = None
+    cleared = set()
+    if any(len(h) >= SCAN_MEMO_MIN_BYTES for h in hunks):
+        fingerprint = _pattern_fingerprint()
+        cleared = load_cleared_hunks(session_id, fingerprint)
+
+    found = {}
+    mask = 0
+    newly_cleared = []
+    for hunk in hunks:
+        key = _hunk_key(file_path, hunk) if len(hunk) >= SCAN_MEMO_MIN_BYTES else None
+        if key is not None and key in cleared:
+            continue
+        matches, hunk_mask = scan_patterns(file_path, hunk)
+        if not matches and key is not None:
+            newly_cleared.append(key)
+        for rule_name, reminder in matches:
+            found.setdefault(rule_name, reminder)
+        mask |= hunk_mask
+
+    if newly_cleared:
+        record_cleared_hunks(session_id, fingerprint, newly_cleared)
+    if len(found) > 1:
+        order = {p["ruleName"]: i for i, p in
+                 enumerate(list(SECURITY_PATTERNS) + extensibility.user_patterns())}
+        ranked = sorted(found.items(), key=lambda kv: order.get(kv[0], len(order)))
+        return ranked, mask
+    return list(found.items()), mask
+
 # =====================================================================
 # Hook handlers
 # =====================================================================
@@ -463,10 +647,15 @@ def handle_user_prompt_submit(input_data):
     session_id = input_data.get("session_id", "default")
     # stash-create and ls-files both walk the worktree (~2-5s each in a very
     # large repo). Run them concurrently so UPS latency stays ≈ max(both).
+    # The watchman clock (when watchman already watches the repo) lets the
+    # Stop hook ask for exactly what changed this turn instead of a
+    # whole-repo status.
     import concurrent.futures as _cf
-    with _cf.ThreadPoolExecutor(max_workers=2) as _ex:
+    with _cf.ThreadPoolExecutor(max_workers=3) as _ex:
         _f_sha = _ex.submit(capture_git_baseline, cwd)
         _f_ut = _ex.submit(_list_untracked, cwd)
+        _f_clock = (_ex.submit(watchman_clock, cwd)
+                    if REVIEW_SET_MODE != "full" else None)
         sha = _f_sha.result()
         # Always capture the untracked snapshot. `git stash create` returns
         # empty when there are no TRACKED changes, but pre-existing untracked
@@ -474,6 +663,7 @@ def handle_user_prompt_submit(input_data):
         # otherwise an untracked-only working tree gets every untracked file
         # reviewed on every turn until something tracked is dirtied.
         untracked_now = _f_ut.result() or {}
+        change_clock = _f_clock.result() if _f_clock else None
     head = _git_rev_parse_head(cwd)
 
     # If the previous turn's Stop hook never ran (user interrupt, follow-up
@@ -500,6 +690,8 @@ def handle_user_prompt_submit(input_data):
         # a SHA — write it unconditionally so compute_v2_review_set's
         # preexisting-untracked exclusion works in untracked-only trees.
         state["untracked_at_baseline"] = untracked_now
+        # Paired with the baseline: a preserved baseline keeps its clock too.
+        state["change_clock"] = change_clock
     with_locked_state(session_id, _save)
 
     if preserved["value"]:
@@ -790,15 +982,9 @@ def _detect_prev_upstream(repo_root, bash_output):
         return m.group(1)
     # @{u}@{1} — only meaningful if an upstream is configured.
     for ref in ("@{u}@{1}", "@{push}@{1}"):
-        try:
-            r = subprocess.run(
-                [*GIT_CMD, "rev-parse", "--verify", "-q", ref],
-                cwd=repo_root, capture_output=True, text=True, timeout=5,
-            )
-            if r.returncode == 0 and r.stdout.strip():
-                return r.stdout.strip()
-        except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
-            pass
+        sha = _git_resolve(repo_root, ref)
+        if sha:
+            return sha
     main = _detect_main_branch(repo_root)
     if main:
         try:
@@ -847,6 +1033,12 @@ def _agentic_review_with_race(
       race_delay_s   : the configured delay
       race_started   : 1 if the fallback was actually launched, else 0
 
+    The loser is cancelled rather than abandoned: agentic's agent loop is
+    cancelled (closing the SDK CLI subprocess) and the fallback's HTTP socket
+    is shut down, so neither keeps burning tokens or holding a 3P gateway slot
+    while the hook writes its result. The cancel latency is recorded as the
+    race_cancel review stage (loser = losing leg).
+
     Only the commit-review handler calls this — external harnesses invoke
     agentic_review() directly and are unaffected. SG_AGENTIC_NO_RACE=1
     disables the race for any other caller that wants pure agentic.
@@ -861,11 +1053,15 @@ def _agentic_review_with_race(
     delay_s = int(os.environ.get("SG_AGENTIC_RACE_DELAY_S", "180"))
     q: "_queue.Queue[Tuple[str, Any]]" = _queue.Queue(maxsize=1)
     fallback_started = _th.Event()
+    ag_cancel = CancelToken()
+    fb_cancel = CancelToken()
 
     def _agentic() -> None:
         try:
-            r = agentic_review(repo_root, diff_files, rel_touched)
-        except Exception as e:  # pragma: no cover — crash → let fallback win
+            r = agentic_review(repo_root, diff_files, rel_touched, cancel=ag_cancel)
+        except BaseException as e:  # crash → let fallback win; CancelledError once lost
+            if ag_cancel.cancelled():
+                return
             r = (None, [], {"agentic_fallback": f"race_crash:{type(e).__name__}"})
         try:
             q.put_nowait(("agentic", r))
@@ -873,25 +1069,43 @@ def _agentic_review_with_race(
             pass
 
     def _fallback() -> None:
-        _t.sleep(delay_s)
-        if not q.empty():
+        if fb_cancel.wait(delay_s) or not q.empty():
             return  # agentic finished within the delay — never start fallback
         fallback_started.set()
         try:
-            g, v = analyze_code_security(
-                diff_files, is_diff=True, previous_findings=previous_findings
-            )
+            with review_stage("fallback"):
+                g, v = analyze_code_security(
+                    diff_files, is_diff=True, previous_findings=previous_findings,
+                    cancel=fb_cancel,
+                )
         except Exception as e:  # pragma: no cover
             g, v = None, []
+        if fb_cancel.cancelled():
+            return
         try:
             q.put_nowait(("fallback", (g, v, {"agentic": False})))
         except _queue.Full:
             pass
 
-    _th.Thread(target=_agentic, daemon=True).start()
-    _th.Thread(target=_fallback, daemon=True).start()
+    ag_thread = _th.Thread(target=_agentic, daemon=True)
+    fb_thread = _th.Thread(target=_fallback, daemon=True)
+    ag_thread.start()
+    fb_thread.start()
 
     winner, (g, v, m) = q.get()
+    # Stop the loser and wait briefly for it to unwind so its subprocess /
+    # socket is gone before the hook exits; a stuck leg is left to the
+    # daemon-thread teardown.
+    cancel_t0 = _t.monotonic()
+    loser, loser_cancel, loser_thread = (
+        ("fallback", fb_cancel, fb_thread) if winner == "agentic"
+        else ("agentic", ag_cancel, ag_thread)
+    )
+    loser_cancel.cancel()
+    if loser == "agentic" or fallback_started.is_set():
+        loser_thread.join(timeout=5)
+        record_stage("race_cancel", (_t.monotonic() - cancel_t0) * 1000,
+                     loser=loser, stuck=loser_thread.is_alive())
     m = dict(m)  # don't mutate the callee's metrics dict
     m["race_winner"] = 1 if winner == "agentic" else 2
     m["race_delay_s"] = delay_s
@@ -968,7 +1182,7 @@ def handle_commit_review_posttooluse(input_data):
         _root = _git_toplevel(cwd)
         _fresh, _stale = _git_reflog_recent_commits(_root)
         if _fresh:
-            _already = _load_reviewed_shas(_root)
+            _already = _load_reviewed_shas(_root, _fresh)
             _reflog_shas = [s for s in _fresh if s not in _already]
             if _reflog_shas:
                 commit_succeeded = True
@@ -1006,7 +1220,7 @@ def handle_commit_review_posttooluse(input_data):
         emit_metrics({"skipped": True, "skip_reason": 22, **_base})
         sys.exit(0)
 
-    if not ensure_anthropic_reachable():
+    if not ensure_anthropic_reachable(session_id):
         debug_log("Commit review: api.anthropic.com unreachable")
         emit_metrics({"skipped": True, "skip_reason": 24, **_base})
         sys.exit(0)
@@ -1155,6 +1369,12 @@ def handle_commit_review_posttooluse(input_data):
             (fp, c) for fp, c in diff_files
             if not (fp in _seen or _seen.add(fp))
         ]
+    # Whitespace-only hunks, moved blocks and generated files cost prompt
+    # bytes without carrying new code. A commit that is nothing but those
+    # comes back empty and takes skip_reason=35 (amend) or 30 below.
+    diff_files, _normalized = normalize_diff_files(diff_files, repo_root)
+    if _normalized:
+        _base = {**_base, "diff_normalized": _normalized}
 
     if resolved == 0:
         debug_log("Commit review: no parsed SHA resolved in cwd repo")
@@ -1194,7 +1414,11 @@ def handle_commit_review_posttooluse(input_data):
         emit_metrics({"skipped": True, "skip_reason": 31, **_base,
                       "diff_files_count": len(diff_files)})
         sys.exit(0)
-    diff_files, _dropped = _prioritize_diff_files(diff_files, MAX_DIFF_FILES)
+    # The single-shot review shards an over-cap diff across up to
+    # review_shard_budget() concurrent reviews; the agentic reviewer takes
+    # one MAX_DIFF_FILES set.
+    _file_cap = MAX_DIFF_FILES * (1 if _agentic_commit_review_enabled() else review_shard_budget())
+    diff_files, _dropped = _prioritize_diff_files(diff_files, _file_cap)
     if _dropped:
         debug_log(f"Commit review: prioritized to {len(diff_files)} files "
                   f"(dropped {_dropped} lower-risk)")
@@ -1241,8 +1465,9 @@ def handle_commit_review_posttooluse(input_data):
                 diff_files, is_diff=True, previous_findings=previous_findings
             )
     else:
-        concrete_guidance, vulns = analyze_code_security(
-            diff_files, is_diff=True, previous_findings=previous_findings
+        concrete_guidance, vulns = analyze_code_security_sharded(
+            diff_files, is_diff=True, previous_findings=previous_findings,
+            files_per_shard=MAX_DIFF_FILES,
         )
 
     # push-sweep state: record this commit as reviewed (full 40-hex sha) so a
@@ -1250,17 +1475,13 @@ def handle_commit_review_posttooluse(input_data):
     # the review ran but before any exit path — so it's marked regardless of
     # whether findings were emitted. `shas` holds abbreviated refs from
     # `[branch sha]`; resolve to full so set-membership in the push-sweep is
-    # exact. Best-effort; failures here never block the review result.
+    # exact. Best-effort; failures here never block the review result. A
+    # failed model call (any shard) reviewed nothing, so the commit stays
+    # unreviewed and the next push sweep picks it up.
     try:
-        full_shas = []
-        for s in shas:
-            r = subprocess.run(
-                [*GIT_CMD, "rev-parse", "--verify", "-q", s],
-                cwd=repo_root, capture_output=True, text=True, timeout=5,
-            )
-            if r.returncode == 0:
-                full_shas.append(r.stdout.strip())
-        _append_reviewed_shas(repo_root, full_shas, vulns_found=len(vulns or []))
+        if llm._last_call_claude_http_error is None:
+            full_shas = [sha for sha in (_git_resolve(repo_root, s) for s in shas) if sha]
+            _append_reviewed_shas(repo_root, full_shas, vulns_found=len(vulns or []))
     except Exception:
         pass
 
@@ -1451,13 +1672,7 @@ def handle_push_sweep_posttooluse(input_data):
     # and rejected pushes (no range line, no `interrupted` signal → reviews
     # unpushed local commits and marks them reviewed). skip_reason=46 covers
     # both.
-    head = None
-    try:
-        r = subprocess.run([*GIT_CMD, "rev-parse", "HEAD"], cwd=repo_root,
-                           capture_output=True, text=True, timeout=5)
-        head = r.stdout.strip() if r.returncode == 0 else None
-    except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
-        pass
+    head = _git_rev_parse_head(repo_root)
     push_section = _push_section(bash_output or "")
     range_matches = list(_PUSH_RANGE_RE.finditer(push_section))
     if range_matches and head:
@@ -1484,18 +1699,9 @@ def handle_push_sweep_posttooluse(input_data):
         # would not advance @{u}, so this signal is push-specific.
         quiet_success = False
         if not (bash_output or "").strip() and not interrupted:
-            try:
-                r_cur = subprocess.run(
-                    [*GIT_CMD, "rev-parse", "--verify", "-q", "@{u}"],
-                    cwd=repo_root, capture_output=True, text=True, timeout=5)
-                r_prev = subprocess.run(
-                    [*GIT_CMD, "rev-parse", "--verify", "-q", "@{u}@{1}"],
-                    cwd=repo_root, capture_output=True, text=True, timeout=5)
-                cur = r_cur.stdout.strip() if r_cur.returncode == 0 else ""
-                prev_u = r_prev.stdout.strip() if r_prev.returncode == 0 else ""
-                quiet_success = bool(cur and prev_u and cur == head and prev_u != cur)
-            except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
-                pass
+            cur = _git_resolve(repo_root, "@{u}") or ""
+            prev_u = _git_resolve(repo_root, "@{u}@{1}") or ""
+            quiet_success = bool(cur and prev_u and cur == head and prev_u != cur)
         if not (new_branch_matches or up_to_date or quiet_success):
             debug_log("Push sweep: no push-success signal in bash output")
             emit_metrics({"skipped": True, "skip_reason": 46, **_base})
@@ -1505,14 +1711,7 @@ def handle_push_sweep_posttooluse(input_data):
         # would otherwise review feature1's commits and poison its
         # reviewed-shas state.
         for local_ref in new_branch_matches:
-            try:
-                r = subprocess.run(
-                    [*GIT_CMD, "rev-parse", "--verify", "-q", local_ref],
-                    cwd=repo_root, capture_output=True, text=True, timeout=5,
-                )
-                local_sha = r.stdout.strip() if r.returncode == 0 else ""
-            except (subprocess.TimeoutExpired, FileNotFoundError, OSError):
-                local_sha = ""
+            local_sha = _git_resolve(repo_root, local_ref) or ""
             if local_sha and local_sha != head:
                 debug_log(f"Push sweep: new-branch {local_ref} ({local_sha[:12]}) != HEAD {head[:12]}")
                 emit_metrics({"skipped": True, "skip_reason": 44, **_base})
@@ -1534,7 +1733,7 @@ def handle_push_sweep_posttooluse(input_data):
                       "pushed": len(push_range)})
         sys.exit(0)
 
-    reviewed = _load_reviewed_shas(repo_root)
+    reviewed = _load_reviewed_shas(repo_root, push_range)
     base, tail = _compute_push_sweep_base(prev_upstream, push_range, reviewed)
     prefix_advanced = len(push_range) - len(tail)
     if base is None:
@@ -1559,7 +1758,10 @@ def handle_push_sweep_posttooluse(input_data):
         emit_metrics({**_base, "pushed": len(push_range),
                       "unreviewed": len(tail), "skip_reason": 45})
         sys.exit(0)
-    diff_files = parse_diff_into_files(diff_text)
+    diff_files, _normalized = normalize_diff_files(
+        parse_diff_into_files(diff_text), repo_root)
+    if _normalized:
+        _base = {**_base, "diff_normalized": _normalized}
     if not diff_files:
         emit_metrics({**_base, "pushed": len(push_range),
                       "unreviewed": len(tail), "skip_reason": 30})
@@ -1581,7 +1783,8 @@ def handle_push_sweep_posttooluse(input_data):
                       "unreviewed": len(tail), "skip_reason": 31,
                       "diff_files_count": len(diff_files)})
         sys.exit(0)
-    diff_files, _dropped = _prioritize_diff_files(diff_files, MAX_PUSH_SWEEP_FILES)
+    _file_cap = MAX_PUSH_SWEEP_FILES * (1 if _agentic_commit_review_enabled() else review_shard_budget())
+    diff_files, _dropped = _prioritize_diff_files(diff_files, _file_cap)
     if _dropped:
         _base = {**_base, "diff_files_dropped": _dropped}
 
@@ -1613,14 +1816,17 @@ def handle_push_sweep_posttooluse(input_data):
                 diff_files, is_diff=True, previous_findings=previous_findings
             )
     else:
-        concrete_guidance, vulns = analyze_code_security(
-            diff_files, is_diff=True, previous_findings=previous_findings
+        concrete_guidance, vulns = analyze_code_security_sharded(
+            diff_files, is_diff=True, previous_findings=previous_findings,
+            files_per_shard=MAX_PUSH_SWEEP_FILES,
         )
         agentic_metrics = {}
     review_ms = int((_time.time() - review_start) * 1000)
 
-    # The tail is now covered by this net-diff review.
-    _append_reviewed_shas(repo_root, tail, vulns_found=len(vulns or []))
+    # The tail is now covered by this net-diff review, unless the model call
+    # (or one of its shards) failed.
+    if llm._last_call_claude_http_error is None:
+        _append_reviewed_shas(repo_root, tail, vulns_found=len(vulns or []))
 
     new_vulns, n_deduped = _dedup_against_state(
         session_id, vulns or [], prompted=_finding_keys(previous_findings)
@@ -1732,6 +1938,7 @@ def handle_stop_hook(input_data):
     snap_baseline = baseline_sha  # pre-reassignment value for restore-on-transient-skip
     head_at_capture = snap["head_at_capture"]
     untracked_at_baseline = snap.get("untracked_at_baseline") or {}
+    change_clock = snap.get("change_clock")
     previous_findings = snap["previous_findings"]
 
     # Sweep pattern-warning outcomes (pure local work; stop_hook_active is
@@ -1781,7 +1988,7 @@ def handle_stop_hook(input_data):
         # 50+ for opt-out skips that aren't push-sweep (which owns 40-49).
         _skip(50)
 
-    if not ensure_anthropic_reachable():
+    if not ensure_anthropic_reachable(session_id):
         debug_log("Stop hook: api.anthropic.com unreachable")
         _skip(10, restore=True)
 
@@ -1790,7 +1997,8 @@ def handle_stop_hook(input_data):
         _skip(4)
 
     review_paths, diff_base, repo_root, untracked, v2_metrics = compute_v2_review_set(
-        cwd, baseline_sha, head_at_capture, untracked_at_baseline
+        cwd, baseline_sha, head_at_capture, untracked_at_baseline,
+        touched_paths=touched_paths, change_clock=change_clock,
     )
     if not review_paths:
         debug_log("Stop hook: empty review set")
@@ -1821,7 +2029,8 @@ def handle_stop_hook(input_data):
         _skip(6)
 
     # Parse diff into per-file content
-    diff_files = parse_diff_into_files(diff_output)
+    diff_files, stop_normalized = normalize_diff_files(
+        parse_diff_into_files(diff_output), repo_root)
     if not diff_files:
         debug_log("Stop hook: no source code files in diff")
         _skip(7)
@@ -1837,9 +2046,12 @@ def handle_stop_hook(input_data):
         debug_log(f"Stop hook: pathological diff ({len(diff_files)} files > "
                   f"{10 * MAX_DIFF_FILES}), skipping")
         _skip(8, diff_files_count=len(diff_files))
-    if len(diff_files) > MAX_DIFF_FILES:
+    # Beyond MAX_DIFF_FILES the review is sharded (analyze_code_security_sharded);
+    # only what exceeds every shard's share is dropped.
+    _stop_file_cap = MAX_DIFF_FILES * review_shard_budget()
+    if len(diff_files) > _stop_file_cap:
         diff_files, _stop_dropped = _prioritize_diff_files(
-            diff_files, MAX_DIFF_FILES)
+            diff_files, _stop_file_cap)
         debug_log(f"Stop hook: prioritized to {len(diff_files)} files "
                   f"(dropped {_stop_dropped} lower-risk)")
 
@@ -1854,8 +2066,9 @@ def handle_stop_hook(input_data):
     # Stop hook is single-shot only. Agentic review is wired into
     # handle_commit_review_posttooluse (PostToolUse on `git commit`) — commits
     # are slower-OK and benefit from the deeper context-reading loop.
-    concrete_guidance, vulns = analyze_code_security(
-        diff_files, is_diff=True, previous_findings=previous_findings
+    concrete_guidance, vulns = analyze_code_security_sharded(
+        diff_files, is_diff=True, previous_findings=previous_findings,
+        files_per_shard=MAX_DIFF_FILES,
     )
     # NOTE: analyze_security_concerns disabled — it produces too many false positives
     # on pre-existing patterns in starter code. The concrete vulnerability analysis
@@ -1889,7 +2102,10 @@ def handle_stop_hook(input_data):
             }
             for v in vulns
         ]
-        # Update baseline so next stop hook iteration only sees new changes
+        # Update baseline so next stop hook iteration only sees new changes.
+        # The review ran for a while and the session kept going (asyncRewake),
+        # so HEAD may have moved since it was memoized.
+        clear_git_memo()
         new_sha = capture_git_baseline(cwd)
         new_untracked_baseline = _list_untracked(cwd) if new_sha else None
 
@@ -1939,6 +2155,7 @@ def handle_stop_hook(input_data):
             "fire_index": fire_index,
             **({"diff_truncated": llm._last_review_truncated_bytes}
                if llm._last_review_truncated_bytes else {}),
+            **({"diff_normalized": stop_normalized} if stop_normalized else {}),
             **sweep_trimmed,
         }, rewake_summary=_format_vulns_summary(vulns))
 
@@ -1967,34 +2184,51 @@ def handle_stop_hook(input_data):
         **({"api_error": llm._last_call_claude_http_error} if llm._last_call_claude_http_error is not None else {}),
         **({"diff_truncated": llm._last_review_truncated_bytes}
            if llm._last_review_truncated_bytes else {}),
+        **({"diff_normalized": stop_normalized} if stop_normalized else {}),
         **v2_metrics,
     })
     sys.exit(0)
 
-_SDK_BOOTSTRAP_THROTTLE = os.path.join(
-    os.environ.get("SECURITY_WARNINGS_STATE_DIR")
-    or os.path.expanduser("~/.claude/security"),
-    ".sdk_bootstrap_spawned")
+_SDK_STATE_DIR = (os.environ.get("SECURITY_WARNINGS_STATE_DIR")
+                  or os.path.expanduser("~/.claude/security"))
+_SDK_BOOTSTRAP_THROTTLE = os.path.join(_SDK_STATE_DIR, ".sdk_bootstrap_spawned")
+# Written by ensure_agent_sdk._write_status.
+_SDK_STATUS = os.path.join(_SDK_STATE_DIR, _SDK_STATUS_FILE)
+
+def _sdk_status_settled():
+    """True if the last bootstrap settled the SDK question for this plugin
+    version and interpreter within the TTL. One small file read, so the
+    common case skips the ~10ms find_spec probe and the spawn entirely."""
+    try:
+        with open(_SDK_STATUS) as f:
+            status = json.load(f)
+        import time as _t
+        return (isinstance(status, dict)
+                and status.get("pv") == _PV
+                and status.get("python") == sys.executable
+                and status.get("outcome") in _SDK_STATUS_SETTLED
+                and _t.time() - status.get("ts", 0) < _SDK_STATUS_TTL_S)
+    except Exception:
+        return False
 
 def _maybe_bootstrap_agent_sdk_async():
-    """Fire-and-forget SDK bootstrap, for remote-pod environments.
-
-    Under CLAUDE_CODE_SYNC_PLUGIN_INSTALL=true (CCR-style remote pods),
-    plugins are synced *after* SessionStart fires, so the SessionStart
-    `ensure_agent_sdk.py` hook never runs and the agentic commit reviewer
-    falls back 100% of the time. A PostToolUse hook firing is itself proof
-    the plugin is now registered, so re-trigger the bootstrap here.
-    Detached, so the ~17s venv build never blocks the hook — the first
-    1-2 commits of a remote session still fall back while it builds, then
-    every subsequent commit gets the agentic path. ensure_agent_sdk.py
-    is idempotent and O_EXCL-locked, so concurrent/repeat spawns are safe;
-    the throttle file only avoids spawning dozens of subprocesses during
-    the build window. No-ops in ~10ms on local installs (SDK already
-    importable).
+    """Fire-and-forget SDK bootstrap, deferred to the first hook that needs it.
+
+    There is no SessionStart hook: session start stays free, and under
+    CLAUDE_CODE_SYNC_PLUGIN_INSTALL=true (CCR-style remote pods) plugins
+    are synced *after* SessionStart fires anyway. A UserPromptSubmit or
+    PostToolUse firing is proof the plugin is registered, so the bootstrap
+    is triggered from there whenever the cached status isn't settled —
+    in practice once per plugin version (which also re-byte-compiles the
+    hooks) and once a day after that. Detached, so the ~17s venv build
+    never blocks the hook — on a fresh remote pod the first commit may
+    still fall back while it builds, then every subsequent commit gets the
+    agentic path. ensure_agent_sdk.py is idempotent and O_EXCL-locked, so
+    concurrent/repeat spawns are safe; the throttle file only avoids
+    spawning dozens of subprocesses during the build window.
     """
     try:
-        import importlib.util
-        if importlib.util.find_spec("claude_agent_sdk") is not None:
+        if _sdk_status_settled():
             return
         import time as _t
         try:
@@ -2016,6 +2250,112 @@ def _maybe_bootstrap_agent_sdk_async():
     except Exception:
         pass  # best-effort; never break the hook over a bootstrap attempt
 
+def handle_edit_posttooluse(input_data, content=None):
+    """PostToolUse handler for Edit/Write/MultiEdit/NotebookEdit.
+
+    Pattern-based checks only (no LLM review per-edit). Returns the hook
+    response dict, or None when there is nothing to report. `content` is
+    the edit's new text when the caller (merged hook dispatch) already
+    extracted it.
+    """
+    session_id = input_data.get("session_id", "default")
+    tool_name = input_data.get("tool_name", "")
+    tool_input = input_data.get("tool_input", {})
+    file_path = tool_input.get("file_path") or tool_input.get("notebook_path") or ""
+    if not file_path:
+        return None
+
+    # Skip plan files
+    plans_dir = os.path.expanduser("~/.claude/plans")
+    if file_path.startswith(plans_dir):
+        return None
+
+    record_touched_path(session_id, file_path)
+
+    all_guidance = []
+    raw_pattern_matches = []
+    raw_mask = 0
+    if ENABLE_PATTERN_RULES:
+        hunks = extract_content_hunks(tool_name, tool_input, file_path, content)
+        pattern_matches, raw_mask = scan_content_hunks(session_id, file_path, hunks)
+        raw_pattern_matches = pattern_matches
+        if pattern_matches:
+            debug_log(f"Pattern matches for {file_path}: {[r for r, _ in pattern_matches]}")
+
+        # For Write tool, filter out patterns that existed in the baseline version
+        # This prevents flagging pre-existing insecure patterns when Claude rewrites a file
+        if tool_name == "Write" and pattern_matches:
+            cwd = os.environ.get("CLAUDE_PROJECT_DIR", os.getcwd())
+            baseline_content = get_baseline_file_content(session_id, file_path, cwd)
+            if baseline_content is not None:
+                baseline_matches = set(r for r, _ in check_patterns(file_path, baseline_content))
+                pattern_matches = [(r, msg) for r, msg in pattern_matches if r not in baseline_matches]
+                if pattern_matches:
+                    debug_log(f"New patterns (not in baseline): {[r for r, _ in pattern_matches]}")
+                else:
+                    debug_log("All patterns existed in baseline, skipping")
+
+        for rule_name, reminder in pattern_matches:
+            warning_key = f"{file_path}-{rule_name}"
+            if atomic_check_and_mark_warning(session_id, warning_key):
+                all_guidance.append(reminder)
+
+        # Record matched rules as pending so the Stop-hook sweep can
+        # later tally fixed vs unresolved. Only runs when patterns match.
+        if pattern_matches:
+            record_pending_warnings(session_id, file_path,
+                                    [r for r, _ in pattern_matches])
+
+    # Emit metrics when raw patterns matched (even if all were baseline-suppressed
+    # or dedup'd — pattern_hits reflects warnings actually shown, may be 0).
+    # Gate on raw matches so clean edits don't flood the metrics event.
+    #   rule_id:   RuleId of the first raw match (values stay small/enumerable in telemetry)
+    #   rule_mask: bitmask of ALL raw matches — POPCOUNT gives raw hit count,
+    #              (mask >> N) & 1 tests for a specific rule
+    if raw_pattern_matches:
+        raw_names = [r for r, _ in raw_pattern_matches]
+        output = {"metrics": {
+            "pattern_hits": len(all_guidance),
+            # User-defined patterns (rule_name="user:*") have no static
+            # RuleId; emit -1 so the metrics pipeline can distinguish.
+            "rule_id": int(_RULE_NAME_TO_ID.get(raw_names[0], -1)),
+            "rule_mask": raw_mask,
+            **({"pv": _PV} if _PV else {}),
+        }}
+        if all_guidance:
+            output["hookSpecificOutput"] = {
+                "hookEventName": "PostToolUse",
+                "additionalContext": PROVENANCE_TAG + "\n\n" + "\n\n".join(all_guidance),
+            }
+        return output
+    if all_guidance:
+        # Defensive: pattern rules disabled but guidance somehow set (shouldn't happen)
+        return {
+            "hookSpecificOutput": {
+                "hookEventName": "PostToolUse",
+                "additionalContext": PROVENANCE_TAG + "\n\n" + "\n\n".join(all_guidance),
+            }
+        }
+    return None
+
+# Merged hook dispatch (hooks/hook_dispatch.py) calls dispatch() in-process
+# for the tools the Edit hooks.json entry matches.
+DISPATCH_MATCHER = "Edit|Write|MultiEdit|NotebookEdit"
+
+def dispatch(ctx):
+    """Merged hook dispatch entry: main()'s Edit path on a parsed HookContext."""
+    if SECURITY_GUIDANCE_DISABLED:
+        return {"metrics": {"skipped": True, "skip_reason": -1}}
+    if random.random() < 0.1:
+        cleanup_old_state_files()
+    finish_timing = start_hook_timing(ctx.input, ctx.raw)
+    try:
+        extensibility.load_for_session(ctx.cwd)
+        _maybe_bootstrap_agent_sdk_async()
+        return handle_edit_posttooluse(ctx.input, content=ctx.new_content)
+    finally:
+        finish_timing()
+
 def main():
     """Main hook function."""
     debug_log(f"Hook called with args: {sys.argv}")
@@ -2040,10 +2380,9 @@ def main():
         debug_log(f"JSON decode error: {e}")
         emit_metrics({"skipped": True, "skip_reason": -2})
         sys.exit(0)
+    start_hook_timing(input_data, raw_input)
 
-    session_id = input_data.get("session_id", "default")
     tool_name = input_data.get("tool_name", "")
-    tool_input = input_data.get("tool_input", {})
     hook_event_name = input_data.get("hook_event_name", "")
     debug_log(f"Processing: hook_event={hook_event_name}, tool={tool_name}")
 
@@ -2052,13 +2391,12 @@ def main():
     # config never prevents the built-in checks from running.
     extensibility.load_for_session(input_data.get("cwd"))
 
-    # Remote-pod SDK-bootstrap rescue: PostToolUse is the earliest hook event
-    # that is guaranteed to fire *after* async plugin sync (its firing proves
-    # the plugin is registered), so it's where we recover the SessionStart
-    # bootstrap that remote pods miss under CLAUDE_CODE_SYNC_PLUGIN_INSTALL.
-    # Fires on Edit/Write too (not just Bash), so the venv is usually built
-    # before the first `git commit`.
-    if hook_event_name == "PostToolUse":
+    # Deferred SDK bootstrap: both events fire only once the plugin is
+    # registered (after async plugin sync on remote pods), and the first
+    # prompt comes well before the first `git commit`, so the venv is
+    # usually built by the time the agentic reviewer wants it. A settled
+    # status makes this one small file read.
+    if hook_event_name in ("UserPromptSubmit", "PostToolUse"):
         _maybe_bootstrap_agent_sdk_async()
 
     # Handle UserPromptSubmit — capture git baseline
@@ -2068,6 +2406,7 @@ def main():
 
     # Handle Stop hook — final security check
     if hook_event_name == "Stop":
+        _load_review_modules()
         handle_stop_hook(input_data)
         return
 
@@ -2102,6 +2441,7 @@ def main():
             # metric so telemetry can count how often the de-dupe kicks in.
             print(json.dumps({"metrics": {"bash_hook_dedup": True}}), flush=True)
             sys.exit(0)
+        _load_review_modules()
         if _GIT_COMMIT_RE.search(cmd):
             handle_commit_review_posttooluse(input_data)
         elif _GIT_PUSH_RE.search(cmd):
@@ -2110,81 +2450,9 @@ def main():
 
     # Handle PostToolUse — pattern-based checks only (no LLM review per-edit)
     if tool_name in ["Edit", "Write", "MultiEdit", "NotebookEdit"]:
-        file_path = tool_input.get("file_path") or tool_input.get("notebook_path") or ""
-        if not file_path:
-            sys.exit(0)
-
-        # Skip plan files
-        plans_dir = os.path.expanduser("~/.claude/plans")
-        if file_path.startswith(plans_dir):
-            sys.exit(0)
-
-        record_touched_path(session_id, file_path)
-
-        content = extract_content_from_input(tool_name, tool_input)
-
-        all_guidance = []
-        raw_pattern_matches = []
-        if ENABLE_PATTERN_RULES:
-            pattern_matches = check_patterns(file_path, content)
-            raw_pattern_matches = pattern_matches
-            if pattern_matches:
-                debug_log(f"Pattern matches for {file_path}: {[r for r, _ in pattern_matches]}")
-
-            # For Write tool, filter out patterns that existed in the baseline version
-            # This prevents flagging pre-existing insecure patterns when Claude rewrites a file
-            if tool_name == "Write" and pattern_matches:
-                cwd = os.environ.get("CLAUDE_PROJECT_DIR", os.getcwd())
-                baseline_content = get_baseline_file_content(session_id, file_path, cwd)
-                if baseline_content is not None:
-                    baseline_matches = set(r for r, _ in check_patterns(file_path, baseline_content))
-                    pattern_matches = [(r, msg) for r, msg in pattern_matches if r not in baseline_matches]
-                    if pattern_matches:
-                        debug_log(f"New patterns (not in baseline): {[r for r, _ in pattern_matches]}")
-                    else:
-                        debug_log("All patterns existed in baseline, skipping")
-
-            for rule_name, reminder in pattern_matches:
-                warning_key = f"{file_path}-{rule_name}"
-                if atomic_check_and_mark_warning(session_id, warning_key):
-                    all_guidance.append(reminder)
-
-            # Record matched rules as pending so the Stop-hook sweep can
-            # later tally fixed vs unresolved. Only runs when patterns match.
-            if pattern_matches:
-                record_pending_warnings(session_id, file_path,
-                                        [r for r, _ in pattern_matches])
-
-        # Emit metrics when raw patterns matched (even if all were baseline-suppressed
-        # or dedup'd — pattern_hits reflects warnings actually shown, may be 0).
-        # Gate on raw matches so clean edits don't flood the metrics event.
-        #   rule_id:   RuleId of the first raw match (values stay small/enumerable in telemetry)
-        #   rule_mask: bitmask of ALL raw matches — POPCOUNT gives raw hit count,
-        #              (mask >> N) & 1 tests for a specific rule
-        if raw_pattern_matches:
-            raw_names = [r for r, _ in raw_pattern_matches]
-            output = {"metrics": {
-                "pattern_hits": len(all_guidance),
-                # User-defined patterns (rule_name="user:*") have no static
-                # RuleId; emit -1 so the metrics pipeline can distinguish.
-                "rule_id": int(_RULE_NAME_TO_ID.get(raw_names[0], -1)),
-                "rule_mask": rule_names_to_mask(raw_names),
-                **({"pv": _PV} if _PV else {}),
-            }}
-            if all_guidance:
-                output["hookSpecificOutput"] = {
-                    "hookEventName": "PostToolUse",
-                    "additionalContext": PROVENANCE_TAG + "\n\n" + "\n\n".join(all_guidance),
-                }
+        output = handle_edit_posttooluse(input_data)
+        if output:
             print(json.dumps(output))
-        elif all_guidance:
-            # Defensive: pattern rules disabled but guidance somehow set (shouldn't happen)
-            print(json.dumps({
-                "hookSpecificOutput": {
-                    "hookEventName": "PostToolUse",
-                    "additionalContext": PROVENANCE_TAG + "\n\n" + "\n\n".join(all_guidance),
-                }
-            }))
 
     sys.exit(0)
 
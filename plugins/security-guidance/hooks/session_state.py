@@ -1,9 +1,24 @@
 """
 Per-session state-file plumbing for the security-guidance plugin.
 
-Holds the JSON state file location, fcntl-locked read-modify-write helper,
-and old-file GC. Side-effect-free at import time (no env-var reads beyond
-``CLAUDE_CODE_REMOTE_SESSION_ID`` inside the helpers).
+Holds the state store location, the locked read-modify-write helper, and
+old-file GC. Side-effect-free at import time (env vars are only read inside
+the helpers).
+
+Storage: by default each session's state lives in a SQLite database in WAL
+mode, one row per top-level key, except the append-only lists
+``shown_warnings`` and ``touched_paths``, which get one row per member.
+``with_locked_state`` hands the callback a dict that reads a key from the
+database the first time the callback touches it, and on return writes back
+only what changed: a key whose JSON differs, or for a member list the
+members added or dropped. An Edit that records one touched path inserts one
+row; it no longer rewrites the path list, ``shown_warnings`` or any other
+key. ``BEGIN IMMEDIATE`` replaces the flock, which also gives Windows real
+locking.
+
+``SECURITY_STATE_BACKEND=json`` (or a Python without sqlite3) keeps the
+legacy flock + whole-file JSON format. An existing JSON state file is
+imported into the database the first time a session opens it.
 
 The ``atomic_check_*`` helpers that build on ``with_locked_state`` deliberately
 remain in ``security_reminder_hook.py`` so that tests which monkeypatch
@@ -19,6 +34,11 @@ import os
 import re
 from datetime import datetime
 
+try:
+    import sqlite3
+except ImportError:  # Python built without _sqlite3
+    sqlite3 = None
+
 from _base import debug_log
 
 
@@ -46,6 +66,19 @@ def get_lock_file(session_id):
     return os.path.join(state_dir, f"security_warnings_state_{_state_key(session_id)}.lock")
 
 
+def get_db_file(session_id):
+    """Get session-specific SQLite state database path."""
+    state_dir = os.environ.get("SECURITY_WARNINGS_STATE_DIR", os.path.expanduser("~/.claude/security"))
+    return os.path.join(state_dir, f"security_warnings_state_{_state_key(session_id)}.db")
+
+
+def _use_sqlite():
+    return sqlite3 is not None and os.environ.get("SECURITY_STATE_BACKEND", "sqlite") != "json"
+
+
+_STATE_FILE_SUFFIXES = (".json", ".lock", ".db", ".db-wal", ".db-shm", ".index", ".stamp")
+
+
 def cleanup_old_state_files():
     """Remove state files and lock files older than 30 days."""
     try:
@@ -58,7 +91,7 @@ def cleanup_old_state_files():
 
         for filename in os.listdir(state_dir):
             if filename.startswith("security_warnings_state_") and (
-                filename.endswith(".json") or filename.endswith(".lock")
+                filename.endswith(_STATE_FILE_SUFFIXES)
             ):
                 file_path = os.path.join(state_dir, filename)
                 try:
@@ -86,7 +119,28 @@ def cleanup_old_state_files():
 
 
 def load_state(session_id):
-    """Load the full state dict from file."""
+    """Load the full state dict (a plain-dict snapshot)."""
+    if _use_sqlite():
+        snapshot = with_locked_state(session_id, lambda st: {k: st[k] for k in st.keys()})
+        return snapshot or {"shown_warnings": []}
+    return _load_json_state(session_id)
+
+
+def save_state(session_id, state):
+    """Replace the full state with ``state``."""
+    if _use_sqlite():
+        def _replace(current):
+            for key in list(current):
+                if key not in state:
+                    del current[key]
+            current.update(state)
+        with_locked_state(session_id, _replace)
+        return
+    _save_json_state(session_id, state)
+
+
+def _load_json_state(session_id):
+    """Load the full state dict from the legacy JSON file."""
     state_file = get_state_file(session_id)
     try:
         with open(state_file, "r") as f:
@@ -101,8 +155,8 @@ def load_state(session_id):
     return {"shown_warnings": []}
 
 
-def save_state(session_id, state):
-    """Save the full state dict to file."""
+def _save_json_state(session_id, state):
+    """Save the full state dict to the legacy JSON file."""
     state_file = get_state_file(session_id)
     try:
         state_dir = os.path.dirname(state_file)
@@ -115,13 +169,283 @@ def save_state(session_id, state):
         debug_log(f"Failed to save state file {state_file}: {e}")
 
 
+# ── SQLite backend ───────────────────────────────────────────────────────────
+
+# How long a writer waits for a concurrent hook (parallel subagents) before
+# giving up. Critical sections are single-row updates, so contention clears
+# in milliseconds; this only bounds a wedged peer.
+SQLITE_BUSY_TIMEOUT_SEC = 10.0
+
+# Keys callbacks index directly without a .get() default.
+_STATE_DEFAULTS = {"shown_warnings": list}
+
+# Lists callbacks only append to and trim (deduped, order kept), stored one
+# row per member in ``members`` so an append is an INSERT OR IGNORE rather
+# than a rewrite of the whole list. An empty list is stored as no rows.
+_MEMBER_KEYS = ("shown_warnings", "touched_paths")
+
+_UNREAD = object()
+
+
+class _LazyState(dict):
+    """State dict backed by the ``state`` and ``members`` tables of an open
+    transaction.
+
+    A top-level key is read on first access (index, get, setdefault, in,
+    pop, del); iterating loads every key. ``_flush`` writes back only keys
+    whose JSON differs from what was read, and deletes removed ones. A
+    ``_MEMBER_KEYS`` list is written as a row diff (``_flush_members``).
+    """
+
+    def __init__(self, conn):
+        super().__init__()
+        self._conn = conn
+        # key -> JSON text as stored, None if absent; for a member key,
+        # (member JSON texts in order, highest pos) instead of the text.
+        self._read = {}
+        self._read_all = False
+
+    def _fault(self, key):
+        if key in self._read or not isinstance(key, str):
+            return
+        if key in _MEMBER_KEYS:
+            rows = self._conn.execute(
+                "SELECT member, pos FROM members WHERE key = ? ORDER BY pos", (key,)
+            ).fetchall()
+            self._read[key] = self._store_members(key, rows)
+        else:
+            row = self._conn.execute("SELECT value FROM state WHERE key = ?", (key,)).fetchone()
+            self._read[key] = self._store(key, row[0] if row else None)
+        if key not in self and key in _STATE_DEFAULTS:
+            dict.__setitem__(self, key, _STATE_DEFAULTS[key]())
+
+    def _store(self, key, text):
+        if text is None:
+            return None
+        try:
+            dict.__setitem__(self, key, json.loads(text))
+        except ValueError:
+            return None  # corrupt row: treat as absent, rewritten on flush
+        return text
+
+    def _store_members(self, key, rows):
+        if not rows:
+            return None
+        members = []
+        for text, _ in rows:
+            try:
+                members.append(json.loads(text))
+            except ValueError:
+                pass  # corrupt row: dropped from the list, deleted on flush
+        dict.__setitem__(self, key, members)
+        return tuple(text for text, _ in rows), rows[-1][1]
+
+    def _fault_all(self):
+        if self._read_all:
+            return
+        for key, text in self._conn.execute("SELECT key, value FROM state"):
+            if key not in self._read and key not in _MEMBER_KEYS:
+                self._read[key] = self._store(key, text)
+        for key in _MEMBER_KEYS + tuple(_STATE_DEFAULTS):
+            self._fault(key)
+        self._read_all = True
+
+    def __missing__(self, key):
+        self._fault(key)
+        if dict.__contains__(self, key):
+            return dict.__getitem__(self, key)
+        raise KeyError(key)
+
+    def __contains__(self, key):
+        self._fault(key)
+        return dict.__contains__(self, key)
+
+    def get(self, key, default=None):
+        self._fault(key)
+        return dict.get(self, key, default)
+
+    def setdefault(self, key, default=None):
+        self._fault(key)
+        return dict.setdefault(self, key, default)
+
+    def pop(self, key, *default):
+        self._fault(key)
+        return dict.pop(self, key, *default)
+
+    def __setitem__(self, key, value):
+        self._read.setdefault(key, _UNREAD)
+        dict.__setitem__(self, key, value)
+
+    def __delitem__(self, key):
+        self._fault(key)
+        dict.__delitem__(self, key)
+
+    def update(self, *args, **kwargs):
+        for key, value in dict(*args, **kwargs).items():
+            self[key] = value
+
+    def __iter__(self):
+        self._fault_all()
+        return dict.__iter__(self)
+
+    def __len__(self):
+        self._fault_all()
+        return dict.__len__(self)
+
+    def keys(self):
+        self._fault_all()
+        return dict.keys(self)
+
+    def items(self):
+        self._fault_all()
+        return dict.items(self)
+
+    def values(self):
+        self._fault_all()
+        return dict.values(self)
+
+    def _flush(self):
+        for key, original in self._read.items():
+            if key in _MEMBER_KEYS:
+                self._flush_members(key, original)
+            elif dict.__contains__(self, key):
+                text = json.dumps(dict.__getitem__(self, key))
+                if text != original:
+                    self._conn.execute(
+                        "INSERT INTO state (key, value) VALUES (?, ?) "
+                        "ON CONFLICT(key) DO UPDATE SET value = excluded.value",
+                        (key, text),
+                    )
+            elif original is not None:
+                self._conn.execute("DELETE FROM state WHERE key = ?", (key,))
+
+    def _flush_members(self, key, original):
+        value = dict.get(self, key, [])
+        if not isinstance(value, (list, tuple)):
+            debug_log(f"State key {key} is not a list; storing it empty")
+            value = []
+        new = list(dict.fromkeys(json.dumps(m) for m in value))
+        if original is _UNREAD:
+            old, top = None, 0  # assigned without reading: replace every row
+        else:
+            old, top = original or ((), 0)
+            if tuple(new) == old:
+                return
+        kept = set(new)
+        survivors = [m for m in old if m in kept] if old is not None else None
+        if survivors is not None and new[:len(survivors)] == survivors:
+            # Members trimmed and appended, order kept: touch only those rows.
+            self._conn.executemany(
+                "DELETE FROM members WHERE key = ? AND member = ?",
+                [(key, m) for m in old if m not in kept],
+            )
+            added = new[len(survivors):]
+        else:
+            self._conn.execute("DELETE FROM members WHERE key = ?", (key,))
+            added, top = new, 0
+        self._conn.executemany(
+            "INSERT OR IGNORE INTO members (key, member, pos) VALUES (?, ?, ?)",
+            [(key, m, top + i) for i, m in enumerate(added, 1)],
+        )
+
+
+def _open_db(session_id):
+    db_file = get_db_file(session_id)
+    conn = sqlite3.connect(db_file, timeout=SQLITE_BUSY_TIMEOUT_SEC, isolation_level=None)
+    try:
+        conn.execute("PRAGMA journal_mode=WAL")
+        conn.execute("PRAGMA synchronous=NORMAL")
+        conn.execute("CREATE TABLE IF NOT EXISTS state (key TEXT PRIMARY KEY, value TEXT NOT NULL)")
+        conn.execute(
+            "CREATE TABLE IF NOT EXISTS members (key TEXT NOT NULL, member TEXT NOT NULL, "
+            "pos INTEGER NOT NULL, PRIMARY KEY (key, member)) WITHOUT ROWID"
+        )
+    except BaseException:
+        conn.close()
+        raise
+    return conn
+
+
+def _migrate_json_state(session_id, conn):
+    """Import a legacy JSON state file once (user_version 0 → 1)."""
+    if conn.execute("PRAGMA user_version").fetchone()[0] >= 1:
+        return
+    if os.path.exists(get_state_file(session_id)):
+        legacy = _load_json_state(session_id)
+        conn.executemany(
+            "INSERT OR IGNORE INTO state (key, value) VALUES (?, ?)",
+            [(k, json.dumps(v)) for k, v in legacy.items() if isinstance(k, str)],
+        )
+        debug_log(f"Imported {len(legacy)} legacy state keys into SQLite")
+    conn.execute("PRAGMA user_version = 1")
+
+
+def _migrate_member_rows(conn):
+    """Split whole-list ``_MEMBER_KEYS`` rows into ``members`` (1 → 2)."""
+    if conn.execute("PRAGMA user_version").fetchone()[0] >= 2:
+        return
+    for key in _MEMBER_KEYS:
+        row = conn.execute("SELECT value FROM state WHERE key = ?", (key,)).fetchone()
+        if row is None:
+            continue
+        try:
+            members = json.loads(row[0])
+        except ValueError:
+            members = []
+        if isinstance(members, list):
+            conn.executemany(
+                "INSERT OR IGNORE INTO members (key, member, pos) VALUES (?, ?, ?)",
+                [(key, json.dumps(m), i) for i, m in enumerate(members, 1)],
+            )
+        conn.execute("DELETE FROM state WHERE key = ?", (key,))
+    conn.execute("PRAGMA user_version = 2")
+
+
+def _with_sqlite_state(session_id, callback):
+    try:
+        os.makedirs(os.path.dirname(get_db_file(session_id)), exist_ok=True)
+    except OSError:
+        pass
+
+    conn = None
+    try:
+        conn = _open_db(session_id)
+        conn.execute("BEGIN IMMEDIATE")
+        try:
+            _migrate_json_state(session_id, conn)
+            _migrate_member_rows(conn)
+            state = _LazyState(conn)
+            result = callback(state)
+            state._flush()
+            conn.execute("COMMIT")
+        except BaseException:
+            try:
+                conn.execute("ROLLBACK")
+            except sqlite3.Error:
+                pass
+            raise
+        return result
+
+    except (sqlite3.Error, OSError, IOError) as e:
+        debug_log(f"Lock/state operation failed: {e}")
+        return None
+
+    finally:
+        if conn is not None:
+            conn.close()
+
+
 def with_locked_state(session_id, callback):
     """
     Execute callback with exclusive access to the state file.
     The callback receives the state dict and can modify it in place.
     State is saved after the callback returns.
-    Returns the callback's return value.
+    Returns the callback's return value, or None if the state store is
+    unavailable.
     """
+    if _use_sqlite():
+        return _with_sqlite_state(session_id, callback)
+
     lock_file = get_lock_file(session_id)
     state_dir = os.path.dirname(lock_file)
 
@@ -132,9 +456,9 @@ def with_locked_state(session_id, callback):
 
     if fcntl is None:
         # No file locking available (Windows) — run without locking
-        state = load_state(session_id)
+        state = _load_json_state(session_id)
         result = callback(state)
-        save_state(session_id, state)
+        _save_json_state(session_id, state)
         return result
 
     lock_fd = None
@@ -142,9 +466,9 @@ def with_locked_state(session_id, callback):
         lock_fd = os.open(lock_file, os.O_RDWR | os.O_CREAT)
         fcntl.flock(lock_fd, fcntl.LOCK_EX)
 
-        state = load_state(session_id)
+        state = _load_json_state(session_id)
         result = callback(state)
-        save_state(session_id, state)
+        _save_json_state(session_id, state)
         return result
 
     except (OSError, IOError) as e:
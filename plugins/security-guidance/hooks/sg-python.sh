@@ -20,8 +20,78 @@
 # interpreter, so the hooks.json invocation is:
 #   bash "${CLAUDE_PLUGIN_ROOT}/hooks/sg-python.sh" \
 #        "${CLAUDE_PLUGIN_ROOT}/hooks/security_reminder_hook.py"
+#
+# Probing costs at least one extra interpreter start per hook (several on
+# Windows), so the winner's resolved path is cached in
+# $SECURITY_WARNINGS_STATE_DIR/python-interpreter, one line per
+# (plugin version, PATH) pair. A hit is a single exec; a cached binary that
+# is gone or no longer executable falls back to the full probe. The cached
+# interpreter can't be retried once exec'd (that would run the hook twice),
+# so only a probe's winner is ever cached. SG_PYTHON_CACHE=0 disables it.
 set -e
 
+# Hook timings' startup_ms runs from here (see _base.take_startup_ms); kept
+# if dispatch.sh already set it. EPOCHREALTIME needs bash 5.
+if [ "${CLAUDE_HOOK_TIMINGS:-0}" = "1" ] && [ -z "${CLAUDE_HOOK_TIMING_T0:-}" ] && [ -n "${EPOCHREALTIME:-}" ]; then
+    export CLAUDE_HOOK_TIMING_T0="$EPOCHREALTIME"
+fi
+
+STATE_DIR="${SECURITY_WARNINGS_STATE_DIR:-$HOME/.claude/security}"
+CACHE_FILE="$STATE_DIR/python-interpreter"
+CACHE_MAX_ENTRIES=8
+TAB=$'\t'
+
+plugin_version() {
+    # Bash-only read of .claude-plugin/plugin.json's "version" (no subprocess).
+    local line re='"version"[[:space:]]*:[[:space:]]*"([^"]*)"'
+    local manifest
+    manifest="$(dirname "${BASH_SOURCE[0]}")/../.claude-plugin/plugin.json"
+    [ -r "$manifest" ] || return 0
+    while IFS= read -r line || [ -n "$line" ]; do
+        if [[ $line =~ $re ]]; then
+            printf '%s' "${BASH_REMATCH[1]}"
+            return 0
+        fi
+    done < "$manifest"
+}
+
+KEY="$(plugin_version)${TAB}${PATH}"
+
+if [ "${SG_PYTHON_CACHE:-1}" != "0" ] && [ -r "$CACHE_FILE" ]; then
+    # The cache is read on fd 3: stdin is the hook input, and the exec'd
+    # interpreter must inherit it rather than the rest of the cache file.
+    while IFS="$TAB" read -r -u 3 version path bin arg; do
+        if [ "${version}${TAB}${path}" = "$KEY" ] && [ -n "$bin" ] && [ -f "$bin" ] && [ -x "$bin" ]; then
+            if [ -n "$arg" ]; then
+                exec "$bin" "$arg" "$@" 3<&-
+            fi
+            exec "$bin" "$@" 3<&-
+        fi
+    done 3< "$CACHE_FILE"
+fi
+
+remember() {
+    # $1: resolved interpreter path, $2: optional extra arg (`-3` for py).
+    # Best-effort: a read-only or missing state dir just means no cache.
+    [ "${SG_PYTHON_CACHE:-1}" != "0" ] || return 0
+    {
+        mkdir -p "$STATE_DIR" || return 0
+        local tmp="$CACHE_FILE.$$" n=1 line
+        printf '%s\t%s\t%s\n' "$KEY" "$1" "${2:-}" > "$tmp" || return 0
+        if [ -r "$CACHE_FILE" ]; then
+            while IFS= read -r line; do
+                case "$line" in
+                    "$KEY$TAB"*) continue ;;
+                esac
+                [ "$n" -lt "$CACHE_MAX_ENTRIES" ] || break
+                printf '%s\n' "$line" >> "$tmp"
+                n=$((n + 1))
+            done < "$CACHE_FILE"
+        fi
+        mv -f "$tmp" "$CACHE_FILE" || rm -f "$tmp"
+    } 2>/dev/null || true
+}
+
 probe() {
     # $1..N: the interpreter command (may be multi-word like `py -3`)
     # Probe writes the major version to stdout and exits 0 iff it's >=3.
@@ -34,7 +104,12 @@ for cmd in "python3" "python" "py -3"; do
     v=$(probe $cmd) || continue
     if [ "$v" = "3" ]; then
         # shellcheck disable=SC2086
-        exec $cmd "$@"
+        set -- $cmd "$@"
+        bin=$(command -v "$1") || bin=""
+        case "$bin" in
+            /*|[A-Za-z]:*) remember "$bin" "$([ "$cmd" = "py -3" ] && echo -3)" ;;
+        esac
+        exec "$@"
     fi
 done
 
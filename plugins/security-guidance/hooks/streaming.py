@@ -0,0 +1,241 @@
+"""
+SSE reading and incremental structured-output parsing for /v1/messages.
+
+With ``"stream": true`` the API sends server-sent events. The text block carrying
+the structured-output JSON arrives as ``text_delta`` fragments. ``read_message``
+rebuilds the same response dict the non-streaming endpoint returns (content blocks,
+usage, model), so ``_call_claude``'s parsing is unchanged. Along the way it feeds the
+JSON text to a ``StreamedObject``, which:
+
+- calls ``on_item`` with each element of the findings array as soon as that
+  element's closing brace arrives;
+- reports ``done`` once the top-level flag is ``false`` and the findings array has
+  closed empty. The rest of the stream carries nothing the caller uses, so
+  ``read_message`` returns immediately (the caller then drops the connection
+  instead of draining it).
+
+Only the two top-level keys the review schemas share (a boolean flag and an
+array) are tracked. Everything else is skipped structurally.
+"""
+import io
+import json
+import urllib.error
+from typing import Any, Callable, Dict, Optional
+
+from _base import debug_log
+
+# SSE error event type -> HTTP status _call_claude's retry policy keys on.
+_ERROR_STATUS = {
+    "overloaded_error": 529,
+    "rate_limit_error": 429,
+    "api_error": 500,
+    "timeout_error": 504,
+    "invalid_request_error": 400,
+    "authentication_error": 401,
+    "permission_error": 403,
+    "request_too_large": 413,
+}
+
+
+class StreamedObject:
+    """Incremental scanner over a JSON object's text, fed in fragments."""
+
+    def __init__(self, bool_key: str, list_key: str,
+                 on_item: Optional[Callable[[Any], None]] = None):
+        self.bool_key = bool_key
+        self.list_key = list_key
+        self.on_item = on_item
+        self.flag: Optional[bool] = None
+        self.items = 0
+        self.list_closed = False
+        self._buf = ""
+        self._stack = []
+        self._in_str = False
+        self._esc = False
+        self._expect_key = False
+        self._key_start: Optional[int] = None
+        self._key: Optional[str] = None
+        self._val_start: Optional[int] = None
+        self._item_start: Optional[int] = None
+
+    @property
+    def done(self) -> bool:
+        """Flag decided false and the findings array closed empty."""
+        return self.flag is False and self.list_closed and self.items == 0
+
+    def _in_list(self) -> bool:
+        return (len(self._stack) == 2 and self._stack[1] == "["
+                and self._key == self.list_key)
+
+    def _scalar_value(self, end: int) -> None:
+        if self._val_start is None:
+            return
+        text = self._buf[self._val_start:end].strip()
+        self._val_start = None
+        if self._key == self.bool_key:
+            try:
+                value = json.loads(text)
+            except ValueError:
+                return
+            if isinstance(value, bool):
+                self.flag = value
+
+    def _item(self, end: int) -> None:
+        if self._item_start is None:
+            return
+        text = self._buf[self._item_start:end].strip()
+        self._item_start = None
+        if not text:
+            return
+        self.items += 1
+        if self.on_item is None:
+            return
+        try:
+            item = json.loads(text)
+        except ValueError:
+            return
+        try:
+            self.on_item(item)
+        except Exception as e:
+            debug_log(f"stream on_item callback failed: {e}")
+
+    def feed(self, chunk: str) -> None:
+        base = len(self._buf)
+        self._buf += chunk
+        for offset, c in enumerate(chunk):
+            pos = base + offset
+            depth = len(self._stack)
+            if self._in_str:
+                if self._esc:
+                    self._esc = False
+                elif c == "\\":
+                    self._esc = True
+                elif c == '"':
+                    self._in_str = False
+                    if self._key_start is not None:
+                        try:
+                            self._key = json.loads(self._buf[self._key_start:pos + 1])
+                        except ValueError:
+                            self._key = None
+                        self._key_start = None
+                continue
+            if c in " \t\r\n":
+                continue
+            if c == '"':
+                self._in_str = True
+                if depth == 1 and self._expect_key:
+                    self._key_start = pos
+                elif depth == 1 and self._val_start is None:
+                    self._val_start = pos
+                elif self._in_list() and self._item_start is None:
+                    self._item_start = pos
+            elif c in "{[":
+                if depth == 1 and not self._expect_key and self._val_start is None:
+                    self._val_start = pos
+                elif self._in_list() and self._item_start is None:
+                    self._item_start = pos
+                self._stack.append(c)
+                if len(self._stack) == 1:
+                    self._expect_key = True
+            elif c in "}]":
+                if not self._stack:
+                    continue
+                if len(self._stack) == 2 and c == "]" and self._in_list():
+                    self._item(pos)
+                    self.list_closed = True
+                self._stack.pop()
+                depth = len(self._stack)
+                if depth == 2 and self._in_list():
+                    self._item(pos + 1)
+                elif depth == 1:
+                    self._val_start = None
+                elif depth == 0:
+                    self._scalar_value(pos)
+            elif c == ":":
+                if depth == 1:
+                    self._expect_key = False
+                    self._val_start = None
+            elif c == ",":
+                if depth == 1:
+                    self._scalar_value(pos)
+                    self._expect_key = True
+                elif self._in_list():
+                    self._item(pos)
+            else:
+                if depth == 1 and not self._expect_key and self._val_start is None:
+                    self._val_start = pos
+                elif self._in_list() and self._item_start is None:
+                    self._item_start = pos
+
+
+def _events(response):
+    """Yield (event type, data dict) per SSE event."""
+    data_lines = []
+    while True:
+        raw = response.readline()
+        if not raw:
+            break
+        line = raw.decode("utf-8", "replace").rstrip("\r\n")
+        if line.startswith("data:"):
+            data_lines.append(line[5:].lstrip())
+        elif not line and data_lines:
+            try:
+                data = json.loads("\n".join(data_lines))
+            except ValueError:
+                data = {}
+            data_lines = []
+            if isinstance(data, dict):
+                yield data.get("type", ""), data
+
+
+def _stream_error(url: str, data: Dict[str, Any]) -> urllib.error.HTTPError:
+    err = data.get("error") or {}
+    status = _ERROR_STATUS.get(err.get("type", ""), 500)
+    body = json.dumps(data).encode("utf-8")
+    return urllib.error.HTTPError(url, status, err.get("message", "stream error"),
+                                  None, io.BytesIO(body))
+
+
+def read_message(response, url: str, bool_key: Optional[str] = None,
+                 list_key: Optional[str] = None,
+                 on_item: Optional[Callable[[Any], None]] = None) -> Dict[str, Any]:
+    """Consume a /v1/messages SSE stream into a non-streaming response dict.
+
+    An ``error`` event raises HTTPError with the matching status.
+    When the review outcome is settled early (see StreamedObject.done), the
+    text is replaced with the equivalent complete JSON and reading stops.
+    """
+    message: Dict[str, Any] = {"content": [], "usage": {}}
+    scanner = StreamedObject(bool_key, list_key, on_item) if bool_key and list_key else None
+    blocks: Dict[int, Dict[str, Any]] = {}
+    for event, data in _events(response):
+        if event == "message_start":
+            start = data.get("message") or {}
+            message["model"] = start.get("model")
+            message["usage"].update(start.get("usage") or {})
+        elif event == "content_block_start":
+            block = dict(data.get("content_block") or {})
+            if block.get("type") == "text":
+                block["text"] = block.get("text") or ""
+            blocks[data.get("index", len(blocks))] = block
+            message["content"].append(block)
+        elif event == "content_block_delta":
+            delta = data.get("delta") or {}
+            block = blocks.get(data.get("index"))
+            if block is None or delta.get("type") != "text_delta":
+                continue
+            text = delta.get("text", "")
+            block["text"] += text
+            if scanner is not None:
+                scanner.feed(text)
+                if scanner.done:
+                    block["text"] = json.dumps({bool_key: False, list_key: []})
+                    debug_log("stream: clean result decided, closing stream early")
+                    return message
+        elif event == "message_delta":
+            message["usage"].update(data.get("usage") or {})
+        elif event == "message_stop":
+            break
+        elif event == "error":
+            raise _stream_error(url, data)
+    return message
@@ -1,5 +1,7 @@
 #!/usr/bin/env bun
 
+import { createClient, mapConcurrent, type GitHubClient } from "./github-client.ts";
+
 declare global {
   var process: {
     env: Record<string, string | undefined>;
@@ -11,6 +13,7 @@ interface GitHubIssue {
   title: string;
   user: { id: number };
   created_at: string;
+  pull_request?: unknown;
 }
 
 interface GitHubComment {
@@ -25,27 +28,6 @@ interface GitHubReaction {
   content: string;
 }
 
-async function githubRequest<T>(endpoint: string, token: string, method: string = 'GET', body?: any): Promise<T> {
-  const response = await fetch(`https://api.github.com${endpoint}`, {
-    method,
-    headers: {
-      Authorization: `Bearer ${token}`,
-      Accept: "application/vnd.github.v3+json",
-      "User-Agent": "auto-close-duplicates-script",
-      ...(body && { "Content-Type": "application/json" }),
-    },
-    ...(body && { body: JSON.stringify(body) }),
-  });
-
-  if (!response.ok) {
-    throw new Error(
-      `GitHub API request failed: ${response.status} ${response.statusText}`
-    );
-  }
-
-  return response.json();
-}
-
 function extractDuplicateIssueNumber(commentBody: string): number | null {
   // Try to match #123 format first
   let match = commentBody.match(/#(\d+)/);
@@ -68,11 +50,10 @@ async function closeIssueAsDuplicate(
   repo: string,
   issueNumber: number,
   duplicateOfNumber: number,
-  token: string
+  gh: GitHubClient
 ): Promise<void> {
-  await githubRequest(
+  await gh.request(
     `/repos/${owner}/${repo}/issues/${issueNumber}`,
-    token,
     'PATCH',
     {
       state: 'closed',
@@ -81,9 +62,8 @@ async function closeIssueAsDuplicate(
     }
   );
 
-  await githubRequest(
+  await gh.request(
     `/repos/${owner}/${repo}/issues/${issueNumber}/comments`,
-    token,
     'POST',
     {
       body: `This issue has been automatically closed as a duplicate of #${duplicateOfNumber}.
@@ -96,157 +76,257 @@ If this is incorrect, please re-open this issue or create a new one.
 
 }
 
-async function autoCloseDuplicates(): Promise<void> {
-  console.log("[DEBUG] Starting auto-close duplicates script");
+// GraphQL content enum -> REST reaction content.
+const REACTION_CONTENT: Record<string, string> = {
+  THUMBS_UP: "+1",
+  THUMBS_DOWN: "-1",
+  LAUGH: "laugh",
+  HOORAY: "hooray",
+  CONFUSED: "confused",
+  HEART: "heart",
+  ROCKET: "rocket",
+  EYES: "eyes",
+};
+
+interface IssueThread {
+  comments: GitHubComment[];
+  // Reactions by comment id, when the GraphQL batch already fetched them.
+  reactions?: Map<number, GitHubReaction[]>;
+}
 
-  const token = process.env.GITHUB_TOKEN;
-  if (!token) {
-    throw new Error("GITHUB_TOKEN environment variable is required");
+const GRAPHQL_BATCH = 25;
+
+// Fetch comments and their reactions for many issues in one query per
+// GRAPHQL_BATCH issues, shaped like the REST responses. Issues with more
+// comments or reactions than one query returns, or whose field failed in a
+// partial response, are left out; the caller falls back to REST for them.
+async function fetchThreadsGraphQL(
+  owner: string,
+  repo: string,
+  numbers: number[],
+  gh: GitHubClient
+): Promise<Map<number, IssueThread>> {
+  const threads = new Map<number, IssueThread>();
+  const batches: number[][] = [];
+  for (let i = 0; i < numbers.length; i += GRAPHQL_BATCH) {
+    batches.push(numbers.slice(i, i + GRAPHQL_BATCH));
   }
-  console.log("[DEBUG] GitHub token found");
+  await mapConcurrent(batches, 2, async (batch) => {
+    const fields = batch
+      .map(
+        (n) => `i${n}: issue(number: ${n}) {
+          comments(last: 100) {
+            totalCount
+            nodes {
+              databaseId body createdAt
+              author { __typename ... on User { databaseId } ... on Bot { databaseId } }
+              reactions(first: 100) {
+                totalCount
+                nodes { content user { databaseId } }
+              }
+            }
+          }
+        }`
+      )
+      .join("\n");
+    const data = await gh.graphql<{ repository: Record<string, any> }>(
+      `query($owner: String!, $repo: String!) { repository(owner: $owner, name: $repo) { ${fields} } }`,
+      { owner, repo },
+      { partial: true }
+    );
+    for (const n of batch) {
+      const comments = data.repository?.[`i${n}`]?.comments;
+      if (!comments || comments.totalCount > comments.nodes.length) continue;
+      const thread: IssueThread = { comments: [], reactions: new Map() };
+      let complete = true;
+      for (const c of comments.nodes) {
+        thread.comments.push({
+          id: c.databaseId,
+          body: c.body,
+          created_at: c.createdAt,
+          user: { type: c.author?.__typename ?? "User", id: c.author?.databaseId ?? 0 },
+        });
+        if (c.reactions.totalCount > c.reactions.nodes.length) complete = false;
+        thread.reactions!.set(
+          c.databaseId,
+          c.reactions.nodes.map((r: any) => ({
+            user: { id: r.user?.databaseId ?? 0 },
+            content: REACTION_CONTENT[r.content] ?? r.content.toLowerCase(),
+          }))
+        );
+      }
+      if (complete) threads.set(n, thread);
+    }
+  });
+  return threads;
+}
 
-  const owner = process.env.GITHUB_REPOSITORY_OWNER || "anthropics";
-  const repo = process.env.GITHUB_REPOSITORY_NAME || "claude-code";
-  console.log(`[DEBUG] Repository: ${owner}/${repo}`);
+// Decide whether an issue should be closed; returns the issue it duplicates.
+async function findDuplicateTarget(
+  issue: GitHubIssue,
+  thread: IssueThread,
+  threeDaysAgo: Date,
+  fetchReactions: (commentId: number) => Promise<GitHubReaction[]>
+): Promise<number | null> {
+  const { comments } = thread;
+  console.log(
+    `[DEBUG] Issue #${issue.number} has ${comments.length} comments`
+  );
 
-  const threeDaysAgo = new Date();
-  threeDaysAgo.setDate(threeDaysAgo.getDate() - 3);
+  const dupeComments = comments.filter(
+    (comment) =>
+      comment.body.includes("Found") &&
+      comment.body.includes("possible duplicate") &&
+      comment.user.type === "Bot"
+  );
   console.log(
-    `[DEBUG] Checking for duplicate comments older than: ${threeDaysAgo.toISOString()}`
+    `[DEBUG] Issue #${issue.number} has ${dupeComments.length} duplicate detection comments`
   );
 
-  console.log("[DEBUG] Fetching open issues created more than 3 days ago...");
-  const allIssues: GitHubIssue[] = [];
-  let page = 1;
-  const perPage = 100;
-  
-  while (true) {
-    const pageIssues: GitHubIssue[] = await githubRequest(
-      `/repos/${owner}/${repo}/issues?state=open&per_page=${perPage}&page=${page}`,
-      token
-    );
-    
-    if (pageIssues.length === 0) break;
-    
-    // Filter for issues created more than 3 days ago
-    const oldEnoughIssues = pageIssues.filter(issue => 
-      new Date(issue.created_at) <= threeDaysAgo
+  if (dupeComments.length === 0) {
+    console.log(
+      `[DEBUG] Issue #${issue.number} - no duplicate comments found, skipping`
     );
-    
-    allIssues.push(...oldEnoughIssues);
-    page++;
-    
-    // Safety limit to avoid infinite loops
-    if (page > 20) break;
+    return null;
   }
-  
-  const issues = allIssues;
-  console.log(`[DEBUG] Found ${issues.length} open issues`);
 
-  let processedCount = 0;
-  let candidateCount = 0;
+  const lastDupeComment = dupeComments[dupeComments.length - 1];
+  const dupeCommentDate = new Date(lastDupeComment.created_at);
+  console.log(
+    `[DEBUG] Issue #${
+      issue.number
+    } - most recent duplicate comment from: ${dupeCommentDate.toISOString()}`
+  );
 
-  for (const issue of issues) {
-    processedCount++;
+  if (dupeCommentDate > threeDaysAgo) {
     console.log(
-      `[DEBUG] Processing issue #${issue.number} (${processedCount}/${issues.length}): ${issue.title}`
+      `[DEBUG] Issue #${issue.number} - duplicate comment is too recent, skipping`
     );
+    return null;
+  }
+  console.log(
+    `[DEBUG] Issue #${
+      issue.number
+    } - duplicate comment is old enough (${Math.floor(
+      (Date.now() - dupeCommentDate.getTime()) / (1000 * 60 * 60 * 24)
+    )} days)`
+  );
 
-    console.log(`[DEBUG] Fetching comments for issue #${issue.number}...`);
-    const comments: GitHubComment[] = await githubRequest(
-      `/repos/${owner}/${repo}/issues/${issue.number}/comments`,
-      token
-    );
-    console.log(
-      `[DEBUG] Issue #${issue.number} has ${comments.length} comments`
-    );
+  const commentsAfterDupe = comments.filter(
+    (comment) => new Date(comment.created_at) > dupeCommentDate
+  );
+  console.log(
+    `[DEBUG] Issue #${issue.number} - ${commentsAfterDupe.length} comments after duplicate detection`
+  );
 
-    const dupeComments = comments.filter(
-      (comment) =>
-        comment.body.includes("Found") &&
-        comment.body.includes("possible duplicate") &&
-        comment.user.type === "Bot"
-    );
+  if (commentsAfterDupe.length > 0) {
     console.log(
-      `[DEBUG] Issue #${issue.number} has ${dupeComments.length} duplicate detection comments`
+      `[DEBUG] Issue #${issue.number} - has activity after duplicate comment, skipping`
     );
+    return null;
+  }
 
-    if (dupeComments.length === 0) {
-      console.log(
-        `[DEBUG] Issue #${issue.number} - no duplicate comments found, skipping`
-      );
-      continue;
-    }
+  console.log(
+    `[DEBUG] Issue #${issue.number} - checking reactions on duplicate comment...`
+  );
+  const reactions =
+    thread.reactions?.get(lastDupeComment.id) ?? (await fetchReactions(lastDupeComment.id));
+  console.log(
+    `[DEBUG] Issue #${issue.number} - duplicate comment has ${reactions.length} reactions`
+  );
 
-    const lastDupeComment = dupeComments[dupeComments.length - 1];
-    const dupeCommentDate = new Date(lastDupeComment.created_at);
-    console.log(
-      `[DEBUG] Issue #${
-        issue.number
-      } - most recent duplicate comment from: ${dupeCommentDate.toISOString()}`
-    );
+  const authorThumbsDown = reactions.some(
+    (reaction) =>
+      reaction.user.id === issue.user.id && reaction.content === "-1"
+  );
+  console.log(
+    `[DEBUG] Issue #${issue.number} - author thumbs down reaction: ${authorThumbsDown}`
+  );
 
-    if (dupeCommentDate > threeDaysAgo) {
-      console.log(
-        `[DEBUG] Issue #${issue.number} - duplicate comment is too recent, skipping`
-      );
-      continue;
-    }
+  if (authorThumbsDown) {
     console.log(
-      `[DEBUG] Issue #${
-        issue.number
-      } - duplicate comment is old enough (${Math.floor(
-        (Date.now() - dupeCommentDate.getTime()) / (1000 * 60 * 60 * 24)
-      )} days)`
+      `[DEBUG] Issue #${issue.number} - author disagreed with duplicate detection, skipping`
     );
+    return null;
+  }
 
-    const commentsAfterDupe = comments.filter(
-      (comment) => new Date(comment.created_at) > dupeCommentDate
-    );
+  const duplicateIssueNumber = extractDuplicateIssueNumber(lastDupeComment.body);
+  if (!duplicateIssueNumber) {
     console.log(
-      `[DEBUG] Issue #${issue.number} - ${commentsAfterDupe.length} comments after duplicate detection`
+      `[DEBUG] Issue #${issue.number} - could not extract duplicate issue number from comment, skipping`
     );
+    return null;
+  }
+  return duplicateIssueNumber;
+}
 
-    if (commentsAfterDupe.length > 0) {
-      console.log(
-        `[DEBUG] Issue #${issue.number} - has activity after duplicate comment, skipping`
-      );
-      continue;
-    }
+async function autoCloseDuplicates(): Promise<void> {
+  console.log("[DEBUG] Starting auto-close duplicates script");
 
-    console.log(
-      `[DEBUG] Issue #${issue.number} - checking reactions on duplicate comment...`
-    );
-    const reactions: GitHubReaction[] = await githubRequest(
-      `/repos/${owner}/${repo}/issues/comments/${lastDupeComment.id}/reactions`,
-      token
-    );
-    console.log(
-      `[DEBUG] Issue #${issue.number} - duplicate comment has ${reactions.length} reactions`
-    );
+  if (!process.env.GITHUB_TOKEN) {
+    throw new Error("GITHUB_TOKEN environment variable is required");
+  }
+  const gh = createClient({ userAgent: "auto-close-duplicates-script" });
+  console.log("[DEBUG] GitHub token found");
 
-    const authorThumbsDown = reactions.some(
-      (reaction) =>
-        reaction.user.id === issue.user.id && reaction.content === "-1"
-    );
+  const owner = process.env.GITHUB_REPOSITORY_OWNER || "anthropics";
+  const repo = process.env.GITHUB_REPOSITORY_NAME || "claude-code";
+  const useGraphQL = process.env.GITHUB_GRAPHQL === "1";
+  const concurrency = parseInt(process.env.GITHUB_CONCURRENCY || "6", 10);
+  console.log(`[DEBUG] Repository: ${owner}/${repo}`);
+
+  const threeDaysAgo = new Date();
+  threeDaysAgo.setDate(threeDaysAgo.getDate() - 3);
+  console.log(
+    `[DEBUG] Checking for duplicate comments older than: ${threeDaysAgo.toISOString()}`
+  );
+
+  console.log("[DEBUG] Fetching open issues created more than 3 days ago...");
+  const issues = (
+    await gh.paginate<GitHubIssue>(`/repos/${owner}/${repo}/issues?state=open`, {
+      maxPages: 20,
+    })
+  ).filter((issue) => new Date(issue.created_at) <= threeDaysAgo);
+  console.log(`[DEBUG] Found ${issues.length} open issues`);
+
+  const prefetched = useGraphQL
+    ? await fetchThreadsGraphQL(
+        owner,
+        repo,
+        // The REST listing includes pull requests, which issue(number:) doesn't
+        // resolve; they take the REST path below.
+        issues.filter((i) => !i.pull_request).map((i) => i.number),
+        gh
+      )
+    : new Map<number, IssueThread>();
+  if (useGraphQL) {
+    console.log(`[DEBUG] GraphQL batch returned ${prefetched.size}/${issues.length} issue threads`);
+  }
+
+  // Read-only checks fan out; the closes below stay sequential.
+  let processedCount = 0;
+  const targets = await mapConcurrent(issues, concurrency, async (issue) => {
+    processedCount++;
     console.log(
-      `[DEBUG] Issue #${issue.number} - author thumbs down reaction: ${authorThumbsDown}`
+      `[DEBUG] Processing issue #${issue.number} (${processedCount}/${issues.length}): ${issue.title}`
+    );
+    const thread = prefetched.get(issue.number) ?? {
+      comments: await gh.paginate<GitHubComment>(
+        `/repos/${owner}/${repo}/issues/${issue.number}/comments`
+      ),
+    };
+    return findDuplicateTarget(issue, thread, threeDaysAgo, (commentId) =>
+      gh.request<GitHubReaction[]>(
+        `/repos/${owner}/${repo}/issues/comments/${commentId}/reactions?per_page=100`
+      )
     );
+  });
 
-    if (authorThumbsDown) {
-      console.log(
-        `[DEBUG] Issue #${issue.number} - author disagreed with duplicate detection, skipping`
-      );
-      continue;
-    }
+  let candidateCount = 0;
 
-    const duplicateIssueNumber = extractDuplicateIssueNumber(lastDupeComment.body);
-    if (!duplicateIssueNumber) {
-      console.log(
-        `[DEBUG] Issue #${issue.number} - could not extract duplicate issue number from comment, skipping`
-      );
-      continue;
-    }
+  for (const [index, issue] of issues.entries()) {
+    const duplicateIssueNumber = targets[index];
+    if (!duplicateIssueNumber) continue;
 
     candidateCount++;
     const issueUrl = `https://github.com/${owner}/${repo}/issues/${issue.number}`;
@@ -255,7 +335,7 @@ async function autoCloseDuplicates(): Promise<void> {
       console.log(
         `[INFO] Auto-closing issue #${issue.number} as duplicate of #${duplicateIssueNumber}: ${issueUrl}`
       );
-      await closeIssueAsDuplicate(owner, repo, issue.number, duplicateIssueNumber, token);
+      await closeIssueAsDuplicate(owner, repo, issue.number, duplicateIssueNumber, gh);
       console.log(
         `[SUCCESS] Successfully closed issue #${issue.number} as duplicate of #${duplicateIssueNumber}`
       );
@@ -266,6 +346,7 @@ async function autoCloseDuplicates(): Promise<void> {
     }
   }
 
+  gh.saveCache();
   console.log(
     `[DEBUG] Script completed. Processed ${processedCount} issues, found ${candidateCount} candidates for auto-close`
   );
@@ -1,5 +1,7 @@
 #!/usr/bin/env bun
 
+import { createClient, mapConcurrent, type GitHubClient } from "./github-client.ts";
+
 declare global {
   var process: {
     env: Record<string, string | undefined>;
@@ -23,32 +25,11 @@ interface GitHubComment {
   user: { type: string; id: number };
 }
 
-async function githubRequest<T>(endpoint: string, token: string, method: string = 'GET', body?: any): Promise<T> {
-  const response = await fetch(`https://api.github.com${endpoint}`, {
-    method,
-    headers: {
-      Authorization: `Bearer ${token}`,
-      Accept: "application/vnd.github.v3+json",
-      "User-Agent": "backfill-duplicate-comments-script",
-      ...(body && { "Content-Type": "application/json" }),
-    },
-    ...(body && { body: JSON.stringify(body) }),
-  });
-
-  if (!response.ok) {
-    throw new Error(
-      `GitHub API request failed: ${response.status} ${response.statusText}`
-    );
-  }
-
-  return response.json();
-}
-
 async function triggerDedupeWorkflow(
   owner: string,
   repo: string,
   issueNumber: number,
-  token: string,
+  gh: GitHubClient,
   dryRun: boolean = true
 ): Promise<void> {
   if (dryRun) {
@@ -56,9 +37,8 @@ async function triggerDedupeWorkflow(
     return;
   }
 
-  await githubRequest(
+  await gh.request(
     `/repos/${owner}/${repo}/actions/workflows/claude-dedupe-issues.yml/dispatches`,
-    token,
     'POST',
     {
       ref: 'main',
@@ -81,9 +61,12 @@ Usage:
 
 Environment Variables:
   GITHUB_TOKEN - GitHub personal access token with repo and actions permissions (required)
+  GITHUB_CONCURRENCY - Parallel read requests (default: 6)
+  GITHUB_ETAG_CACHE - File to keep ETags in between runs (optional)
   DRY_RUN - Set to "false" to actually trigger workflows (default: true for safety)
   MAX_ISSUE_NUMBER - Only process issues with numbers less than this value (default: 4050)`);
   }
+  const gh = createClient({ token, userAgent: "backfill-duplicate-comments-script" });
   console.log("[DEBUG] GitHub token found");
 
   const owner = "anthropics";
@@ -91,68 +74,54 @@ Environment Variables:
   const dryRun = process.env.DRY_RUN !== "false";
   const maxIssueNumber = parseInt(process.env.MAX_ISSUE_NUMBER || "4050", 10);
   const minIssueNumber = parseInt(process.env.MIN_ISSUE_NUMBER || "1", 10);
+  const concurrency = parseInt(process.env.GITHUB_CONCURRENCY || "6", 10);
   
   console.log(`[DEBUG] Repository: ${owner}/${repo}`);
   console.log(`[DEBUG] Dry run mode: ${dryRun}`);
   console.log(`[DEBUG] Looking at issues between #${minIssueNumber} and #${maxIssueNumber}`);
 
   console.log(`[DEBUG] Fetching issues between #${minIssueNumber} and #${maxIssueNumber}...`);
-  const allIssues: GitHubIssue[] = [];
-  let page = 1;
-  const perPage = 100;
-  
-  while (true) {
-    const pageIssues: GitHubIssue[] = await githubRequest(
-      `/repos/${owner}/${repo}/issues?state=all&per_page=${perPage}&page=${page}&sort=created&direction=desc`,
-      token
-    );
-    
-    if (pageIssues.length === 0) break;
-    
-    // Filter to only include issues within the specified range
-    const filteredIssues = pageIssues.filter(issue => 
-      issue.number >= minIssueNumber && issue.number < maxIssueNumber
-    );
-    allIssues.push(...filteredIssues);
-    
-    // If the oldest issue in this page is still above our minimum, we need to continue
-    // but if the oldest issue is below our minimum, we can stop
-    const oldestIssueInPage = pageIssues[pageIssues.length - 1];
-    if (oldestIssueInPage && oldestIssueInPage.number >= maxIssueNumber) {
-      console.log(`[DEBUG] Oldest issue in page #${page} is #${oldestIssueInPage.number}, continuing...`);
-    } else if (oldestIssueInPage && oldestIssueInPage.number < minIssueNumber) {
-      console.log(`[DEBUG] Oldest issue in page #${page} is #${oldestIssueInPage.number}, below minimum, stopping`);
-      break;
-    } else if (filteredIssues.length === 0 && pageIssues.length > 0) {
-      console.log(`[DEBUG] No issues in page #${page} are in range #${minIssueNumber}-#${maxIssueNumber}, continuing...`);
-    }
-    
-    page++;
-    
-    // Safety limit to avoid infinite loops
-    if (page > 200) {
-      console.log("[DEBUG] Reached page limit, stopping pagination");
-      break;
-    }
-  }
+  let page = 0;
+  const allIssues = (
+    await gh.paginate<GitHubIssue>(
+      `/repos/${owner}/${repo}/issues?state=all&sort=created&direction=desc`,
+      {
+        // Safety limit to avoid infinite loops
+        maxPages: 200,
+        // Pages are newest-first, so once the oldest issue in a page is
+        // below our minimum there is nothing further to find
+        stop: (pageIssues) => {
+          page++;
+          const oldestIssueInPage = pageIssues[pageIssues.length - 1];
+          if (oldestIssueInPage && oldestIssueInPage.number < minIssueNumber) {
+            console.log(`[DEBUG] Oldest issue in page #${page} is #${oldestIssueInPage.number}, below minimum, stopping`);
+            return true;
+          }
+          return false;
+        },
+      }
+    )
+  ).filter((issue) => issue.number >= minIssueNumber && issue.number < maxIssueNumber);
   
   console.log(`[DEBUG] Found ${allIssues.length} issues between #${minIssueNumber} and #${maxIssueNumber}`);
 
+  // Comment fetches fan out; workflow triggers below stay sequential and
+  // spaced out.
+  const allComments = await mapConcurrent(allIssues, concurrency, (issue) =>
+    gh.paginate<GitHubComment>(`/repos/${owner}/${repo}/issues/${issue.number}/comments`)
+  );
+
   let processedCount = 0;
   let candidateCount = 0;
   let triggeredCount = 0;
 
-  for (const issue of allIssues) {
+  for (const [index, issue] of allIssues.entries()) {
     processedCount++;
     console.log(
       `[DEBUG] Processing issue #${issue.number} (${processedCount}/${allIssues.length}): ${issue.title}`
     );
 
-    console.log(`[DEBUG] Fetching comments for issue #${issue.number}...`);
-    const comments: GitHubComment[] = await githubRequest(
-      `/repos/${owner}/${repo}/issues/${issue.number}/comments`,
-      token
-    );
+    const comments = allComments[index];
     console.log(
       `[DEBUG] Issue #${issue.number} has ${comments.length} comments`
     );
@@ -184,7 +153,7 @@ Environment Variables:
       console.log(
         `[INFO] ${dryRun ? '[DRY RUN] ' : ''}Triggering dedupe workflow for issue #${issue.number}: ${issueUrl}`
       );
-      await triggerDedupeWorkflow(owner, repo, issue.number, token, dryRun);
+      await triggerDedupeWorkflow(owner, repo, issue.number, gh, dryRun);
       
       if (!dryRun) {
         console.log(
@@ -202,6 +171,7 @@ Environment Variables:
     await new Promise(resolve => setTimeout(resolve, 1000));
   }
 
+  gh.saveCache();
   console.log(
     `[DEBUG] Script completed. Processed ${processedCount} issues, found ${candidateCount} candidates without duplicate comments, ${dryRun ? 'would trigger' : 'triggered'} ${triggeredCount} workflows`
   );
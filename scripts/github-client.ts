@@ -0,0 +1,268 @@
+// Shared GitHub REST/GraphQL client for the issue-automation scripts.
+//
+// - Bounded concurrency: every request goes through one limiter, so callers
+//   can fan out with `mapConcurrent` without tripping secondary rate limits.
+// - Conditional requests: GET responses are cached by URL with their ETag
+//   and revalidated with If-None-Match. A 304 doesn't count against the
+//   rate limit, so unchanged issues cost zero quota. Set GITHUB_ETAG_CACHE
+//   to a file path to keep the cache across runs (the workflows restore it
+//   with actions/cache).
+// - Rate-limit-aware retries: primary limit (x-ratelimit-remaining: 0) waits
+//   for x-ratelimit-reset, secondary limits honor retry-after, 5xx backs off
+//   exponentially. Waits longer than MAX_WAIT_MS fail instead of hanging
+//   the job. Only idempotent requests (GET/PUT/DELETE and GraphQL queries)
+//   are retried on a response; a POST or PATCH is retried only when the
+//   connection failed before the request went out, so a comment is never
+//   posted twice.
+
+import { existsSync, readFileSync, writeFileSync } from "node:fs";
+
+const API = "https://api.github.com";
+const MAX_ATTEMPTS = 4;
+const MAX_WAIT_MS = 5 * 60 * 1000;
+// Entries beyond this are dropped oldest-first when the cache is saved.
+const MAX_CACHE_ENTRIES = 20000;
+
+export class GitHubError extends Error {
+  constructor(
+    readonly status: number,
+    readonly endpoint: string,
+    readonly body: string
+  ) {
+    super(`GitHub API ${status} for ${endpoint}: ${body.slice(0, 500)}`);
+  }
+}
+
+interface CacheEntry {
+  etag: string;
+  data: unknown;
+}
+
+export interface ClientOptions {
+  userAgent: string;
+  token?: string;
+  concurrency?: number;
+  cacheFile?: string;
+}
+
+export interface PaginateOptions<T> {
+  maxPages?: number;
+  // Stop after the page for which this returns true (e.g. sorted past a cutoff).
+  stop?: (page: T[]) => boolean;
+}
+
+const sleep = (ms: number) => new Promise((resolve) => setTimeout(resolve, ms));
+
+const IDEMPOTENT_METHODS = new Set(["GET", "HEAD", "PUT", "DELETE"]);
+// fetch failures that mean nothing reached the server.
+const NOT_SENT_CODES = new Set(["ECONNREFUSED", "ENOTFOUND", "EAI_AGAIN", "ENETUNREACH", "EHOSTUNREACH"]);
+
+function notSent(error: unknown): boolean {
+  const code = (error as { cause?: { code?: string } })?.cause?.code;
+  return code !== undefined && NOT_SENT_CODES.has(code);
+}
+
+export function createClient(options: ClientOptions) {
+  const token = options.token ?? process.env.GITHUB_TOKEN;
+  if (!token) throw new Error("GITHUB_TOKEN required");
+  const concurrency = Math.max(
+    1,
+    options.concurrency ?? parseInt(process.env.GITHUB_CONCURRENCY || "6", 10)
+  );
+  const cacheFile = options.cacheFile ?? process.env.GITHUB_ETAG_CACHE;
+
+  const cache = new Map<string, CacheEntry>();
+  if (cacheFile && existsSync(cacheFile)) {
+    try {
+      for (const [k, v] of Object.entries(JSON.parse(readFileSync(cacheFile, "utf8")))) {
+        cache.set(k, v as CacheEntry);
+      }
+    } catch (error) {
+      console.log(`[DEBUG] Ignoring unreadable ETag cache ${cacheFile}: ${error}`);
+    }
+  }
+
+  const stats = { requests: 0, notModified: 0, retries: 0 };
+
+  let active = 0;
+  const waiting: (() => void)[] = [];
+  // A finished request hands its slot straight to the next waiter, so a
+  // newcomer can't slip in between and exceed the limit.
+  async function withSlot<T>(fn: () => Promise<T>): Promise<T> {
+    if (active >= concurrency) {
+      await new Promise<void>((resolve) => waiting.push(resolve));
+    } else {
+      active++;
+    }
+    try {
+      return await fn();
+    } finally {
+      const next = waiting.shift();
+      if (next) next();
+      else active--;
+    }
+  }
+
+  function retryDelay(response: Response, attempt: number): number | null {
+    const retryAfter = response.headers.get("retry-after");
+    if (retryAfter) return parseInt(retryAfter, 10) * 1000;
+    const remaining = response.headers.get("x-ratelimit-remaining");
+    const reset = response.headers.get("x-ratelimit-reset");
+    if ((response.status === 403 || response.status === 429) && remaining === "0" && reset) {
+      return Math.max(0, parseInt(reset, 10) * 1000 - Date.now()) + 1000;
+    }
+    if (response.status === 429 || response.status >= 500) {
+      return 1000 * 2 ** attempt;
+    }
+    return null;
+  }
+
+  async function send(
+    url: string,
+    init: RequestInit,
+    label: string,
+    idempotent = IDEMPOTENT_METHODS.has(init.method ?? "GET")
+  ): Promise<Response> {
+    for (let attempt = 0; ; attempt++) {
+      let response: Response;
+      try {
+        response = await withSlot(() => {
+          stats.requests++;
+          return fetch(url, init);
+        });
+      } catch (error) {
+        if (attempt + 1 >= MAX_ATTEMPTS || !(idempotent || notSent(error))) throw error;
+        stats.retries++;
+        console.log(`[DEBUG] GitHub connection failed for ${label} (${error}), retrying`);
+        await sleep(1000 * 2 ** attempt);
+        continue;
+      }
+      if (response.ok || response.status === 304) return response;
+      const delay = idempotent && attempt + 1 < MAX_ATTEMPTS ? retryDelay(response, attempt) : null;
+      if (delay === null || delay > MAX_WAIT_MS) {
+        throw new GitHubError(response.status, label, await response.text());
+      }
+      stats.retries++;
+      console.log(`[DEBUG] GitHub ${response.status} for ${label}, retrying in ${Math.round(delay / 1000)}s`);
+      await response.body?.cancel();
+      await sleep(delay);
+    }
+  }
+
+  function headers(extra: Record<string, string> = {}): Record<string, string> {
+    return {
+      Authorization: `Bearer ${token}`,
+      Accept: "application/vnd.github.v3+json",
+      "User-Agent": options.userAgent,
+      ...extra,
+    };
+  }
+
+  async function request<T>(endpoint: string, method = "GET", body?: unknown): Promise<T> {
+    const url = `${API}${endpoint}`;
+    if (method !== "GET") {
+      const response = await send(
+        url,
+        {
+          method,
+          headers: headers(body ? { "Content-Type": "application/json" } : {}),
+          ...(body ? { body: JSON.stringify(body) } : {}),
+        },
+        `${method} ${endpoint}`
+      );
+      return (response.status === 204 ? undefined : await response.json()) as T;
+    }
+    const cached = cache.get(url);
+    const response = await send(
+      url,
+      { headers: headers(cached ? { "If-None-Match": cached.etag } : {}) },
+      endpoint
+    );
+    if (response.status === 304 && cached) {
+      stats.notModified++;
+      // Re-insert so the save-time trim keeps recently used entries.
+      cache.delete(url);
+      cache.set(url, cached);
+      return cached.data as T;
+    }
+    const data = await response.json();
+    const etag = response.headers.get("etag");
+    if (etag) {
+      cache.delete(url);
+      cache.set(url, { etag, data });
+    }
+    return data as T;
+  }
+
+  // Pages are fetched one at a time: list endpoints are usually sorted and
+  // callers stop early, so speculative pages would mostly be wasted quota.
+  async function paginate<T>(endpoint: string, opts: PaginateOptions<T> = {}): Promise<T[]> {
+    const maxPages = opts.maxPages ?? 10;
+    const sep = endpoint.includes("?") ? "&" : "?";
+    const items: T[] = [];
+    for (let page = 1; page <= maxPages; page++) {
+      const batch = await request<T[]>(`${endpoint}${sep}per_page=100&page=${page}`);
+      items.push(...batch);
+      if (batch.length < 100 || opts.stop?.(batch)) break;
+    }
+    return items;
+  }
+
+  // With partial, a response that carries data alongside errors (e.g. one
+  // aliased field NOT_FOUND) returns that data instead of throwing; the
+  // failed fields are null and the errors are logged.
+  async function graphql<T>(
+    query: string,
+    variables: Record<string, unknown> = {},
+    opts: { partial?: boolean } = {}
+  ): Promise<T> {
+    const response = await send(
+      `${API}/graphql`,
+      {
+        method: "POST",
+        headers: headers({ "Content-Type": "application/json" }),
+        body: JSON.stringify({ query, variables }),
+      },
+      "POST /graphql",
+      !/^\s*mutation\b/.test(query)
+    );
+    const result = (await response.json()) as { data?: T; errors?: { message: string }[] };
+    if (result.errors?.length) {
+      const message = `GitHub GraphQL: ${result.errors.map((e) => e.message).join("; ")}`;
+      if (!opts.partial || !result.data) throw new Error(message);
+      console.log(`[DEBUG] ${message} (partial data kept)`);
+    }
+    return result.data as T;
+  }
+
+  function saveCache(): void {
+    if (!cacheFile) return;
+    const entries = [...cache.entries()].slice(-MAX_CACHE_ENTRIES);
+    writeFileSync(cacheFile, JSON.stringify(Object.fromEntries(entries)));
+    console.log(
+      `[DEBUG] GitHub requests: ${stats.requests} (${stats.notModified} not modified, ${stats.retries} retried); saved ${entries.length} ETags`
+    );
+  }
+
+  return { request, paginate, graphql, saveCache, stats };
+}
+
+export type GitHubClient = ReturnType<typeof createClient>;
+
+// Run fn over items with at most `limit` in flight; results keep item order.
+export async function mapConcurrent<T, R>(
+  items: readonly T[],
+  limit: number,
+  fn: (item: T, index: number) => Promise<R>
+): Promise<R[]> {
+  const results = new Array<R>(items.length);
+  let next = 0;
+  const workers = Array.from({ length: Math.min(limit, items.length) }, async () => {
+    while (next < items.length) {
+      const i = next++;
+      results[i] = await fn(items[i], i);
+    }
+  });
+  await Promise.all(workers);
+  return results;
+}
@@ -1,6 +1,8 @@
 #!/usr/bin/env bun
 
 import { lifecycle, STALE_UPVOTE_THRESHOLD } from "./issue-lifecycle.ts";
+import { createClient, GitHubError, mapConcurrent } from "./github-client.ts";
+import { existsSync, readFileSync, writeFileSync } from "node:fs";
 
 // --
 
@@ -10,143 +12,274 @@ const DRY_RUN = process.argv.includes("--dry-run");
 const CLOSE_MESSAGE = (reason: string) =>
   `Closing for now — ${reason}. Please [open a new issue](${NEW_ISSUE}) if this is still relevant.`;
 
+// Where the issue index and cursor live between runs (the workflow restores
+// it with actions/cache). Without it every run rebuilds the index.
+const STATE_FILE = process.env.SWEEP_STATE;
+// Rebuild from a full listing this often, so anything the incremental
+// updates can't see (reaction counts don't bump updated_at) heals.
+const FULL_RESCAN_DAYS = 7;
+// Per-run cap on new stale labels, as the old 10-page scan had.
+const MAX_STALE_PER_RUN = 1000;
+const LIFECYCLE_LABELS = new Set<string>(lifecycle.map((l) => l.label));
+const DAY_MS = 86400000;
+
 // --
 
+const gh = createClient({ userAgent: "sweep" });
+const CONCURRENCY = parseInt(process.env.GITHUB_CONCURRENCY || "6", 10);
+
 async function githubRequest<T>(
   endpoint: string,
   method = "GET",
   body?: unknown
 ): Promise<T> {
-  const token = process.env.GITHUB_TOKEN;
-  if (!token) throw new Error("GITHUB_TOKEN required");
-
-  const response = await fetch(`https://api.github.com${endpoint}`, {
-    method,
-    headers: {
-      Authorization: `Bearer ${token}`,
-      Accept: "application/vnd.github.v3+json",
-      "User-Agent": "sweep",
-      ...(body && { "Content-Type": "application/json" }),
-    },
-    ...(body && { body: JSON.stringify(body) }),
-  });
-
-  if (!response.ok) {
-    if (response.status === 404) return {} as T;
-    const text = await response.text();
-    throw new Error(`GitHub API ${response.status}: ${text}`);
+  try {
+    return await gh.request<T>(endpoint, method, body);
+  } catch (error) {
+    if (error instanceof GitHubError && error.status === 404) return {} as T;
+    throw error;
   }
-
-  return response.json();
 }
 
 // --
 
-async function markStale(owner: string, repo: string) {
-  const staleDays = lifecycle.find((l) => l.label === "stale")!.days;
-  const cutoff = new Date();
-  cutoff.setDate(cutoff.getDate() - staleDays);
+// Every open issue, as of the cursor. Only the fields the lifecycle rules
+// read are kept; labeledAt holds when each lifecycle label currently on the
+// issue was applied, which is what the deadlines are computed from.
+interface IndexedIssue {
+  number: number;
+  title: string;
+  updated_at: string;
+  labels: string[];
+  assigned: boolean;
+  locked: boolean;
+  thumbsUp: number;
+  labeledAt: Record<string, string>;
+}
 
-  let labeled = 0;
+interface SweepState {
+  version: 1;
+  // Highest updated_at seen; the next run lists issues with `since=cursor`.
+  cursor: string;
+  rebuiltAt: string;
+  issues: Record<string, IndexedIssue>;
+}
 
-  console.log(`\n=== marking stale (${staleDays}d inactive) ===`);
+function loadState(): SweepState | null {
+  if (!STATE_FILE || !existsSync(STATE_FILE)) return null;
+  try {
+    const state = JSON.parse(readFileSync(STATE_FILE, "utf8"));
+    if (state.version !== 1 || !state.cursor || !state.issues) return null;
+    if (Date.now() - Date.parse(state.rebuiltAt) > FULL_RESCAN_DAYS * DAY_MS) {
+      console.log(`State is older than ${FULL_RESCAN_DAYS}d, rebuilding`);
+      return null;
+    }
+    return state;
+  } catch (error) {
+    console.log(`Ignoring unreadable state ${STATE_FILE}: ${error}`);
+    return null;
+  }
+}
+
+function saveState(state: SweepState) {
+  if (STATE_FILE) writeFileSync(STATE_FILE, JSON.stringify(state));
+}
+
+function toIndexed(issue: any, previous?: IndexedIssue): IndexedIssue {
+  const labels: string[] = (issue.labels ?? []).map((l: any) => l.name);
+  const labeledAt: Record<string, string> = {};
+  for (const label of labels) {
+    if (previous?.labeledAt[label]) labeledAt[label] = previous.labeledAt[label];
+  }
+  return {
+    number: issue.number,
+    title: issue.title,
+    updated_at: issue.updated_at,
+    labels,
+    assigned: issue.assignees?.length > 0,
+    locked: !!issue.locked,
+    thumbsUp: issue.reactions?.["+1"] ?? 0,
+    labeledAt,
+  };
+}
 
-  for (let page = 1; page <= 10; page++) {
-    const issues = await githubRequest<any[]>(
-      `/repos/${owner}/${repo}/issues?state=open&sort=updated&direction=asc&per_page=100&page=${page}`
+// Bring the index up to date: a full listing when there is no usable state,
+// otherwise only the issues updated since the cursor (state=all, so closed
+// issues drop out). Label dates are re-read from the events of issues that
+// changed, or whose lifecycle label has no date yet.
+async function refreshIndex(owner: string, repo: string): Promise<SweepState> {
+  const previous = loadState();
+  const now = new Date().toISOString();
+  const state: SweepState = previous ?? { version: 1, cursor: "", rebuiltAt: now, issues: {} };
+
+  const listing = previous
+    ? `/repos/${owner}/${repo}/issues?state=all&sort=updated&direction=asc&since=${previous.cursor}`
+    : `/repos/${owner}/${repo}/issues?state=open&sort=updated&direction=asc`;
+  const changed = await gh.paginate<any>(listing, { maxPages: 100 });
+  console.log(
+    previous
+      ? `Index: ${changed.length} issues updated since ${previous.cursor}`
+      : `Index: rebuilt from ${changed.length} open issues`
+  );
+
+  const touched = new Set<number>();
+  for (const issue of changed) {
+    if (issue.updated_at > state.cursor) state.cursor = issue.updated_at;
+    if (issue.pull_request) continue;
+    if (issue.state === "closed") {
+      delete state.issues[issue.number];
+      continue;
+    }
+    state.issues[issue.number] = toIndexed(issue, state.issues[issue.number]);
+    touched.add(issue.number);
+  }
+  if (!state.cursor) state.cursor = now;
+
+  const needEvents = Object.values(state.issues).filter((issue) =>
+    issue.labels.some(
+      (label) => LIFECYCLE_LABELS.has(label) && (touched.has(issue.number) || !issue.labeledAt[label])
+    )
+  );
+  await mapConcurrent(needEvents, CONCURRENCY, async (issue) => {
+    const events = await gh.paginate<any>(
+      `/repos/${owner}/${repo}/issues/${issue.number}/events`
     );
-    if (issues.length === 0) break;
+    for (const label of issue.labels) {
+      if (!LIFECYCLE_LABELS.has(label)) continue;
+      const labeledAt = events
+        .filter((e) => e.event === "labeled" && e.label?.name === label)
+        .map((e) => e.created_at as string)
+        .pop();
+      if (labeledAt) issue.labeledAt[label] = labeledAt;
+    }
+  });
 
-    for (const issue of issues) {
-      if (issue.pull_request) continue;
-      if (issue.locked) continue;
-      if (issue.assignees?.length > 0) continue;
+  return state;
+}
 
-      const updatedAt = new Date(issue.updated_at);
-      if (updatedAt > cutoff) return labeled;
+// Re-read one issue right before mutating it; the index can lag by a run.
+// Reactions and (un)locking don't bump updated_at, so the fields the sweep
+// filters on are compared too.
+async function stillMatches(base: string, entry: IndexedIssue) {
+  const issue = await githubRequest<any>(base);
+  if (issue.state !== "open" || issue.updated_at !== entry.updated_at) return false;
+  const fresh = toIndexed(issue);
+  return (
+    !fresh.locked &&
+    fresh.assigned === entry.assigned &&
+    fresh.thumbsUp < STALE_UPVOTE_THRESHOLD
+  );
+}
 
-      const alreadyStale = issue.labels?.some(
-        (l: any) => l.name === "stale" || l.name === "autoclose"
-      );
-      if (alreadyStale) continue;
+async function markStale(owner: string, repo: string, state: SweepState) {
+  const staleDays = lifecycle.find((l) => l.label === "stale")!.days;
+  const cutoff = new Date();
+  cutoff.setDate(cutoff.getDate() - staleDays);
 
-      const thumbsUp = issue.reactions?.["+1"] ?? 0;
-      if (thumbsUp >= STALE_UPVOTE_THRESHOLD) continue;
+  let labeled = 0;
 
-      const base = `/repos/${owner}/${repo}/issues/${issue.number}`;
+  console.log(`\n=== marking stale (${staleDays}d inactive) ===`);
 
-      if (DRY_RUN) {
-        const age = Math.floor((Date.now() - updatedAt.getTime()) / 86400000);
-        console.log(`#${issue.number}: would label stale (${age}d inactive) — ${issue.title}`);
-      } else {
-        await githubRequest(`${base}/labels`, "POST", { labels: ["stale"] });
-        console.log(`#${issue.number}: labeled stale — ${issue.title}`);
+  const candidates = Object.values(state.issues)
+    .filter(
+      (issue) =>
+        !issue.locked &&
+        !issue.assigned &&
+        new Date(issue.updated_at) <= cutoff &&
+        !issue.labels.some((l) => l === "stale" || l === "autoclose") &&
+        issue.thumbsUp < STALE_UPVOTE_THRESHOLD
+    )
+    .sort((a, b) => a.updated_at.localeCompare(b.updated_at))
+    .slice(0, MAX_STALE_PER_RUN);
+
+  for (const issue of candidates) {
+    const updatedAt = new Date(issue.updated_at);
+    const base = `/repos/${owner}/${repo}/issues/${issue.number}`;
+
+    if (DRY_RUN) {
+      const age = Math.floor((Date.now() - updatedAt.getTime()) / DAY_MS);
+      console.log(`#${issue.number}: would label stale (${age}d inactive) — ${issue.title}`);
+    } else {
+      if (!(await stillMatches(base, issue))) {
+        console.log(`#${issue.number}: skipping (changed since indexed)`);
+        continue;
       }
-      labeled++;
+      await githubRequest(`${base}/labels`, "POST", { labels: ["stale"] });
+      console.log(`#${issue.number}: labeled stale — ${issue.title}`);
+      issue.labels.push("stale");
+      issue.labeledAt.stale = new Date().toISOString();
     }
+    labeled++;
   }
 
   return labeled;
 }
 
-async function closeExpired(owner: string, repo: string) {
+async function closeExpired(owner: string, repo: string, state: SweepState) {
   let closed = 0;
+  const now = Date.now();
 
   for (const { label, days, reason } of lifecycle) {
-    const cutoff = new Date();
-    cutoff.setDate(cutoff.getDate() - days);
     console.log(`\n=== ${label} (${days}d timeout) ===`);
 
-    for (let page = 1; page <= 10; page++) {
-      const issues = await githubRequest<any[]>(
-        `/repos/${owner}/${repo}/issues?state=open&labels=${label}&sort=updated&direction=asc&per_page=100&page=${page}`
-      );
-      if (issues.length === 0) break;
-
-      for (const issue of issues) {
-        if (issue.pull_request) continue;
-        if (issue.locked) continue;
-
-        const thumbsUp = issue.reactions?.["+1"] ?? 0;
-        if (thumbsUp >= STALE_UPVOTE_THRESHOLD) continue;
+    // Deadline index: issues carrying the label, by when it expires.
+    const deadlines = Object.values(state.issues)
+      .filter((issue) => issue.labels.includes(label) && issue.labeledAt[label])
+      .map((issue) => ({ issue, labeledAt: new Date(issue.labeledAt[label]) }))
+      .map((entry) => ({ ...entry, deadline: entry.labeledAt.getTime() + days * DAY_MS }))
+      .sort((a, b) => a.deadline - b.deadline);
+    const expired = deadlines.filter(
+      ({ issue, deadline }) =>
+        deadline <= now && !issue.locked && issue.thumbsUp < STALE_UPVOTE_THRESHOLD
+    );
+    const upcoming = deadlines.find(({ deadline }) => deadline > now);
+    console.log(
+      `${deadlines.length} labeled, ${expired.length} expired` +
+        (upcoming ? `, next deadline ${new Date(upcoming.deadline).toISOString()} (#${upcoming.issue.number})` : "")
+    );
 
-        const base = `/repos/${owner}/${repo}/issues/${issue.number}`;
+    // Check each expired issue for later human comments in parallel; the
+    // closes below stay sequential.
+    const closable = await mapConcurrent(expired, CONCURRENCY, async ({ issue, labeledAt }) => {
+      const base = `/repos/${owner}/${repo}/issues/${issue.number}`;
 
-        const events = await githubRequest<any[]>(`${base}/events?per_page=100`);
+      // Skip if a non-bot user commented after the label was applied.
+      // The triage workflow should remove lifecycle labels on human
+      // activity, but check here too as a safety net.
+      const comments = await githubRequest<any[]>(
+        `${base}/comments?since=${labeledAt.toISOString()}&per_page=100`
+      );
+      const hasHumanComment = comments.some(
+        (c) => c.user && c.user.type !== "Bot"
+      );
+      if (hasHumanComment) {
+        console.log(
+          `#${issue.number}: skipping (human activity after ${label} label)`
+        );
+        return false;
+      }
+      return true;
+    });
 
-        const labeledAt = events
-          .filter((e) => e.event === "labeled" && e.label?.name === label)
-          .map((e) => new Date(e.created_at))
-          .pop();
+    for (const [index, { issue, labeledAt }] of expired.entries()) {
+      if (!closable[index] || !state.issues[issue.number]) continue;
 
-        if (!labeledAt || labeledAt > cutoff) continue;
+      const base = `/repos/${owner}/${repo}/issues/${issue.number}`;
 
-        // Skip if a non-bot user commented after the label was applied.
-        // The triage workflow should remove lifecycle labels on human
-        // activity, but check here too as a safety net.
-        const comments = await githubRequest<any[]>(
-          `${base}/comments?since=${labeledAt.toISOString()}&per_page=100`
-        );
-        const hasHumanComment = comments.some(
-          (c) => c.user && c.user.type !== "Bot"
-        );
-        if (hasHumanComment) {
-          console.log(
-            `#${issue.number}: skipping (human activity after ${label} label)`
-          );
+      if (DRY_RUN) {
+        const age = Math.floor((Date.now() - labeledAt.getTime()) / DAY_MS);
+        console.log(`#${issue.number}: would close (${label}, ${age}d old) — ${issue.title}`);
+      } else {
+        if (!(await stillMatches(base, issue))) {
+          console.log(`#${issue.number}: skipping (changed since indexed)`);
           continue;
         }
-
-        if (DRY_RUN) {
-          const age = Math.floor((Date.now() - labeledAt.getTime()) / 86400000);
-          console.log(`#${issue.number}: would close (${label}, ${age}d old) — ${issue.title}`);
-        } else {
-          await githubRequest(`${base}/comments`, "POST", { body: CLOSE_MESSAGE(reason) });
-          await githubRequest(base, "PATCH", { state: "closed", state_reason: "not_planned" });
-          console.log(`#${issue.number}: closed (${label})`);
-        }
-        closed++;
+        await githubRequest(`${base}/comments`, "POST", { body: CLOSE_MESSAGE(reason) });
+        await githubRequest(base, "PATCH", { state: "closed", state_reason: "not_planned" });
+        console.log(`#${issue.number}: closed (${label})`);
+        delete state.issues[issue.number];
       }
+      closed++;
     }
   }
 
@@ -162,7 +295,10 @@ if (!owner || !repo)
 
 if (DRY_RUN) console.log("DRY RUN — no changes will be made\n");
 
-const labeled = await markStale(owner, repo);
-const closed = await closeExpired(owner, repo);
+const state = await refreshIndex(owner, repo);
+const labeled = await markStale(owner, repo, state);
+const closed = await closeExpired(owner, repo, state);
+saveState(state);
+gh.saveCache();
 
 console.log(`\nDone: ${labeled} ${DRY_RUN ? "would be labeled" : "labeled"} stale, ${closed} ${DRY_RUN ? "would be closed" : "closed"}`);